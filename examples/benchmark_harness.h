@@ -0,0 +1,420 @@
+//
+// 示例基准程序共用的计时框架：自动标定迭代次数、多次重复取中位数、多线程并发执行、JSON 输出与基线比较 
+// 不依赖第三方库；performance_test 与 scaling_benchmark 共用 
+//
+#ifndef DATETIME_BENCHMARK_HARNESS_H
+#define DATETIME_BENCHMARK_HARNESS_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bench {
+
+// 防止编译器把被测调用优化掉 
+inline std::atomic<long long>& sink() {
+    static std::atomic<long long> value(0);
+    return value;
+}
+
+struct Result {
+    std::string name;
+    int threads;
+    long long iterations;  // 每个线程每次重复的迭代数
+    double nsPerOp;        // 单个线程看到的每次调用耗时（多次重复的中位数）
+    double opsPerSecond;   // 所有线程合计的吞吐
+};
+
+struct Options {
+    std::vector<int> threads = { 1 };
+    double minSeconds = 0.1;  // 每个用例在每个线程数下的大致总耗时
+    int repetitions = 5;
+    std::string filter;       // 名称包含该子串的用例才运行
+};
+
+class Suite {
+public:
+    // body(i) 为一次被测调用，返回值累加进 sink；i 可用来轮换输入，避免常量折叠 
+    template <class Body>
+    void add(const std::string& name, Body body) {
+        cases_.push_back(Case{ name, [body](long long iterations) {
+            long long sum = 0;
+            for (long long i = 0; i < iterations; ++i) {
+                sum += static_cast<long long>(body(i));
+            }
+            return sum;
+        } });
+    }
+
+    std::vector<std::string> names() const {
+        std::vector<std::string> result;
+        for (const Case& c : cases_) {
+            result.push_back(c.name);
+        }
+        return result;
+    }
+
+    std::vector<Result> run(const Options& options, bool verbose = true) const {
+        std::vector<Result> results;
+        if (verbose) {
+            std::printf("%-44s %8s %14s %16s\n", "benchmark", "threads", "ns/op", "ops/s (total)");
+        }
+        for (const Case& c : cases_) {
+            if (!options.filter.empty() && c.name.find(options.filter) == std::string::npos) {
+                continue;
+            }
+            for (int threads : options.threads) {
+                Result result = measure(c, threads, options);
+                if (verbose) {
+                    std::printf("%-44s %8d %14.2f %16.0f\n", result.name.c_str(), result.threads, result.nsPerOp,
+                                result.opsPerSecond);
+                    std::fflush(stdout);
+                }
+                results.push_back(result);
+            }
+        }
+        return results;
+    }
+
+private:
+    struct Case {
+        std::string name;
+        std::function<long long(long long)> loop;
+    };
+
+    // threads 个线程同时起跑，返回最慢线程的耗时（秒） 
+    static double timeParallel(const Case& c, int threads, long long iterations) {
+        if (threads == 1) {
+            auto start = std::chrono::steady_clock::now();
+            sink() += c.loop(iterations);
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        std::atomic<int> ready(0);
+        std::atomic<bool> go(false);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&c, &ready, &go, iterations]() {
+                ready.fetch_add(1);
+                while (!go.load()) {
+                    std::this_thread::yield();
+                }
+                sink() += c.loop(iterations);
+            });
+        }
+        while (ready.load() != threads) {
+            std::this_thread::yield();
+        }
+        auto start = std::chrono::steady_clock::now();
+        go.store(true);
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    static Result measure(const Case& c, int threads, const Options& options) {
+        // 标定：单次重复至少 minSeconds / repetitions 
+        double target = options.minSeconds / std::max(1, options.repetitions);
+        long long iterations = 1;
+        double elapsed = timeParallel(c, 1, iterations);
+        while (elapsed < target / 10 && iterations < (1LL << 40)) {
+            iterations *= 10;
+            elapsed = timeParallel(c, 1, iterations);
+        }
+        if (elapsed > 0 && elapsed < target) {
+            iterations = std::max(1LL, static_cast<long long>(iterations * (target / elapsed)));
+        }
+
+        std::vector<double> samples;
+        for (int r = 0; r < std::max(1, options.repetitions); ++r) {
+            samples.push_back(timeParallel(c, threads, iterations));
+        }
+        std::sort(samples.begin(), samples.end());
+        double median = samples[samples.size() / 2];
+
+        Result result;
+        result.name = c.name;
+        result.threads = threads;
+        result.iterations = iterations;
+        result.nsPerOp = median * 1e9 / static_cast<double>(iterations);
+        result.opsPerSecond = static_cast<double>(iterations) * threads / median;
+        return result;
+    }
+
+    std::vector<Case> cases_;
+};
+
+// 扩展效率：threads 个线程的合计吞吐 / (threads × 同名单线程吞吐)，1.0 为线性扩展；没有单线程结果时为 0 
+inline double scalingEfficiency(const std::vector<Result>& results, const Result& result) {
+    for (const Result& single : results) {
+        if (single.name == result.name && single.threads == 1 && single.opsPerSecond > 0) {
+            return result.opsPerSecond / (single.opsPerSecond * result.threads);
+        }
+    }
+    return 0;
+}
+
+// 按用例输出每线程吞吐与扩展效率 
+inline void printScaling(const std::vector<Result>& results, FILE* out = stdout) {
+    std::fprintf(out, "\n%-44s %8s %18s %11s\n", "benchmark", "threads", "ops/s per thread", "efficiency");
+    for (const Result& result : results) {
+        std::fprintf(out, "%-44s %8d %18.0f %10.0f%%\n", result.name.c_str(), result.threads,
+                     result.opsPerSecond / result.threads, scalingEfficiency(results, result) * 100);
+    }
+}
+
+inline std::string jsonEscape(const std::string& text) {
+    std::string out;
+    for (char ch : text) {
+        if (ch == '"' || ch == '\\') {
+            out += '\\';
+        }
+        out += ch;
+    }
+    return out;
+}
+
+// 每个结果单独占一行，便于 diff，也便于 readJson 逐行读取 
+inline std::string toJson(const std::vector<Result>& results, const std::string& program) {
+    std::ostringstream out;
+    char date[32] = "";
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    out << "{\n  \"context\": {\"program\": \"" << jsonEscape(program) << "\", \"date\": \"" << date
+        << "\", \"hardware_concurrency\": " << std::thread::hardware_concurrency() << "},\n";
+    out << "  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        char line[512];
+        std::snprintf(line, sizeof(line),
+                      "    {\"name\": \"%s\", \"threads\": %d, \"iterations\": %lld, \"ns_per_op\": %.4f, "
+                      "\"ops_per_second\": %.1f, \"ops_per_second_per_thread\": %.1f, \"scaling_efficiency\": %.4f}%s\n",
+                      jsonEscape(results[i].name).c_str(), results[i].threads, results[i].iterations,
+                      results[i].nsPerOp, results[i].opsPerSecond, results[i].opsPerSecond / results[i].threads,
+                      scalingEfficiency(results, results[i]), i + 1 < results.size() ? "," : "");
+        out << line;
+    }
+    out << "  ]\n}\n";
+    return out.str();
+}
+
+inline bool writeJson(const std::vector<Result>& results, const std::string& program, const std::string& path) {
+    std::string json = toJson(results, program);
+    if (path == "-") {
+        std::fwrite(json.data(), 1, json.size(), stdout);
+        return true;
+    }
+    std::ofstream file(path.c_str());
+    file << json;
+    return static_cast<bool>(file);
+}
+
+// 在一个对象里查找 "key": 后面的值 
+inline bool findField(const std::string& object, const char* key, std::string& value) {
+    std::string pattern = std::string("\"") + key + "\":";
+    size_t pos = object.find(pattern);
+    if (pos == std::string::npos) {
+        return false;
+    }
+    pos = object.find_first_not_of(' ', pos + pattern.size());
+    if (pos == std::string::npos) {
+        return false;
+    }
+    if (object[pos] == '"') {
+        size_t end = pos + 1;
+        while (end < object.size() && object[end] != '"') {
+            end += object[end] == '\\' ? 2 : 1;
+        }
+        value.clear();
+        for (size_t i = pos + 1; i < end && i < object.size(); ++i) {
+            if (object[i] == '\\' && i + 1 < end) {
+                ++i;
+            }
+            value += object[i];
+        }
+        return true;
+    }
+    size_t end = object.find_first_of(",}", pos);
+    value = object.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+    return true;
+}
+
+// 读取 toJson 写出的文件：只识别 benchmarks 数组中带 name / threads / ns_per_op 的对象 
+inline bool readJson(const std::string& path, std::vector<Result>& results) {
+    std::ifstream file(path.c_str());
+    if (!file) {
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
+    size_t begin = text.find("\"benchmarks\"");
+    if (begin == std::string::npos) {
+        return false;
+    }
+    results.clear();
+    while ((begin = text.find('{', begin)) != std::string::npos) {
+        size_t end = text.find('}', begin);
+        if (end == std::string::npos) {
+            break;
+        }
+        std::string object = text.substr(begin, end - begin + 1);
+        std::string name;
+        std::string threads;
+        std::string nsPerOp;
+        if (findField(object, "name", name) && findField(object, "threads", threads) &&
+            findField(object, "ns_per_op", nsPerOp)) {
+            Result result;
+            result.name = name;
+            result.threads = std::atoi(threads.c_str());
+            result.iterations = 0;
+            result.nsPerOp = std::atof(nsPerOp.c_str());
+            result.opsPerSecond = 0;
+            results.push_back(result);
+        }
+        begin = end + 1;
+    }
+    return true;
+}
+
+// 与基线逐项比较；ns/op 比基线慢超过 tolerance（0.10 即 10%）的项判为回退，返回回退的项数 
+inline int compare(const std::vector<Result>& current, const std::vector<Result>& baseline, double tolerance,
+                   FILE* out = stdout) {
+    int regressions = 0;
+    std::fprintf(out, "\n%-44s %8s %12s %12s %9s\n", "benchmark", "threads", "baseline", "current", "change");
+    for (const Result& result : current) {
+        const Result* base = nullptr;
+        for (const Result& candidate : baseline) {
+            if (candidate.name == result.name && candidate.threads == result.threads) {
+                base = &candidate;
+                break;
+            }
+        }
+        if (base == nullptr || base->nsPerOp <= 0) {
+            std::fprintf(out, "%-44s %8d %12s %12.2f %9s\n", result.name.c_str(), result.threads, "-", result.nsPerOp,
+                        "new");
+            continue;
+        }
+        double change = result.nsPerOp / base->nsPerOp - 1.0;
+        bool regressed = change > tolerance;
+        regressions += regressed ? 1 : 0;
+        std::fprintf(out, "%-44s %8d %12.2f %12.2f %+8.1f%%%s\n", result.name.c_str(), result.threads, base->nsPerOp,
+                    result.nsPerOp, change * 100, regressed ? "  REGRESSION" : "");
+    }
+    std::fprintf(out, "\n%d regression(s) beyond %.0f%% tolerance\n", regressions, tolerance * 100);
+    return regressions;
+}
+
+// 1, 2, 4, ... 直到 maxThreads，最后一项总是 maxThreads 
+inline std::vector<int> powersOfTwoUpTo(int maxThreads) {
+    std::vector<int> threads;
+    for (int count = 1; count < maxThreads; count *= 2) {
+        threads.push_back(count);
+    }
+    threads.push_back(std::max(1, maxThreads));
+    return threads;
+}
+
+// 解析 "1,2,4"；"max" 表示 hardware_concurrency() 
+inline std::vector<int> parseThreadList(const std::string& text) {
+    std::vector<int> threads;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        int count = item == "max" ? static_cast<int>(std::thread::hardware_concurrency()) : std::atoi(item.c_str());
+        if (count > 0) {
+            threads.push_back(count);
+        }
+    }
+    if (threads.empty()) {
+        threads.push_back(1);
+    }
+    return threads;
+}
+
+// 各基准程序共用的命令行参数；未识别的参数返回 false 
+struct CommandLine {
+    Options options;
+    std::string jsonPath;
+    std::string baselinePath;
+    double tolerance = 0.10;
+    bool list = false;
+
+    bool parse(int argc, char* argv[]) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--filter" && hasValue) {
+                options.filter = argv[++i];
+            } else if (arg == "--threads" && hasValue) {
+                options.threads = parseThreadList(argv[++i]);
+            } else if (arg == "--min-time" && hasValue) {
+                options.minSeconds = std::atof(argv[++i]);
+            } else if (arg == "--repetitions" && hasValue) {
+                options.repetitions = std::atoi(argv[++i]);
+            } else if (arg == "--json" && hasValue) {
+                jsonPath = argv[++i];
+            } else if (arg == "--baseline" && hasValue) {
+                baselinePath = argv[++i];
+            } else if (arg == "--tolerance" && hasValue) {
+                tolerance = std::atof(argv[++i]);
+            } else if (arg == "--list") {
+                list = true;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static void usage(const char* program) {
+        std::fprintf(stderr,
+                     "usage: %s [--filter SUBSTRING] [--threads 1,2,max] [--min-time SECONDS] [--repetitions N]\n"
+                     "          [--json FILE|-] [--baseline FILE [--tolerance 0.10]] [--list]\n"
+                     "  --json      write results as JSON ('-' for stdout)\n"
+                     "  --baseline  compare ns/op with a previous --json file; exit 1 on regressions\n",
+                     program);
+    }
+};
+
+// 运行、输出并与基线比较；返回进程退出码 
+inline int runMain(const Suite& suite, const CommandLine& commandLine, const char* program,
+                   bool showScaling = false) {
+    if (commandLine.list) {
+        for (const std::string& name : suite.names()) {
+            std::printf("%s\n", name.c_str());
+        }
+        return 0;
+    }
+    std::vector<Result> results = suite.run(commandLine.options, commandLine.jsonPath != "-");
+    if (showScaling && commandLine.jsonPath != "-") {
+        printScaling(results);
+    }
+    if (!commandLine.jsonPath.empty() && !writeJson(results, program, commandLine.jsonPath)) {
+        std::fprintf(stderr, "cannot write %s\n", commandLine.jsonPath.c_str());
+        return 2;
+    }
+    if (!commandLine.baselinePath.empty()) {
+        std::vector<Result> baseline;
+        if (!readJson(commandLine.baselinePath, baseline)) {
+            std::fprintf(stderr, "cannot read baseline %s\n", commandLine.baselinePath.c_str());
+            return 2;
+        }
+        FILE* out = commandLine.jsonPath == "-" ? stderr : stdout;
+        return compare(results, baseline, commandLine.tolerance, out) == 0 ? 0 : 1;
+    }
+    return 0;
+}
+
+} // namespace bench
+
+#endif // DATETIME_BENCHMARK_HARNESS_H
@@ -0,0 +1,80 @@
+//
+// DateTime::now() 与 DateTime::nowCoarse() 的取时开销对比 
+//
+#include "datetime.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace datetime;
+
+namespace {
+
+// 防止编译器把循环中的取时优化掉 
+volatile long long g_sink = 0;
+
+template <class Function>
+double nanosecondsPerCall(long long iterations, Function function) {
+    auto start = std::chrono::steady_clock::now();
+    long long sum = 0;
+    for (long long i = 0; i < iterations; ++i) {
+        sum += function();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    g_sink = g_sink + sum;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+}
+
+// threads 个线程同时执行，返回每次调用的平均耗时 
+template <class Function>
+double parallelNanosecondsPerCall(int threads, long long iterations, Function function) {
+    std::vector<double> results(static_cast<size_t>(threads));
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&results, t, iterations, function]() {
+            results[static_cast<size_t>(t)] = nanosecondsPerCall(iterations, function);
+        });
+    }
+    double total = 0;
+    for (int t = 0; t < threads; ++t) {
+        workers[static_cast<size_t>(t)].join();
+        total += results[static_cast<size_t>(t)];
+    }
+    return total / threads;
+}
+
+void report(const char* name, double single, double parallel) {
+    std::printf("  %-36s %10.2f ns/call %10.2f ns/call\n", name, single, parallel);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    long long iterations = argc > 1 ? std::atoll(argv[1]) : 5000000LL;
+    int threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (threads < 2) {
+        threads = 2;
+    }
+
+    auto precise = []() { return DateTime::now().getTimePoint().time_since_epoch().count(); };
+    auto coarse = []() { return DateTime::nowCoarse().getTimePoint().time_since_epoch().count(); };
+    auto systemClock = []() { return std::chrono::system_clock::now().time_since_epoch().count(); };
+
+    std::printf("Clock benchmark: %lld iterations, %d threads\n", iterations, threads);
+    std::printf("  %-36s %18s %18s\n", "", "1 thread", "all threads");
+    report("std::chrono::system_clock::now()", nanosecondsPerCall(iterations, systemClock),
+           parallelNanosecondsPerCall(threads, iterations, systemClock));
+    report("DateTime::now()", nanosecondsPerCall(iterations, precise),
+           parallelNanosecondsPerCall(threads, iterations, precise));
+    std::printf("  (CoarseClock resolution: %lld ns)\n", static_cast<long long>(CoarseClock::resolution().count()));
+    report("DateTime::nowCoarse()", nanosecondsPerCall(iterations, coarse),
+           parallelNanosecondsPerCall(threads, iterations, coarse));
+
+    CoarseClock::startTicker(std::chrono::milliseconds(1));
+    report("DateTime::nowCoarse() + 1ms ticker", nanosecondsPerCall(iterations, coarse),
+           parallelNanosecondsPerCall(threads, iterations, coarse));
+    CoarseClock::stopTicker();
+    return 0;
+}
@@ -1,8 +1,187 @@
 //
-// Created by CY815 on 2025/8/1.
+// DateTime 各接口的吞吐基准：构造、访问器、解析、格式化、运算，可选多线程 
+// 结果可写成 JSON，并与保存的基线比较，用于发布前检查性能回退： 
+//   performance_test --json baseline.json 
+//   performance_test --baseline baseline.json --tolerance 0.10   # 有回退时退出码为 1 
 //
+#include "benchmark_harness.h"
+#include "datetime.h"
+#include <chrono>
+#include <string>
+#include <vector>
 
+using namespace datetime;
 
-int main() {
-    return 0;
-}
\ No newline at end of file
+namespace {
+
+// 输入在 kInputs 个样本间轮换，避免常量折叠，也避免只命中一个缓存行 
+const long long kInputs = 1024;
+
+struct Inputs {
+    std::vector<DateTime> local;
+    std::vector<DateTime> utc;
+    std::vector<std::string> text;
+    std::vector<std::string> rfc3339;
+    std::vector<std::string> slashed;
+    std::vector<std::string> malformed;
+
+    Inputs() {
+        for (long long i = 0; i < kInputs; ++i) {
+            // 1990-2030 之间分散取样，覆盖不同的年月与夏令时 
+            time_t t = static_cast<time_t>(631152000LL + i * 1234567LL + i % 60);
+            local.push_back(DateTime(t));
+            utc.push_back(DateTime(t).toUtc());
+            text.push_back(utc.back().toString());
+            rfc3339.push_back(utc.back().strftime("%FT%T%:z"));
+            slashed.push_back(utc.back().strftime("%d/%m/%Y %H:%M"));
+            std::string bad = text.back();
+            bad[5] = '1';
+            bad[6] = '3';
+            malformed.push_back(bad);
+        }
+    }
+};
+
+const DateTime& at(const std::vector<DateTime>& values, long long i) {
+    return values[static_cast<size_t>(i & (kInputs - 1))];
+}
+
+const std::string& at(const std::vector<std::string>& values, long long i) {
+    return values[static_cast<size_t>(i & (kInputs - 1))];
+}
+
+void addConstruction(bench::Suite& suite) {
+    suite.add("construct/civil_local", [](long long i) {
+        return DateTime(2000 + static_cast<int>(i % 30), 1 + static_cast<int>(i % 12), 1 + static_cast<int>(i % 28),
+                        static_cast<int>(i % 24), 30, 15).timestamp();
+    });
+    suite.add("construct/civil_utc", [](long long i) {
+        return DateTime::utc(2000 + static_cast<int>(i % 30), 1 + static_cast<int>(i % 12),
+                             1 + static_cast<int>(i % 28), static_cast<int>(i % 24), 30, 15).timestamp();
+    });
+    suite.add("construct/try_make_invalid", [](long long i) {
+        DateTime out(static_cast<time_t>(0));
+        return static_cast<long long>(DateTime::tryMakeUtc(2023, 2, 29 + static_cast<int>(i & 1), out));
+    });
+    suite.add("construct/from_timestamp", [](long long i) {
+        return DateTime::fromTimestamp(static_cast<time_t>(1600000000LL + i)).timestamp();
+    });
+    suite.add("construct/now", [](long long) { return DateTime::now().timestamp(); });
+    suite.add("construct/now_coarse", [](long long) { return DateTime::nowCoarse().timestamp(); });
+}
+
+void addAccessors(bench::Suite& suite, const Inputs& inputs) {
+    const std::vector<DateTime>* modes[] = { &inputs.local, &inputs.utc };
+    const char* modeNames[] = { "local", "utc" };
+    for (int m = 0; m < 2; ++m) {
+        const std::vector<DateTime>& values = *modes[m];
+        std::string prefix = std::string("accessor/") + modeNames[m] + "/";
+        suite.add(prefix + "year", [&values](long long i) { return at(values, i).year(); });
+        suite.add(prefix + "month", [&values](long long i) { return at(values, i).month(); });
+        suite.add(prefix + "day", [&values](long long i) { return at(values, i).day(); });
+        suite.add(prefix + "hour", [&values](long long i) { return at(values, i).hour(); });
+        suite.add(prefix + "minute", [&values](long long i) { return at(values, i).minute(); });
+        suite.add(prefix + "second", [&values](long long i) { return at(values, i).second(); });
+        suite.add(prefix + "weekday", [&values](long long i) { return at(values, i).weekday(); });
+        suite.add(prefix + "day_of_year", [&values](long long i) { return at(values, i).dayOfYear(); });
+        suite.add(prefix + "fields", [&values](long long i) {
+            DateTimeFields f = at(values, i).fields();
+            return f.year + f.month + f.day + f.hour + f.minute + f.second;
+        });
+    }
+}
+
+void addParsing(bench::Suite& suite, const Inputs& inputs) {
+    suite.add("parse/from_string_local", [&inputs](long long i) {
+        return DateTime::fromString(at(inputs.text, i)).timestamp();
+    });
+    suite.add("parse/from_string_utc", [&inputs](long long i) {
+        return DateTime::fromStringUtc(at(inputs.text, i)).timestamp();
+    });
+    suite.add("parse/generic_pattern_utc", [&inputs](long long i) {
+        return DateTime::fromStringUtc(at(inputs.slashed, i), "%d/%m/%Y %H:%M").timestamp();
+    });
+    suite.add("parse/rfc3339_spec", [&inputs](long long i) {
+        return DateTime::fromString(at(inputs.rfc3339, i), FormatSpec::rfc3339()).timestamp();
+    });
+    suite.add("parse/iso8601_utc", [&inputs](long long i) {
+        DateTime out(static_cast<time_t>(0));
+        parseIso8601Utc(at(inputs.rfc3339, i), out);
+        return out.timestamp();
+    });
+    suite.add("parse/try_parse_malformed", [&inputs](long long i) {
+        DateTime out(static_cast<time_t>(0));
+        return static_cast<long long>(DateTime::tryParseUtc(at(inputs.malformed, i), out));
+    });
+}
+
+void addFormatting(bench::Suite& suite, const Inputs& inputs) {
+    static const CachedNowFormatter cached("%Y-%m-%d %H:%M:%S.%f", true);
+    suite.add("format/to_string_local", [&inputs](long long i) { return at(inputs.local, i).toString().size(); });
+    suite.add("format/to_string_utc", [&inputs](long long i) { return at(inputs.utc, i).toString().size(); });
+    suite.add("format/strftime_long", [&inputs](long long i) {
+        return at(inputs.utc, i).strftime("%A, %d %B %Y %H:%M:%S").size();
+    });
+    suite.add("format/strftime_spec", [&inputs](long long i) {
+        static const FormatSpec spec("%FT%T%:z");
+        return at(inputs.utc, i).strftime(spec).size();
+    });
+    suite.add("format/isoformat", [&inputs](long long i) { return at(inputs.utc, i).isoformat().size(); });
+    suite.add("format/format_to_buffer", [&inputs](long long i) {
+        char buffer[64];
+        return at(inputs.utc, i).formatTo(buffer, sizeof(buffer));
+    });
+    // 日志场景：同一秒内反复格式化，只改写微秒数字 
+    suite.add("format/cached_now_formatter", [&inputs](long long i) {
+        char buffer[64];
+        std::chrono::system_clock::time_point tp =
+            inputs.utc[0].getTimePoint() + std::chrono::microseconds(i % 1000000);
+        return cached.formatTo(buffer, sizeof(buffer), tp);
+    });
+}
+
+void addArithmetic(bench::Suite& suite, const Inputs& inputs) {
+    suite.add("arith/add_days_local", [&inputs](long long i) { return at(inputs.local, i).addDays(3).timestamp(); });
+    suite.add("arith/add_days_utc", [&inputs](long long i) { return at(inputs.utc, i).addDays(3).timestamp(); });
+    suite.add("arith/add_months_local", [&inputs](long long i) {
+        return at(inputs.local, i).addMonths(1).timestamp();
+    });
+    suite.add("arith/add_months_utc_clamp", [&inputs](long long i) {
+        return at(inputs.utc, i).addMonths(1, MonthOverflow::Clamp).timestamp();
+    });
+    suite.add("arith/add_years_utc", [&inputs](long long i) { return at(inputs.utc, i).addYears(1).timestamp(); });
+    suite.add("arith/plus_time_delta", [&inputs](long long i) {
+        return (at(inputs.utc, i) + TimeDelta(1, 2, 3, 4)).timestamp();
+    });
+    suite.add("arith/difference", [&inputs](long long i) {
+        return (at(inputs.utc, i) - at(inputs.utc, i + 1)).totalSeconds();
+    });
+    suite.add("arith/floor_hour_utc", [&inputs](long long i) {
+        return at(inputs.utc, i).floor(TimeUnit::Hour).timestamp();
+    });
+    suite.add("arith/floor_month_local", [&inputs](long long i) {
+        return at(inputs.local, i).floor(TimeUnit::Month).timestamp();
+    });
+    suite.add("arith/compare", [&inputs](long long i) {
+        return at(inputs.utc, i) < at(inputs.utc, i + 1) ? 1 : 0;
+    });
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bench::CommandLine commandLine;
+    if (!commandLine.parse(argc, argv)) {
+        bench::CommandLine::usage(argv[0]);
+        return 2;
+    }
+
+    static const Inputs inputs;
+    bench::Suite suite;
+    addConstruction(suite);
+    addAccessors(suite, inputs);
+    addParsing(suite, inputs);
+    addFormatting(suite, inputs);
+    addArithmetic(suite, inputs);
+    return bench::runMain(suite, commandLine, "performance_test");
+}
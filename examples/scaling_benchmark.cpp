@@ -0,0 +1,73 @@
+//
+// 多线程扩展性基准：访问器、strftime、fromString 与构造函数在 1..N 个线程下的每线程吞吐与扩展效率 
+// 本地时间路径经过 libc 的 localtime_r / mktime，glibc 在其中持有全局时区锁； 
+// UTC 路径只做整数运算，可作为理想扩展的对照 
+//   scaling_benchmark                        # 1, 2, 4, ... hardware_concurrency() 个线程 
+//   scaling_benchmark --threads 1,8,64 --json scaling.json 
+//
+#include "benchmark_harness.h"
+#include "datetime.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace datetime;
+
+namespace {
+
+const long long kInputs = 1024;
+
+struct Inputs {
+    std::vector<DateTime> local;
+    std::vector<DateTime> utc;
+    std::vector<std::string> text;
+
+    Inputs() {
+        for (long long i = 0; i < kInputs; ++i) {
+            time_t t = static_cast<time_t>(631152000LL + i * 1234567LL + i % 60);
+            local.push_back(DateTime(t));
+            utc.push_back(DateTime(t).toUtc());
+            text.push_back(utc.back().toString());
+        }
+    }
+};
+
+template <class T>
+const T& at(const std::vector<T>& values, long long i) {
+    return values[static_cast<size_t>(i & (kInputs - 1))];
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bench::CommandLine commandLine;
+    commandLine.options.threads = bench::powersOfTwoUpTo(static_cast<int>(std::thread::hardware_concurrency()));
+    if (!commandLine.parse(argc, argv)) {
+        bench::CommandLine::usage(argv[0]);
+        return 2;
+    }
+
+    static const Inputs inputs;
+    bench::Suite suite;
+    suite.add("accessor/local/year", [](long long i) { return at(inputs.local, i).year(); });
+    suite.add("accessor/local/fields", [](long long i) { return at(inputs.local, i).fields().second; });
+    suite.add("accessor/utc/year", [](long long i) { return at(inputs.utc, i).year(); });
+    suite.add("strftime/local", [](long long i) { return at(inputs.local, i).strftime("%F %T").size(); });
+    suite.add("strftime/utc", [](long long i) { return at(inputs.utc, i).strftime("%F %T").size(); });
+    suite.add("fromString/local", [](long long i) { return DateTime::fromString(at(inputs.text, i)).timestamp(); });
+    suite.add("fromString/utc", [](long long i) { return DateTime::fromStringUtc(at(inputs.text, i)).timestamp(); });
+    suite.add("construct/local", [](long long i) {
+        return DateTime(2000 + static_cast<int>(i % 30), 1 + static_cast<int>(i % 12), 1 + static_cast<int>(i % 28),
+                        static_cast<int>(i % 24), 30, 15).timestamp();
+    });
+    suite.add("construct/utc", [](long long i) {
+        return DateTime::utc(2000 + static_cast<int>(i % 30), 1 + static_cast<int>(i % 12),
+                             1 + static_cast<int>(i % 28), static_cast<int>(i % 24), 30, 15).timestamp();
+    });
+
+    // --json - 时 stdout 只输出 JSON 
+    if (commandLine.jsonPath != "-") {
+        std::printf("Scaling benchmark: hardware_concurrency() = %u\n\n", std::thread::hardware_concurrency());
+    }
+    return bench::runMain(suite, commandLine, "scaling_benchmark", true);
+}
@@ -0,0 +1,183 @@
+//
+// 时间列排序与查找：sortTimes 与 std::sort / std::stable_sort，lowerBoundTime、EytzingerIndex、TimeIndex 与 std::lower_bound 
+// 排序用例每次先把乱序输入拷入工作区再排序，copy/ 用例单独给出拷贝的耗时 
+//   sort_benchmark --filter sort/ 
+//   sort_benchmark --filter search/ --json search.json 
+//
+#include "benchmark_harness.h"
+#include "datetime_batch.h"
+#include "datetime_index.h"
+#include <algorithm>
+#include <vector>
+
+using namespace datetime;
+
+namespace {
+
+const size_t kSortRows = 1 << 20;
+const size_t kSearchRows = 1 << 22;
+const long long kProbes = 1 << 16;
+
+// 2000-2030 年之间的乱序秒数，约 1% 为重复值 
+std::vector<int64_t> makeEpochs(size_t n) {
+    std::vector<int64_t> epochs(n);
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < n; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        epochs[i] = 946684800LL + static_cast<int64_t>(state % 946708560ULL);
+        if (i % 101 == 0 && i > 0) {
+            epochs[i] = epochs[i - 1];
+        }
+    }
+    return epochs;
+}
+
+struct Inputs {
+    std::vector<int64_t> epochs;
+    std::vector<PackedDateTime> packed;
+    std::vector<DateTime> times;
+    std::vector<int64_t> sortedEpochs;
+    std::vector<DateTime> sortedTimes;
+    std::vector<int64_t> probes;
+    EytzingerIndex index;
+    std::vector<PackedDateTime> sortedPacked;
+    TimeIndex timeIndex;
+
+    Inputs() : epochs(makeEpochs(kSortRows)) {
+        for (int64_t epoch : epochs) {
+            packed.push_back(PackedDateTime::fromNanoseconds(epoch * 1000000000LL + epoch % 1000));
+            times.push_back(DateTime::fromTimestamp(static_cast<time_t>(epoch)).toUtc());
+        }
+        sortedEpochs = makeEpochs(kSearchRows);
+        sortTimes(sortedEpochs.data(), sortedEpochs.size());
+        sortedTimes = times;
+        sortTimes(sortedTimes.data(), sortedTimes.size());
+        probes = makeEpochs(static_cast<size_t>(kProbes));
+        index = EytzingerIndex(sortedEpochs.data(), sortedEpochs.size());
+        for (int64_t epoch : sortedEpochs) {
+            sortedPacked.push_back(PackedDateTime::fromSeconds(epoch));
+        }
+        timeIndex.append(sortedPacked.data(), sortedPacked.size());
+    }
+};
+
+const Inputs& inputs() {
+    static const Inputs instance;
+    return instance;
+}
+
+// 每个线程一份工作区，多线程运行时互不干扰 
+template <class T>
+std::vector<T>& workspace(const std::vector<T>& source) {
+    static thread_local std::vector<T> work;
+    work = source;
+    return work;
+}
+
+int64_t probe(long long i) {
+    return inputs().probes[static_cast<size_t>(i & (kProbes - 1))];
+}
+
+void addSorting(bench::Suite& suite) {
+    suite.add("copy/int64_1M", [](long long) { return workspace(inputs().epochs).back(); });
+    suite.add("copy/datetime_1M", [](long long) { return workspace(inputs().times).back().timestamp(); });
+
+    suite.add("sort/int64_1M/std_sort", [](long long) {
+        std::vector<int64_t>& work = workspace(inputs().epochs);
+        std::sort(work.begin(), work.end());
+        return work[work.size() / 2];
+    });
+    suite.add("sort/int64_1M/sortTimes", [](long long) {
+        std::vector<int64_t>& work = workspace(inputs().epochs);
+        sortTimes(work.data(), work.size());
+        return work[work.size() / 2];
+    });
+    suite.add("sort/int64_1M/sortTimes_parallel", [](long long) {
+        std::vector<int64_t>& work = workspace(inputs().epochs);
+        sortTimes(work.data(), work.size(), Execution::Parallel);
+        return work[work.size() / 2];
+    });
+    suite.add("sort/packed_1M/std_sort", [](long long) {
+        std::vector<PackedDateTime>& work = workspace(inputs().packed);
+        std::sort(work.begin(), work.end());
+        return work[work.size() / 2].nanos;
+    });
+    suite.add("sort/packed_1M/sortTimes", [](long long) {
+        std::vector<PackedDateTime>& work = workspace(inputs().packed);
+        sortTimes(work.data(), work.size());
+        return work[work.size() / 2].nanos;
+    });
+    suite.add("sort/datetime_1M/std_sort", [](long long) {
+        std::vector<DateTime>& work = workspace(inputs().times);
+        std::sort(work.begin(), work.end());
+        return work[work.size() / 2].timestamp();
+    });
+    suite.add("sort/datetime_1M/std_stable_sort", [](long long) {
+        std::vector<DateTime>& work = workspace(inputs().times);
+        std::stable_sort(work.begin(), work.end());
+        return work[work.size() / 2].timestamp();
+    });
+    suite.add("sort/datetime_1M/sortTimes", [](long long) {
+        std::vector<DateTime>& work = workspace(inputs().times);
+        sortTimes(work.data(), work.size());
+        return work[work.size() / 2].timestamp();
+    });
+    suite.add("sort/datetime_1M/sortTimes_parallel", [](long long) {
+        std::vector<DateTime>& work = workspace(inputs().times);
+        sortTimes(work.data(), work.size(), Execution::Parallel);
+        return work[work.size() / 2].timestamp();
+    });
+}
+
+void addSearching(bench::Suite& suite) {
+    suite.add("search/int64_4M/std_lower_bound", [](long long i) {
+        const std::vector<int64_t>& sorted = inputs().sortedEpochs;
+        return std::lower_bound(sorted.begin(), sorted.end(), probe(i)) - sorted.begin();
+    });
+    suite.add("search/int64_4M/lowerBoundTime", [](long long i) {
+        const std::vector<int64_t>& sorted = inputs().sortedEpochs;
+        return lowerBoundTime(sorted.data(), sorted.size(), probe(i));
+    });
+    suite.add("search/int64_4M/eytzinger", [](long long i) { return inputs().index.lowerBound(probe(i)); });
+    suite.add("search/int64_4M/range_one_day", [](long long i) {
+        const std::vector<int64_t>& sorted = inputs().sortedEpochs;
+        return rangeQuery(sorted.data(), sorted.size(), probe(i), probe(i) + 86400).size();
+    });
+    suite.add("search/packed_4M/lowerBoundTime", [](long long i) {
+        const std::vector<PackedDateTime>& sorted = inputs().sortedPacked;
+        return lowerBoundTime(sorted.data(), sorted.size(), PackedDateTime::fromSeconds(probe(i)));
+    });
+    suite.add("search/packed_4M/time_index", [](long long i) {
+        return inputs().timeIndex.lowerBound(PackedDateTime::fromSeconds(probe(i)));
+    });
+    suite.add("search/packed_4M/time_index_range_one_day", [](long long i) {
+        return inputs().timeIndex.range(PackedDateTime::fromSeconds(probe(i)), PackedDateTime::fromSeconds(probe(i) + 86400)).size();
+    });
+    suite.add("search/datetime_1M/std_lower_bound", [](long long i) {
+        const std::vector<DateTime>& sorted = inputs().sortedTimes;
+        DateTime key = DateTime::fromTimestamp(static_cast<time_t>(probe(i)));
+        return std::lower_bound(sorted.begin(), sorted.end(), key) - sorted.begin();
+    });
+    suite.add("search/datetime_1M/lowerBoundTime", [](long long i) {
+        const std::vector<DateTime>& sorted = inputs().sortedTimes;
+        return lowerBoundTime(sorted.data(), sorted.size(), DateTime::fromTimestamp(static_cast<time_t>(probe(i))));
+    });
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bench::CommandLine commandLine;
+    if (!commandLine.parse(argc, argv)) {
+        bench::CommandLine::usage(argv[0]);
+        return 2;
+    }
+
+    inputs();
+    bench::Suite suite;
+    addSorting(suite);
+    addSearching(suite);
+    return bench::runMain(suite, commandLine, "sort_benchmark");
+}
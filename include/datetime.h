@@ -1,17 +1,417 @@
 #ifndef DATETIME_H
 #define DATETIME_H
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <ctime>
 #include <iomanip>
+#include <ratio>
 #include <sstream>
+#include <type_traits>
+
+// 定义 DATETIME_HEADER_ONLY 时实现随头文件一起编译，不需要链接 datetime 库 
+#ifdef DATETIME_HEADER_ONLY
+#define DATETIME_INLINE inline
+#else
+#define DATETIME_INLINE
+#endif
+
+// 编译器关闭异常（-fno-exceptions）时自动定义，也可以手动定义 
+// 此时库内的错误经 DATETIME_THROW 打印消息后调用 std::abort()，需要容错的调用方改用 tryMake / tryParse 
+#if !defined(DATETIME_NO_EXCEPTIONS) && !defined(__cpp_exceptions) && !defined(__EXCEPTIONS) && !defined(_CPPUNWIND)
+#define DATETIME_NO_EXCEPTIONS
+#endif
+
+#ifdef DATETIME_NO_EXCEPTIONS
+#define DATETIME_THROW(message) ::datetime::detail::failFast(message)
+#else
+#define DATETIME_THROW(message) throw std::invalid_argument(message)
+#endif
 
 namespace datetime {
 
+namespace detail {
+// 关闭异常时 DATETIME_THROW 的终点：把消息写到 stderr 后终止进程 
+[[noreturn]] void failFast(const char* message);
+[[noreturn]] void failFast(const std::string& message);
+// 与 path 同目录的临时文件名：进程号加线程号，并发写同一路径时互不覆盖 
+std::string temporaryPath(const std::string& path);
+// 原子地用 from 替换 to：仍映射着 to 的进程继续读取原来的文件 
+bool replaceFile(const std::string& from, const std::string& to);
+// 先写临时文件，关闭后确认写入成功再改名替换 path；失败时删除临时文件并返回 false，path 保持原样 
+bool writeFileReplacing(const std::string& path, const char* data, size_t size);
+} // namespace detail
+
+class TimeZone;
+template <class Duration>
+class BasicTimeDelta;
+// 秒精度的时间差，与旧版 TimeDelta 行为一致 
+typedef BasicTimeDelta<std::chrono::seconds> TimeDelta;
+// 纳秒精度的时间差，用于延迟统计等需要精确差值的场景 
+typedef BasicTimeDelta<std::chrono::nanoseconds> PreciseTimeDelta;
+
+// 分解后的日期时间字段（一次转换得到全部字段） 
+struct DateTimeFields {
+    int year;
+    int month;      // 1-12
+    int day;        // 1-31
+    int hour;       // 0-23
+    int minute;     // 0-59
+    int second;     // 0-60
+    int weekday;    // 0=Sunday, 1=Monday, ..., 6=Saturday
+    int dayOfYear;  // 1-366
+};
+
+// 截断、取整等操作使用的时间单位；Day 及以下为定长单位，Week 从星期一开始，其余按公历 
+enum class TimeUnit {
+    Nanosecond,
+    Microsecond,
+    Millisecond,
+    Second,
+    Minute,
+    Hour,
+    Day,
+    Week,
+    Month,
+    Quarter,
+    Year
+};
+
+// tryMake / tryParse 的结果；这些函数只返回状态，从不抛出异常 
+enum class Status {
+    Ok,
+    InvalidMonth,   // 月份不在 1-12
+    InvalidDay,     // 日期超出该月天数
+    InvalidHour,    // 小时不在 0-23
+    InvalidMinute,  // 分钟不在 0-59
+    InvalidSecond,  // 秒不在 0-59
+    ParseError,     // 字符串与格式不符
+    OutOfRange      // 时刻超出 time_t 或 system_clock 的表示范围，或 mktime 无法转换
+};
+
+// 状态的英文描述，指向静态字符串 
+const char* statusMessage(Status status);
+
+// 按月、按年平移时，原日期在目标月份中不存在（如 1 月 31 日 + 1 个月）的处理方式 
+enum class MonthOverflow {
+    RollOver,  // 多出的天数顺延到下个月，与 mktime 一致：2023-01-31 + 1 个月 = 2023-03-03
+    Clamp,     // 取目标月份的最后一天：2023-01-31 + 1 个月 = 2023-02-28
+    Throw      // 抛出 std::invalid_argument
+};
+
+// 纯整数的公历算法（Howard Hinnant 的 days_from_civil / civil_from_days）
+// 不依赖 libc 和时区，全部为 constexpr，可在编译期求值 
+namespace civil {
+
+struct CivilDate {
+    int year;
+    int month;  // 1-12
+    int day;    // 1-31
+};
+
+namespace detail {
+
+// 向下取整除法，b 必须为正数 
+constexpr long long floorDiv(long long a, long long b) {
+    return (a >= 0 ? a : a - (b - 1)) / b;
+}
+
+// 以三月为年首的年内天数 [0, 365]
+constexpr long long marchDayOfYear(int month, int day) {
+    return (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+}
+
+constexpr long long daysFromEra(long long era, long long yoe, long long doy) {
+    return era * 146097 + yoe * 365 + yoe / 4 - yoe / 100 + doy - 719468;
+}
+
+constexpr long long daysFromMarchYear(long long year, long long doy) {
+    return daysFromEra(floorDiv(year, 400), year - floorDiv(year, 400) * 400, doy);
+}
+
+constexpr CivilDate civilFromMarchMonth(long long year, long long doy, long long mp) {
+    return CivilDate{ static_cast<int>(year + (mp >= 10 ? 1 : 0)),
+                      static_cast<int>(mp < 10 ? mp + 3 : mp - 9),
+                      static_cast<int>(doy - (153 * mp + 2) / 5 + 1) };
+}
+
+constexpr CivilDate civilFromYearOfEra(long long era, long long doe, long long yoe) {
+    return civilFromMarchMonth(yoe + era * 400, doe - (365 * yoe + yoe / 4 - yoe / 100),
+                               (5 * (doe - (365 * yoe + yoe / 4 - yoe / 100)) + 2) / 153);
+}
+
+constexpr CivilDate civilFromDayOfEra(long long era, long long doe) {
+    return civilFromYearOfEra(era, doe, (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365);
+}
+
+constexpr CivilDate civilFromShiftedDays(long long z) {
+    return civilFromDayOfEra(floorDiv(z, 146097), z - floorDiv(z, 146097) * 146097);
+}
+
+} // namespace detail
+
+// 1970-01-01 起的天数 
+constexpr long long daysFromCivil(int year, int month, int day) {
+    return detail::daysFromMarchYear(static_cast<long long>(year) - (month <= 2 ? 1 : 0),
+                                     detail::marchDayOfYear(month, day));
+}
+
+constexpr CivilDate civilFromDays(long long days) {
+    return detail::civilFromShiftedDays(days + 719468);
+}
+
+// 0=Sunday, 1=Monday, ..., 6=Saturday
+constexpr int weekdayFromDays(long long days) {
+    return static_cast<int>(days >= -4 ? (days + 4) % 7 : (days + 5) % 7 + 6);
+}
+
+constexpr bool isLeapYear(int year) {
+    return (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
+}
+
+constexpr int daysInMonth(int year, int month) {
+    return month == 2 ? (isLeapYear(year) ? 29 : 28) : 30 + ((month + (month >> 3)) & 1);
+}
+
+constexpr int dayOfYear(int year, int month, int day) {
+    return static_cast<int>(daysFromCivil(year, month, day) - daysFromCivil(year, 1, 1)) + 1;
+}
+
+// UTC 下的 Unix 秒数 
+constexpr long long secondsFromCivil(int year, int month, int day,
+                                     int hour, int minute, int second) {
+    return daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+}
+
+// 将 UTC 下的 Unix 秒数分解为字段 
+inline DateTimeFields fieldsFromSeconds(long long seconds) {
+    long long days = detail::floorDiv(seconds, 86400);
+    int sod = static_cast<int>(seconds - days * 86400);
+    CivilDate date = civilFromDays(days);
+
+    DateTimeFields fields;
+    fields.year = date.year;
+    fields.month = date.month;
+    fields.day = date.day;
+    fields.hour = sod / 3600;
+    fields.minute = sod / 60 % 60;
+    fields.second = sod % 60;
+    fields.weekday = weekdayFromDays(days);
+    fields.dayOfYear = dayOfYear(date.year, date.month, date.day);
+    return fields;
+}
+
+// 把纪元天数平移 months 个月，日期不变；日期超出目标月份天数时 overflowed 为 true， 
+// RollOver 顺延到下个月，Clamp 与 Throw 取月末（是否抛出由调用方决定） 
+inline long long addMonthsToDays(long long days, long long months, MonthOverflow policy, bool& overflowed) {
+    CivilDate date = civilFromDays(days);
+    long long index = static_cast<long long>(date.year) * 12 + (date.month - 1) + months;
+    long long year = detail::floorDiv(index, 12);
+    int month = static_cast<int>(index - year * 12) + 1;
+    int last = daysInMonth(static_cast<int>(year), month);
+    overflowed = date.day > last;
+    // daysFromCivil 对超出月末的日期线性外推，正好得到顺延的结果 
+    int day = overflowed && policy != MonthOverflow::RollOver ? last : date.day;
+    return daysFromCivil(static_cast<int>(year), month, day);
+}
+
+// 取整方向；Nearest 恰在正中间时取较晚的边界 
+enum class Rounding {
+    Floor,
+    Ceil,
+    Nearest
+};
+
+// ticks 为纪元起的计数（每秒 ticksPerSecond 个），求它所在的 unit 区间 [lower, upper) 
+// 小于一个计数的单位视为一个计数；日历单位先换算为天数，再用 civil 算法求月初、季初与年初 
+inline void unitBounds(long long ticks, long long ticksPerSecond, TimeUnit unit, long long& lower, long long& upper) {
+    long long size = 0;
+    switch (unit) {
+    case TimeUnit::Nanosecond: size = ticksPerSecond / 1000000000; break;
+    case TimeUnit::Microsecond: size = ticksPerSecond / 1000000; break;
+    case TimeUnit::Millisecond: size = ticksPerSecond / 1000; break;
+    case TimeUnit::Second: size = ticksPerSecond; break;
+    case TimeUnit::Minute: size = ticksPerSecond * 60; break;
+    case TimeUnit::Hour: size = ticksPerSecond * 3600; break;
+    case TimeUnit::Day: size = ticksPerSecond * 86400; break;
+    case TimeUnit::Week:
+    case TimeUnit::Month:
+    case TimeUnit::Quarter:
+    case TimeUnit::Year: break;
+    }
+    if (size != 0 || unit < TimeUnit::Week) {
+        size = size > 0 ? size : 1;
+        long long remainder = ticks % size;
+        lower = ticks - (remainder < 0 ? remainder + size : remainder);
+        upper = lower + size;
+        return;
+    }
+
+    const long long ticksPerDay = ticksPerSecond * 86400;
+    long long days = detail::floorDiv(ticks, ticksPerDay);
+    long long first = 0;
+    long long next = 0;
+    if (unit == TimeUnit::Week) {
+        // 1970-01-01 为星期四，(days + 3) mod 7 为距星期一的天数 
+        first = days - (days + 3 - detail::floorDiv(days + 3, 7) * 7);
+        next = first + 7;
+    } else {
+        CivilDate date = civilFromDays(days);
+        int months = unit == TimeUnit::Month ? 1 : unit == TimeUnit::Quarter ? 3 : 12;
+        int month = (date.month - 1) / months * months + 1;
+        first = daysFromCivil(date.year, month, 1);
+        next = month + months > 12 ? daysFromCivil(date.year + 1, month + months - 12, 1)
+                                   : daysFromCivil(date.year, month + months, 1);
+    }
+    lower = first * ticksPerDay;
+    upper = next * ticksPerDay;
+}
+
+inline long long roundTicks(long long ticks, long long ticksPerSecond, TimeUnit unit, Rounding mode) {
+    long long lower = 0;
+    long long upper = 0;
+    unitBounds(ticks, ticksPerSecond, unit, lower, upper);
+    switch (mode) {
+    case Rounding::Floor: return lower;
+    case Rounding::Ceil: return ticks == lower ? lower : upper;
+    case Rounding::Nearest: break;
+    }
+    return ticks - lower < upper - ticks ? lower : upper;
+}
+
+} // namespace civil
+
+namespace detail {
+
+// 时区缩写驻留表：只增不减，DateTime 中只保存 16 位下标；0 表示没有缩写 
+// 驻留在加载时区时加锁完成，按下标读取无锁，返回的指针在进程内一直有效 
+unsigned short internZoneAbbreviation(const char* abbreviation, size_t length);
+const char* zoneAbbreviation(unsigned short id);
+
+#ifdef DATETIME_ENABLE_STATS
+// TimeZone 逐日偏移表的插桩点，计入调用线程自己的统计量 
+void countZoneCacheLookup(bool hit);
+#endif
+
+} // namespace detail
+
+// 粗粒度系统时钟：满足标准 Clock 要求，time_point 与 system_clock 相同，用于大量打时间戳而不需要亚毫秒精度的场景 
+// 默认读取 CLOCK_REALTIME_COARSE（Linux，精度为一个内核节拍，通常 1-4ms），不可用时回退到 system_clock 
+// startTicker 后改为读取后台线程按给定间隔发布的原子时间戳，读取只是一次原子加载 
+class CoarseClock {
+public:
+    typedef std::chrono::system_clock::duration duration;
+    typedef duration::rep rep;
+    typedef duration::period period;
+    typedef std::chrono::system_clock::time_point time_point;
+    static constexpr bool is_steady = false;
+
+    static time_point now() noexcept;
+
+    // 启动后台刷新线程；已在运行时只调整间隔。interval 不为正时抛出异常 
+    static void startTicker(std::chrono::nanoseconds interval = std::chrono::milliseconds(1));
+    static void stopTicker();
+    static bool tickerRunning();
+    // 当前时间源的精度：刷新间隔、CLOCK_REALTIME_COARSE 的精度或 system_clock 的单位 
+    static std::chrono::nanoseconds resolution();
+};
+
+// 预编译的格式说明 
+// 构造时把 strftime 风格的格式串拆成扁平的操作序列，之后格式化与解析都直接按序列执行；
+// 常用的 ISO 8601 / RFC 3339 布局在编译时识别出来并走定长快速路径 
+// 除标准说明符外还支持 %f（微秒，6 位）和 %:z（+hh:mm 形式的 UTC 偏移） 
+class FormatSpec {
+public:
+    enum Layout {
+        Generic,
+        DateTimeLayout,  // "%Y-%m-%d %H:%M:%S"
+        Iso8601,         // "%Y-%m-%dT%H:%M:%S"
+        Rfc3339          // "%Y-%m-%dT%H:%M:%S%:z"
+    };
+
+    // conversion 为 0 时表示字面字符 value；否则 value 为修饰符（'E'、'O'、':' 或 0）
+    struct Op {
+        char conversion;
+        char value;
+    };
+
+    static const size_t kMaxOps = 64;
+
+    explicit FormatSpec(const char* pattern);
+    explicit FormatSpec(const std::string& pattern);
+
+    static const FormatSpec& iso8601();
+    static const FormatSpec& rfc3339();
+
+    const std::string& pattern() const { return pattern_; }
+    Layout layout() const { return layout_; }
+    // 操作序列超过 kMaxOps 时不预编译，格式化时退回逐字符解释 
+    bool compiled() const { return compiled_; }
+    // 全部说明符都能由内置解析器处理（否则 fromString 退回 std::get_time）
+    bool parsable() const { return compiled_ && parsable_; }
+    size_t size() const { return size_; }
+    const Op& operator[](size_t index) const { return ops_[index]; }
+
+    // 编译期检查格式串能否完全由内置解析器处理 
+    static constexpr bool isParsable(const char* pattern) {
+        return *pattern == '\0' ? true
+             : *pattern != '%' ? isParsable(pattern + 1)
+             : pattern[1] == ':' ? (pattern[2] == 'z' && isParsable(pattern + 3))
+             : (isParsableConversion(pattern[1]) && isParsable(pattern + 2));
+    }
+
+    static constexpr bool isParsableConversion(char c) {
+        return c == 'Y' || c == 'm' || c == 'd' || c == 'e' || c == 'H' || c == 'M' ||
+               c == 'S' || c == 'y' || c == 'F' || c == 'T' || c == 'R' || c == 'f' ||
+               c == 'z' || c == 'n' || c == 't' || c == '%';
+    }
+
+private:
+    void compile();
+    void push(char conversion, char value);
+
+    std::string pattern_;
+    Op ops_[kMaxOps];
+    size_t size_;
+    Layout layout_;
+    bool compiled_;
+    bool parsable_;
+};
+
+// 编译期校验格式串，首次使用时构造一次 FormatSpec，之后直接复用 
+#define DATETIME_FORMAT(pattern)                                                        \
+    ([]() -> const ::datetime::FormatSpec& {                                            \
+        static_assert(::datetime::FormatSpec::isParsable(pattern),                      \
+                      "format contains conversions the datetime parser cannot handle"); \
+        static const ::datetime::FormatSpec spec(pattern);                              \
+        return spec;                                                                    \
+    }())
+
 class DateTime {
 private:
     std::chrono::system_clock::time_point time_point_;
+#ifdef DATETIME_CACHE_FIELDS
+    // 惰性缓存的分解结果，同一实例不可跨线程并发读取 
+    mutable DateTimeFields fields_cache_;
+    mutable bool fields_cached_ = false;
+#endif
+    // UTC 模式只使用 civil 算法，不经过 localtime_r/mktime 
+    // in() 得到的固定偏移模式同样走 civil 算法，offset_ 为相对 UTC 的秒数，zone_ 为缩写下标 
+    // zoned_ 标记 in() 得到的时刻；缩写未能登记时 zone_ 为 0，不能据此判断是否为 UTC 
+    int32_t offset_ = 0;
+    unsigned short zone_ = 0;
+    bool utc_ = false;
+    bool zoned_ = false;
+
+    DateTime shiftedBy(const std::chrono::system_clock::duration& offset) const;
+    // 不计入 formatCalls 的格式化，CachedNowFormatter 分段刷新时使用，自己只计一次 
+    size_t formatUncounted(char* out, size_t capacity, const char* format) const;
+
+    friend class CachedNowFormatter;
 
 public:
     // 构造函数 
@@ -22,10 +422,41 @@ public:
 
     // 静态工厂方法 
     static DateTime now();
+    // 读取 CoarseClock，代价远低于 now()，误差不超过 CoarseClock::resolution() 
+    static DateTime nowCoarse();
     static DateTime fromString(const std::string& dateStr, const std::string& format = "%Y-%m-%d %H:%M:%S");
+    static DateTime fromString(const std::string& dateStr, const FormatSpec& spec);
     static DateTime fromTimestamp(time_t timestamp);
 
+    // 不抛出异常的构造与解析：成功时写入 out 并返回 Status::Ok，失败时 out 保持不变 
+    // 用于格式错误较常见的输入，避免异常展开的开销；-fno-exceptions 构建下同样可用 
+    static Status tryMake(int year, int month, int day, DateTime& out);
+    static Status tryMake(int year, int month, int day, int hour, int minute, int second, DateTime& out);
+    static Status tryMakeUtc(int year, int month, int day, DateTime& out);
+    static Status tryMakeUtc(int year, int month, int day, int hour, int minute, int second, DateTime& out);
+    static Status tryParse(const std::string& dateStr, DateTime& out);
+    static Status tryParse(const std::string& dateStr, const std::string& format, DateTime& out);
+    static Status tryParse(const std::string& dateStr, const FormatSpec& spec, DateTime& out);
+    static Status tryParseUtc(const std::string& dateStr, DateTime& out);
+    static Status tryParseUtc(const std::string& dateStr, const std::string& format, DateTime& out);
+    static Status tryParseUtc(const std::string& dateStr, const FormatSpec& spec, DateTime& out);
+
+    // UTC 模式工厂方法 
+    static DateTime utc(int year, int month, int day, int hour = 0, int minute = 0, int second = 0);
+    static DateTime utcNow();
+    static DateTime fromStringUtc(const std::string& dateStr, const std::string& format = "%Y-%m-%d %H:%M:%S");
+    static DateTime fromStringUtc(const std::string& dateStr, const FormatSpec& spec);
+
+    // 在本地时间与 UTC 模式之间切换，表示的时刻不变 
+    DateTime toUtc() const;
+    DateTime toLocal() const;
+    bool isUtc() const;
+    // 转换到指定时区：按该时刻在 tz 中的偏移与缩写得到固定偏移模式的 DateTime 
+    // 之后的运算保持这一偏移，不再跟随夏令时变化；需要时重新调用 in() 
+    DateTime in(const TimeZone& tz) const;
+
     // 获取日期时间组件 
+    DateTimeFields fields() const;  // 一次本地时间转换得到全部字段
     int year() const;
     int month() const;
     int day() const;
@@ -37,26 +468,44 @@ public:
 
     // 格式化输出 
     std::string toString(const std::string& format = "%Y-%m-%d %H:%M:%S") const;
+    std::string toString(const std::string& format, const TimeZone& tz) const;
     std::string isoformat() const;
     std::string strftime(const std::string& format) const;
+    std::string strftime(const FormatSpec& spec) const;
+
+    // 直接写入调用方缓冲区，不分配堆内存 
+    // 返回写入的字符数（不含结尾的'\0'）；与 std::strftime 相同，空间不足时返回 0
+    size_t formatTo(char* out, size_t capacity, const char* format = "%Y-%m-%d %H:%M:%S") const;
+    size_t formatTo(char* out, size_t capacity, const FormatSpec& spec) const;
+    template <class OutputIt>
+    OutputIt formatTo(OutputIt out, const char* format) const;
 
     // 时间戳 
     time_t timestamp() const;
     long long milliseconds() const;
+    long long microseconds() const;
+    long long nanoseconds() const;
 
     // 日期时间运算 
-    DateTime addYears(int years) const;
-    DateTime addMonths(int months) const;
+    // 按墙上日期平移，时分秒与亚秒部分不变；目标月份中不存在原日期时按 overflow 处理 
+    DateTime addYears(int years, MonthOverflow overflow = MonthOverflow::RollOver) const;
+    DateTime addMonths(int months, MonthOverflow overflow = MonthOverflow::RollOver) const;
     DateTime addDays(int days) const;
     DateTime addHours(int hours) const;
     DateTime addMinutes(int minutes) const;
     DateTime addSeconds(int seconds) const;
 
+    // 按 unit 取整，保持原有模式；本地与固定偏移模式按墙上时间取整 
+    // 天以下的单位直接在当前偏移下整数运算；本地模式的日历单位经 mktime 解析边界（可能跨越夏令时） 
+    DateTime floor(TimeUnit unit) const;
+    DateTime ceil(TimeUnit unit) const;
+    DateTime round(TimeUnit unit) const;
+
     // 日期替换 
     DateTime replace(int year = -1, int month = -1, int day = -1,
                     int hour = -1, int minute = -1, int second = -1) const;
 
-    // 比较操作符 
+    // 比较操作符（只比较时刻，不区分模式） 
     bool operator==(const DateTime& other) const;
     bool operator!=(const DateTime& other) const;
     bool operator<(const DateTime& other) const;
@@ -66,49 +515,464 @@ public:
 
     // 获取内部时间点 
     std::chrono::system_clock::time_point getTimePoint() const;
+
+    friend DateTime operator+(const DateTime& dt, const TimeDelta& td);
+    friend DateTime operator-(const DateTime& dt, const TimeDelta& td);
+    template <class Duration>
+    friend DateTime operator+(const DateTime& dt, const BasicTimeDelta<Duration>& td);
+    template <class Duration>
+    friend DateTime operator-(const DateTime& dt, const BasicTimeDelta<Duration>& td);
 };
 
-// 时间差类 
-class TimeDelta {
+template <class OutputIt>
+OutputIt DateTime::formatTo(OutputIt out, const char* format) const {
+    char buffer[256];
+    size_t length = formatTo(buffer, sizeof(buffer), format);
+    return std::copy(buffer, buffer + length, out);
+}
+
+// 构造、比较和定长运算只是时间点上的整数操作，在头文件中内联，排序和比较循环中不产生函数调用 
+inline DateTime::DateTime(const std::chrono::system_clock::time_point& tp) : time_point_(tp) {}
+
+inline DateTime::DateTime(time_t timestamp) : time_point_(std::chrono::system_clock::from_time_t(timestamp)) {}
+
+inline DateTime DateTime::fromTimestamp(time_t timestamp) {
+    return { timestamp };
+}
+
+inline DateTime DateTime::toUtc() const {
+    DateTime result(time_point_);
+    result.utc_ = true;
+    return result;
+}
+
+inline DateTime DateTime::toLocal() const {
+    return { time_point_ };
+}
+
+inline bool DateTime::isUtc() const {
+    return utc_ && !zoned_;
+}
+
+inline DateTime DateTime::shiftedBy(const std::chrono::system_clock::duration& offset) const {
+    DateTime result(time_point_ + offset);
+    result.offset_ = offset_;
+    result.zone_ = zone_;
+    result.utc_ = utc_;
+    result.zoned_ = zoned_;
+    return result;
+}
+
+inline time_t DateTime::timestamp() const {
+    return std::chrono::system_clock::to_time_t(time_point_);
+}
+
+inline long long DateTime::milliseconds() const {
+    auto duration = time_point_.time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+}
+
+inline long long DateTime::microseconds() const {
+    auto duration = time_point_.time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+inline long long DateTime::nanoseconds() const {
+    auto duration = time_point_.time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+}
+
+inline DateTime DateTime::addDays(int days) const {
+    return shiftedBy(std::chrono::hours(24 * days));
+}
+
+inline DateTime DateTime::addHours(int hours) const {
+    return shiftedBy(std::chrono::hours(hours));
+}
+
+inline DateTime DateTime::addMinutes(int minutes) const {
+    return shiftedBy(std::chrono::minutes(minutes));
+}
+
+inline DateTime DateTime::addSeconds(int seconds) const {
+    return shiftedBy(std::chrono::seconds(seconds));
+}
+
+inline bool DateTime::operator==(const DateTime& other) const {
+    return time_point_ == other.time_point_;
+}
+
+inline bool DateTime::operator!=(const DateTime& other) const {
+    return !(*this == other);
+}
+
+inline bool DateTime::operator<(const DateTime& other) const {
+    return time_point_ < other.time_point_;
+}
+
+inline bool DateTime::operator<=(const DateTime& other) const {
+    return time_point_ <= other.time_point_;
+}
+
+inline bool DateTime::operator>(const DateTime& other) const {
+    return time_point_ > other.time_point_;
+}
+
+inline bool DateTime::operator>=(const DateTime& other) const {
+    return time_point_ >= other.time_point_;
+}
+
+inline std::chrono::system_clock::time_point DateTime::getTimePoint() const {
+    return time_point_;
+}
+
+// 日志前缀等“当前时刻”格式化的缓存：同一秒内除 %f 外的内容只格式化一次 
+// 结果保存在 seqlock 保护的共享槽位中，按原子字读写，多个线程可以同时使用同一个实例 
+// 命中时的代价是一次取时加一次拷贝，再按当前时刻改写 %f 对应的 6 位微秒数字 
+// 结果超过 kCapacity - 1 个字符或 %f 超过 kMaxFractions 个时不缓存，每次完整格式化 
+class CachedNowFormatter {
+public:
+    static const size_t kCapacity = 64;
+    static const size_t kMaxFractions = 4;
+
+    explicit CachedNowFormatter(const std::string& pattern = "%Y-%m-%d %H:%M:%S", bool utc = false);
+    CachedNowFormatter(const CachedNowFormatter&) = delete;
+    CachedNowFormatter& operator=(const CachedNowFormatter&) = delete;
+
+    // 与 DateTime::formatTo 相同：返回写入的字符数（不含结尾的'\0'），空间不足时返回 0 
+    size_t formatTo(char* out, size_t capacity) const;
+    // 指定时刻，例如传入 CoarseClock::now() 以进一步降低取时开销 
+    size_t formatTo(char* out, size_t capacity, const std::chrono::system_clock::time_point& tp) const;
+    std::string format() const;
+
+    const std::string& pattern() const { return pattern_; }
+    bool isUtc() const { return utc_; }
+
 private:
-    std::chrono::seconds duration_;
+    static const size_t kWords = kCapacity / 8;
+
+    size_t refresh(long long second, int microseconds, char* out, size_t capacity) const;
+
+    std::string pattern_;
+    bool utc_;
+    bool cacheable_;
+    size_t fractionCount_;
+    size_t fractions_[kMaxFractions];  // 各 %f 在 pattern_ 中的位置 
+
+    // 槽位：sequence_ 为奇数时正在写入；layout_ 依次保存结果长度与各 %f 在结果中的位置，各占 8 位 
+    mutable std::atomic<unsigned> sequence_;
+    mutable std::atomic<long long> second_;
+    mutable std::atomic<unsigned long long> layout_;
+    mutable std::atomic<unsigned long long> words_[kWords];
+};
+
+// 紧凑存储用的 64 位时刻：Unix 纪元起的纳秒数（约 1678-2262 年），只表示时刻，不保存 UTC/本地模式 
+// 平凡可复制、标准布局，可直接放进扁平数组、memcpy、mmap 或按 sortKey() 基数排序 
+struct PackedDateTime {
+    int64_t nanos;
+
+    static PackedDateTime fromDateTime(const DateTime& dt);
+    static constexpr PackedDateTime fromNanoseconds(int64_t nanos) { return PackedDateTime{ nanos }; }
+    static constexpr PackedDateTime fromSeconds(int64_t seconds) { return PackedDateTime{ seconds * 1000000000LL }; }
+
+    // 转回本地时间模式的 DateTime，需要 UTC 模式时再调用 toUtc() 
+    DateTime toDateTime() const;
+    // 向下取整到秒 
+    constexpr int64_t seconds() const { return civil::detail::floorDiv(nanos, 1000000000LL); }
+    // 翻转符号位后按无符号整数比较的顺序与时刻顺序一致 
+    constexpr uint64_t sortKey() const { return static_cast<uint64_t>(nanos) ^ (1ULL << 63); }
+};
+
+static_assert(sizeof(PackedDateTime) == 8, "PackedDateTime must stay 64 bits");
+static_assert(std::is_standard_layout<PackedDateTime>::value, "PackedDateTime must be standard layout");
+static_assert(std::is_trivially_copyable<PackedDateTime>::value, "PackedDateTime must be trivially copyable");
+static_assert(std::ratio_less_equal<std::nano, std::chrono::system_clock::period>::value,
+              "system_clock ticks must be representable in nanoseconds");
+
+inline PackedDateTime PackedDateTime::fromDateTime(const DateTime& dt) {
+    auto duration = dt.getTimePoint().time_since_epoch();
+    return PackedDateTime{ std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() };
+}
+
+inline DateTime PackedDateTime::toDateTime() const {
+    return DateTime(std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(nanos))));
+}
+
+constexpr bool operator==(PackedDateTime a, PackedDateTime b) { return a.nanos == b.nanos; }
+constexpr bool operator!=(PackedDateTime a, PackedDateTime b) { return a.nanos != b.nanos; }
+constexpr bool operator<(PackedDateTime a, PackedDateTime b) { return a.nanos < b.nanos; }
+constexpr bool operator<=(PackedDateTime a, PackedDateTime b) { return a.nanos <= b.nanos; }
+constexpr bool operator>(PackedDateTime a, PackedDateTime b) { return a.nanos > b.nanos; }
+constexpr bool operator>=(PackedDateTime a, PackedDateTime b) { return a.nanos >= b.nanos; }
+
+// 时间差类，精度由 Duration 决定（std::chrono::duration 类型），全部运算为整数运算 
+template <class Duration>
+class BasicTimeDelta {
+private:
+    Duration duration_;
 
 public:
-    TimeDelta();
-    TimeDelta(int days, int hours = 0, int minutes = 0, int seconds = 0);
-    TimeDelta(const std::chrono::seconds& duration);
+    typedef Duration duration_type;
+
+    BasicTimeDelta();
+    BasicTimeDelta(int days, int hours = 0, int minutes = 0, int seconds = 0);
+    BasicTimeDelta(const Duration& duration);
+    // 与 std::chrono::duration 相同，只允许无损的隐式精度转换（如秒 -> 纳秒） 
+    template <class Other,
+              class = typename std::enable_if<std::is_convertible<Other, Duration>::value>::type>
+    BasicTimeDelta(const BasicTimeDelta<Other>& other);
 
     // 获取组件 
+    Duration duration() const;
+    long long count() const;
     long long totalSeconds() const;
     int days() const;
     int seconds() const;  // 不包括天数的秒数部分 
+    long long nanoseconds() const;  // 不足一秒的部分（纳秒），符号与时间差相同 
 
     // 运算符重载 
-    TimeDelta operator+(const TimeDelta& other) const;
-    TimeDelta operator-(const TimeDelta& other) const;
-    TimeDelta operator*(int multiplier) const;
-    TimeDelta operator/(int divisor) const;
-
-    bool operator==(const TimeDelta& other) const;
-    bool operator!=(const TimeDelta& other) const;
-    bool operator<(const TimeDelta& other) const;
-    bool operator<=(const TimeDelta& other) const;
-    bool operator>(const TimeDelta& other) const;
-    bool operator>=(const TimeDelta& other) const;
+    BasicTimeDelta operator+(const BasicTimeDelta& other) const;
+    BasicTimeDelta operator-(const BasicTimeDelta& other) const;
+    BasicTimeDelta operator*(int multiplier) const;
+    BasicTimeDelta operator/(int divisor) const;
+
+    bool operator==(const BasicTimeDelta& other) const;
+    bool operator!=(const BasicTimeDelta& other) const;
+    bool operator<(const BasicTimeDelta& other) const;
+    bool operator<=(const BasicTimeDelta& other) const;
+    bool operator>(const BasicTimeDelta& other) const;
+    bool operator>=(const BasicTimeDelta& other) const;
 
+    // 秒以下精度且小数部分非零时追加 ".fff" / ".ffffff" / ".fffffffff" 
     std::string toString() const;
 };
 
+template <class Duration>
+BasicTimeDelta<Duration>::BasicTimeDelta() : duration_(0) {}
+
+template <class Duration>
+BasicTimeDelta<Duration>::BasicTimeDelta(int days, int hours, int minutes, int seconds)
+    : duration_(std::chrono::duration_cast<Duration>(
+          std::chrono::seconds(days * 24 * 3600 + hours * 3600 + minutes * 60 + seconds))) {}
+
+template <class Duration>
+BasicTimeDelta<Duration>::BasicTimeDelta(const Duration& duration) : duration_(duration) {}
+
+template <class Duration>
+template <class Other, class>
+BasicTimeDelta<Duration>::BasicTimeDelta(const BasicTimeDelta<Other>& other) : duration_(other.duration()) {}
+
+template <class Duration>
+Duration BasicTimeDelta<Duration>::duration() const {
+    return duration_;
+}
+
+template <class Duration>
+long long BasicTimeDelta<Duration>::count() const {
+    return static_cast<long long>(duration_.count());
+}
+
+template <class Duration>
+long long BasicTimeDelta<Duration>::totalSeconds() const {
+    return std::chrono::duration_cast<std::chrono::seconds>(duration_).count();
+}
+
+template <class Duration>
+int BasicTimeDelta<Duration>::days() const {
+    return static_cast<int>(totalSeconds() / (24 * 3600));
+}
+
+template <class Duration>
+int BasicTimeDelta<Duration>::seconds() const {
+    return static_cast<int>(totalSeconds() % (24 * 3600));
+}
+
+template <class Duration>
+long long BasicTimeDelta<Duration>::nanoseconds() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        duration_ - std::chrono::duration_cast<Duration>(std::chrono::seconds(totalSeconds()))).count();
+}
+
+template <class Duration>
+BasicTimeDelta<Duration> BasicTimeDelta<Duration>::operator+(const BasicTimeDelta& other) const {
+    return { duration_ + other.duration_ };
+}
+
+template <class Duration>
+BasicTimeDelta<Duration> BasicTimeDelta<Duration>::operator-(const BasicTimeDelta& other) const {
+    return { duration_ - other.duration_ };
+}
+
+template <class Duration>
+BasicTimeDelta<Duration> BasicTimeDelta<Duration>::operator*(int multiplier) const {
+    return { duration_ * multiplier };
+}
+
+template <class Duration>
+BasicTimeDelta<Duration> BasicTimeDelta<Duration>::operator/(int divisor) const {
+    return { duration_ / divisor };
+}
+
+template <class Duration>
+bool BasicTimeDelta<Duration>::operator==(const BasicTimeDelta& other) const {
+    return duration_ == other.duration_;
+}
+
+template <class Duration>
+bool BasicTimeDelta<Duration>::operator!=(const BasicTimeDelta& other) const {
+    return !(*this == other);
+}
+
+template <class Duration>
+bool BasicTimeDelta<Duration>::operator<(const BasicTimeDelta& other) const {
+    return duration_ < other.duration_;
+}
+
+template <class Duration>
+bool BasicTimeDelta<Duration>::operator<=(const BasicTimeDelta& other) const {
+    return duration_ <= other.duration_;
+}
+
+template <class Duration>
+bool BasicTimeDelta<Duration>::operator>(const BasicTimeDelta& other) const {
+    return duration_ > other.duration_;
+}
+
+template <class Duration>
+bool BasicTimeDelta<Duration>::operator>=(const BasicTimeDelta& other) const {
+    return duration_ >= other.duration_;
+}
+
+template <class Duration>
+std::string BasicTimeDelta<Duration>::toString() const {
+    long long total_seconds = totalSeconds();
+    int days = static_cast<int>(total_seconds / (24 * 3600));
+    int hours = static_cast<int>((total_seconds % (24 * 3600)) / 3600);
+    int minutes = static_cast<int>((total_seconds % 3600) / 60);
+    int seconds = static_cast<int>(total_seconds % 60);
+
+    std::ostringstream oss;
+    if (days != 0) {
+        oss << days << " day" << (days != 1 ? "s" : "") << ", ";
+    }
+
+    oss << std::setfill('0') << std::setw(2) << hours << ":"
+        << std::setw(2) << minutes << ":" << std::setw(2) << seconds;
+
+    long long fraction = nanoseconds();
+    if (fraction != 0) {
+        fraction = fraction < 0 ? -fraction : fraction;
+        const long long den = Duration::period::den / Duration::period::num;
+        if (den <= 1000) {
+            oss << "." << std::setw(3) << fraction / 1000000;
+        } else if (den <= 1000000) {
+            oss << "." << std::setw(6) << fraction / 1000;
+        } else {
+            oss << "." << std::setw(9) << fraction;
+        }
+    }
+
+    return oss.str();
+}
+
+#ifndef DATETIME_HEADER_ONLY
+// 秒精度版本在库中显式实例化 
+extern template class BasicTimeDelta<std::chrono::seconds>;
+#endif
+
 // DateTime 和 TimeDelta 之间的运算 
-DateTime operator+(const DateTime& dt, const TimeDelta& td);
-DateTime operator-(const DateTime& dt, const TimeDelta& td);
-TimeDelta operator-(const DateTime& dt1, const DateTime& dt2);
+inline DateTime operator+(const DateTime& dt, const TimeDelta& td) {
+    return dt.shiftedBy(td.duration());
+}
+
+inline DateTime operator-(const DateTime& dt, const TimeDelta& td) {
+    return dt.shiftedBy(-td.duration());
+}
+
+inline TimeDelta operator-(const DateTime& dt1, const DateTime& dt2) {
+    auto diff = dt1.getTimePoint() - dt2.getTimePoint();
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(diff);
+    return { seconds };
+}
+
+// 任意精度的时间差；小于 system_clock 精度的部分向零截断 
+template <class Duration>
+DateTime operator+(const DateTime& dt, const BasicTimeDelta<Duration>& td) {
+    return dt.shiftedBy(std::chrono::duration_cast<std::chrono::system_clock::duration>(td.duration()));
+}
+
+template <class Duration>
+DateTime operator-(const DateTime& dt, const BasicTimeDelta<Duration>& td) {
+    return dt.shiftedBy(-std::chrono::duration_cast<std::chrono::system_clock::duration>(td.duration()));
+}
+
+// 按指定精度计算 dt1 - dt2，向零截断；difference<std::chrono::nanoseconds> 不丢失精度 
+template <class Duration>
+BasicTimeDelta<Duration> difference(const DateTime& dt1, const DateTime& dt2) {
+    return { std::chrono::duration_cast<Duration>(dt1.getTimePoint() - dt2.getTimePoint()) };
+}
 
 // 工具函数 
-bool isLeapYear(int year);
+inline bool isLeapYear(int year) {
+    return civil::isLeapYear(year);
+}
 int daysInMonth(int year, int month);
 std::string formatDuration(const TimeDelta& td);
+template <class Duration>
+std::string formatDuration(const BasicTimeDelta<Duration>& td) {
+    return td.toString();
+}
+
+// ISO 8601 / RFC 3339 解析：不抛异常、不分配内存、不访问 locale 
+// 接受 "YYYY-MM-DD" 与 "YYYY-MM-DDTHH:MM[:SS[.fffffffff]]"（分隔符可为 'T'、't' 或空格），
+// 可带 "Z" 或 ±hh[[:]mm] 偏移；整个输入必须匹配，失败时返回 false 且不修改 out 
+// 不带偏移的时间按本地时间解释 
+bool parseIso8601(const char* str, size_t length, DateTime& out);
+bool parseIso8601(const std::string& str, DateTime& out);
+// 同上，但不带偏移的时间按 UTC 解释，结果为 UTC 模式 
+bool parseIso8601Utc(const char* str, size_t length, DateTime& out);
+bool parseIso8601Utc(const std::string& str, DateTime& out);
+
+// 运行时统计：以 DATETIME_ENABLE_STATS 编译库时，本地时间分解、mktime、解析与格式化各自计数 
+// 每个线程只写自己的计数器，stats() 调用时才汇总所有线程；未定义时插桩点展开为空，stats() 恒为全 0 
+// 另外定义 DATETIME_STATS_CYCLES 时记录每次调用的耗时直方图：x86 上为 rdtsc 周期数，其他平台为纳秒 
+// 仅头文件模式下所有翻译单元必须使用相同的定义 
+struct CycleHistogram {
+    static const int kBuckets = 32;
+    uint64_t buckets[kBuckets];  // 第 i 桶统计耗时落在 [2^i, 2^(i+1)) 的调用，最后一桶包含更大的值
+    uint64_t total;              // 耗时总和
+
+    uint64_t count() const;
+    // 近似分位数（0 < q <= 1），返回所在桶的上界；没有样本时为 0 
+    uint64_t percentile(double q) const;
+};
+
+struct Stats {
+    uint64_t localtimeCalls;  // localtime_r / localtime_s
+    uint64_t mktimeCalls;     // std::mktime
+    uint64_t parseCalls;      // fromString / tryParse / parseIso8601 等
+    uint64_t parseFailures;
+    uint64_t formatCalls;     // strftime / toString / formatTo / CachedNowFormatter
+    uint64_t zoneCacheHits;   // TimeZone 逐日偏移表直接得到结果的查询
+    uint64_t zoneCacheMisses; // 落在表外或当天有多次转换、回退到二分查找的查询
+    CycleHistogram localtimeCycles;
+    CycleHistogram mktimeCycles;
+    CycleHistogram parseCycles;
+    CycleHistogram formatCycles;
+};
+
+// 编译时是否启用了统计 
+bool statsEnabled();
+// 所有线程（含已退出的线程）自上次 resetStats() 以来的计数快照 
+Stats stats();
+// 以当前计数为新的起点；不改写其他线程的计数器，可与插桩点并发调用 
+void resetStats();
 
 } // namespace datetime
 
+#ifdef DATETIME_HEADER_ONLY
+#include "datetime.cpp"
+#endif
+
 #endif // DATETIME_H
@@ -0,0 +1,188 @@
+#ifndef DATETIME_BATCH_H
+#define DATETIME_BATCH_H
+
+#include "datetime.h"
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace datetime {
+
+// 批量接口以 UTC 下的 Unix 秒数列（int64_t 数组）为输入输出，逐行不构造 DateTime 
+
+// 无法解析的行写入的值 
+const int64_t kInvalidEpoch = std::numeric_limits<int64_t>::min();
+
+// 批量内核可用的指令集；运行时检测 CPU 后自动选择 
+enum class SimdLevel {
+    Scalar,
+    Sse42,
+    Avx2
+};
+
+// 当前 CPU 支持的最高级别 
+SimdLevel simdLevel();
+const char* simdLevelName(SimdLevel level);
+
+// 批量解析定长的 "YYYY-MM-DD HH:MM:SS" 列（日期与时间之间也可以是 'T'）
+// base 指向第一行，相邻两行相距 stride 字节，每行至少 19 字节可读；
+// 格式错误或日期无效的行写入 kInvalidEpoch，返回成功解析的行数 
+size_t parseColumn(const char* base, size_t stride, size_t n, int64_t* outEpoch);
+// 指定内核，高于 simdLevel() 时自动降级；主要用于测试与基准 
+size_t parseColumn(const char* base, size_t stride, size_t n, int64_t* outEpoch, SimdLevel level);
+
+// 批量格式化为定宽文本：第 i 行写入 out + i * stride，不写结尾的'\0'，不足 stride 的部分以空格填充 
+// "%Y-%m-%d %H:%M:%S"、ISO 8601 与 RFC 3339 布局使用整数 civil 算法和 SIMD 数字输出；
+// 其他格式逐行按 UTC 模式的 DateTime 格式化 
+// kInvalidEpoch、年份超出 [0, 9999] 或超出 stride 的行整行填充空格；返回成功写入的行数 
+size_t formatColumn(const int64_t* epochs, size_t n, char* out, size_t stride, const FormatSpec& spec);
+size_t formatColumn(const int64_t* epochs, size_t n, char* out, size_t stride, const FormatSpec& spec,
+                    SimdLevel level);
+
+// extractFields 可提取的字段，按位组合 
+enum class Field : unsigned {
+    None = 0,
+    Year = 1u << 0,
+    Month = 1u << 1,
+    Day = 1u << 2,
+    Hour = 1u << 3,
+    Minute = 1u << 4,
+    Second = 1u << 5,
+    Weekday = 1u << 6,
+    DayOfYear = 1u << 7,
+    Date = Year | Month | Day,
+    Time = Hour | Minute | Second,
+    All = Date | Time | Weekday | DayOfYear
+};
+
+constexpr Field operator|(Field a, Field b) {
+    return static_cast<Field>(static_cast<unsigned>(a) | static_cast<unsigned>(b));
+}
+
+constexpr Field operator&(Field a, Field b) {
+    return static_cast<Field>(static_cast<unsigned>(a) & static_cast<unsigned>(b));
+}
+
+constexpr bool hasField(Field mask, Field field) {
+    return (mask & field) != Field::None;
+}
+
+// extractFields 的输出列，每列 n 个元素；只需为请求的字段提供指针，可用 ColumnOut out = {}; 清零后逐个赋值 
+struct ColumnOut {
+    int32_t* year;
+    uint8_t* month;       // 1-12 
+    uint8_t* day;         // 1-31 
+    uint8_t* hour;
+    uint8_t* minute;
+    uint8_t* second;
+    uint8_t* weekday;     // 0=Sunday 
+    uint16_t* dayOfYear;  // 1-366 
+};
+
+// 一次遍历把 UTC 秒数列分解为 mask 中的各个字段列 
+// kInvalidEpoch 与超出 ±2^55 秒的行在所有请求的列中写入 0（month 为 0 即表示无效）；返回有效行数 
+// AVX2 内核每次处理 8 行，以 32 位通道执行 civil 算法，覆盖 0000-03-01 至约 22900 年，其余行逐行计算 
+// mask 中的字段缺少对应的输出指针时抛出异常 
+size_t extractFields(const int64_t* epochs, size_t n, Field mask, const ColumnOut& out);
+size_t extractFields(const int64_t* epochs, size_t n, Field mask, const ColumnOut& out, SimdLevel level);
+
+// 批量时间运算：秒数列中的 kInvalidEpoch 原样保留；PackedDateTime 列没有无效值 
+// 内核为简单的逐元素循环，可由编译器自动向量化；整数溢出按二进制补码回绕 
+// Parallel 时把数组切成连续的块交给 hardware_concurrency() 个线程，规模较小时仍在调用线程中执行 
+enum class Execution {
+    Sequential,
+    Parallel
+};
+
+// epochs[i] += seconds 
+void addSeconds(int64_t* epochs, size_t n, int64_t seconds, Execution execution = Execution::Sequential);
+// values[i] += delta 
+void addDuration(PackedDateTime* values, size_t n, std::chrono::nanoseconds delta,
+                 Execution execution = Execution::Sequential);
+
+// 按 UTC 日历平移月份或年份，时分秒不变，与 UTC 模式的 DateTime::addMonths / addYears 一致 
+// 返回原日期在目标月份中不存在（被顺延或取月末）的行数；Throw 时只要有一行如此就抛出异常，且不修改任何数据 
+// 秒数列中超出 ±2^55 秒的行写入 kInvalidEpoch 
+size_t addMonths(int64_t* epochs, size_t n, int months, MonthOverflow overflow = MonthOverflow::RollOver,
+                 Execution execution = Execution::Sequential);
+size_t addMonths(PackedDateTime* values, size_t n, int months, MonthOverflow overflow = MonthOverflow::RollOver,
+                 Execution execution = Execution::Sequential);
+size_t addYears(int64_t* epochs, size_t n, int years, MonthOverflow overflow = MonthOverflow::RollOver,
+                Execution execution = Execution::Sequential);
+size_t addYears(PackedDateTime* values, size_t n, int years, MonthOverflow overflow = MonthOverflow::RollOver,
+                Execution execution = Execution::Sequential);
+
+// out[i] = a[i] - b[i]，单位分别为秒和纳秒；秒数列任一侧无效时写入 kInvalidEpoch；out 可以与 a 或 b 相同 
+void difference(const int64_t* a, const int64_t* b, size_t n, int64_t* out,
+                Execution execution = Execution::Sequential);
+void difference(const PackedDateTime* a, const PackedDateTime* b, size_t n, int64_t* outNanoseconds,
+                Execution execution = Execution::Sequential);
+
+// 按 UTC 取整到 unit 的边界，与 DateTime::floor / ceil / round 一致：truncateTo 向过去取整（纪元之前同样如此）， 
+// ceilTo 向未来取整，roundTo 取较近的边界、正中间时取较晚者；秒数列上小于秒的单位不做改动 
+// 天及以下的单位为常数除法内核，周与日历单位逐元素走 civil 算法 
+void truncateTo(int64_t* epochs, size_t n, TimeUnit unit, Execution execution = Execution::Sequential);
+void truncateTo(PackedDateTime* values, size_t n, TimeUnit unit, Execution execution = Execution::Sequential);
+void ceilTo(int64_t* epochs, size_t n, TimeUnit unit, Execution execution = Execution::Sequential);
+void ceilTo(PackedDateTime* values, size_t n, TimeUnit unit, Execution execution = Execution::Sequential);
+void roundTo(int64_t* epochs, size_t n, TimeUnit unit, Execution execution = Execution::Sequential);
+void roundTo(PackedDateTime* values, size_t n, TimeUnit unit, Execution execution = Execution::Sequential);
+
+
+// 有序列中的一段行 [begin, end) 
+struct RowRange {
+    size_t begin;
+    size_t end;
+
+    size_t size() const { return end - begin; }
+    bool empty() const { return begin == end; }
+};
+
+// 按时间升序排序，稳定：相同时刻的元素保持原有的相对顺序；DateTime 按时刻排序，与 operator< 一致 
+// 对 64 位计数做 LSD 基数排序：键减去最小值并去掉所有元素共有的低位后，按剩余的有效位分遍（每遍至多 11 位）， 
+// 30 年跨度的秒数只需 3 遍；需要 n 个元素的额外缓冲区。秒数列中的 kInvalidEpoch 排在最前 
+// Parallel 时每一遍的统计与分发都按块并行 
+void sortTimes(int64_t* epochs, size_t n, Execution execution = Execution::Sequential);
+void sortTimes(PackedDateTime* values, size_t n, Execution execution = Execution::Sequential);
+void sortTimes(DateTime* values, size_t n, Execution execution = Execution::Sequential);
+
+// 升序列中第一个不早于 t 的行号，不存在时为 n；无分支二分查找 
+size_t lowerBoundTime(const int64_t* sorted, size_t n, int64_t epoch);
+size_t lowerBoundTime(const PackedDateTime* sorted, size_t n, PackedDateTime t);
+size_t lowerBoundTime(const DateTime* sorted, size_t n, const DateTime& t);
+
+// 升序列中时刻落在 [from, to) 的行；to 不晚于 from 时为空 
+RowRange rangeQuery(const int64_t* sorted, size_t n, int64_t from, int64_t to);
+RowRange rangeQuery(const PackedDateTime* sorted, size_t n, PackedDateTime from, PackedDateTime to);
+RowRange rangeQuery(const DateTime* sorted, size_t n, const DateTime& from, const DateTime& to);
+
+// 对同一升序列反复查找时使用：键按 Eytzinger（BFS）顺序另存一份，查找自根向下， 
+// 每层访问的结点在内存中相邻，可以提前预取四层，大列上比 std::lower_bound 少很多缓存未命中 
+// 行号由结点位置直接算出，不另存；查询值与建立索引的列单位相同：秒数列用秒，PackedDateTime 列用纳秒 
+class EytzingerIndex {
+public:
+    EytzingerIndex();
+    EytzingerIndex(const int64_t* sorted, size_t n);
+    EytzingerIndex(const PackedDateTime* sorted, size_t n);
+
+    size_t size() const { return keys_.size() - 1; }
+
+    // 第一个不小于 key 的行号，不存在时为 size() 
+    size_t lowerBound(int64_t key) const;
+    size_t lowerBound(PackedDateTime t) const { return lowerBound(t.nanos); }
+    RowRange range(int64_t from, int64_t to) const;
+    RowRange range(PackedDateTime from, PackedDateTime to) const { return range(from.nanos, to.nanos); }
+
+private:
+    std::vector<int64_t> keys_;  // keys_[0] 不使用，结点 k 的子结点为 2k 与 2k+1
+    int height_;                 // 最后一层的深度，根为 0
+    size_t lastLevel_;           // 最后一层的结点数
+};
+
+} // namespace datetime
+
+#ifdef DATETIME_HEADER_ONLY
+#include "datetime_batch.cpp"
+#endif
+
+#endif // DATETIME_BATCH_H
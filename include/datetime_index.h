@@ -0,0 +1,100 @@
+#ifndef DATETIME_INDEX_H
+#define DATETIME_INDEX_H
+
+#include "datetime_batch.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace datetime {
+
+namespace detail {
+
+// TimeIndex 的块目录项，同时也是镜像文件中的布局 
+struct TimeIndexBlock {
+    int64_t min;
+    int64_t max;
+    uint64_t wordOffset;   // 打包数据在字数组中的起点
+    uint64_t scale;        // 各行与 min 之差的最大公约数，第 i 行为 min + packed[i] * scale
+    uint8_t bits;          // 每行的位宽，0 表示块内各行相同
+    uint8_t reserved[7];
+};
+
+static_assert(sizeof(TimeIndexBlock) == 40, "TimeIndexBlock is part of the image layout");
+
+} // namespace detail
+
+// 大量事件时刻上的区间查询，例如 "某一天内有哪些事件" 
+// 时刻按非降序追加，行号就是追加的顺序；每满 kBlockRows 行封成一个压缩块：块内各行存为与块最小值的差， 
+// 除以这些差的最大公约数后按固定位宽打包（秒级数据的纳秒时刻即除以 10^9，每行通常只需十几位），可以按行号直接解码， 
+// 块内二分查找不必先解压。每个块记录最小值与最大值，每 kBlocksPerGroup 个块再在稀疏的顶层索引中记一项， 
+// 查找依次定位到组、块、行；最后一个未满的块不压缩 
+// save 写出的镜像可以用 openMapped 只读映射，查询直接读取映射中的块；映射后再追加会先把数据复制到内存 
+class TimeIndex {
+public:
+    static const size_t kBlockRows = 4096;
+    static const size_t kBlocksPerGroup = 64;
+
+    TimeIndex();
+
+    // 早于最后一行时抛出异常，无序的数据先用 sortTimes 排序 
+    void append(PackedDateTime t);
+    void append(const DateTime& t);
+    // values 须为非降序且不早于最后一行，否则抛出异常且不追加任何行 
+    void append(const PackedDateTime* values, size_t n);
+
+    size_t size() const { return sealedRows() + tail_.size(); }
+    bool empty() const { return size() == 0; }
+    // 已压缩的块数，不含最后一个未满的块 
+    size_t blockCount() const;
+    // 压缩块、块目录、顶层索引与未满块合计占用的字节数 
+    size_t memoryBytes() const;
+    // 是否直接读取 openMapped 映射的文件 
+    bool mapped() const { return mapping_ != nullptr; }
+
+    // 第 row 行的时刻；越界时抛出异常 
+    PackedDateTime at(size_t row) const;
+    // 把 rows 中的各行依次解码到 out，out 至少可写 rows.size() 个元素；越界时抛出异常 
+    void read(RowRange rows, PackedDateTime* out) const;
+
+    // 第一个不早于 t 的行号，不存在时为 size() 
+    size_t lowerBound(PackedDateTime t) const;
+    size_t lowerBound(const DateTime& t) const { return lowerBound(PackedDateTime::fromDateTime(t)); }
+    // 时刻落在 [from, to) 的行；to 不晚于 from 时为空 
+    RowRange range(PackedDateTime from, PackedDateTime to) const;
+    RowRange range(const DateTime& from, const DateTime& to) const;
+
+    // 写出可映射的镜像（本机字节序，只能在同类平台上打开）：先写同目录的临时文件再改名替换，已有的映射不受影响；写入失败时抛出异常 
+    void save(const std::string& path) const;
+    // 文件不存在、不是索引镜像或内容越界时抛出异常 
+    static TimeIndex openMapped(const std::string& path);
+
+private:
+    struct Mapping;
+
+    size_t sealedRows() const { return blockCount() * kBlockRows; }
+    const detail::TimeIndexBlock* blocks() const;
+    const uint64_t* words() const;
+    const int64_t* groups() const;
+    size_t groupCount() const;
+    int64_t blockValue(const detail::TimeIndexBlock& block, size_t offset) const;
+    size_t blockLowerBound(const detail::TimeIndexBlock& block, int64_t t) const;
+    void seal();
+    void detach();
+
+    // 未映射时数据都在下面的 vector 中；映射后 blocks_、words_、groups_ 为空，改为读取 mapping_ 
+    std::vector<detail::TimeIndexBlock> blocks_;
+    std::vector<uint64_t> words_;   // 每块的打包数据后多留一个字，解码时可以无条件读取下一个字
+    std::vector<int64_t> groups_;   // 每组最后一块的最大值
+    std::vector<int64_t> tail_;     // 未满的块
+    std::shared_ptr<const Mapping> mapping_;
+};
+
+} // namespace datetime
+
+#ifdef DATETIME_HEADER_ONLY
+#include "datetime_index.cpp"
+#endif
+
+#endif // DATETIME_INDEX_H
@@ -0,0 +1,113 @@
+#ifndef DATETIME_TIMEZONE_H
+#define DATETIME_TIMEZONE_H
+
+#include "datetime.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace datetime {
+
+namespace detail {
+struct ZoneImageEntry;
+} // namespace detail
+
+// 某一时刻在时区中的本地时间信息 
+struct TimeZoneOffset {
+    int32_t utcOffset;         // 相对 UTC 的偏移（秒），东正西负
+    bool isDst;
+    const char* abbreviation;  // 如 "EST"；指向缩写驻留表，进程内一直有效
+};
+
+// IANA 时区：从 TZif 文件（RFC 8536，v1-v4）加载转换表与 POSIX TZ 规则 
+// 加载后数据不可变，复制只增加引用计数；查询为二分查找，可重入且不加锁 
+class TimeZone {
+public:
+    // 默认构造为 UTC 
+    TimeZone();
+
+    static TimeZone utc();
+    // 从 $TZDIR（未设置时为 /usr/share/zoneinfo）读取，如 "America/New_York"；找不到或格式错误时抛出异常 
+    static TimeZone load(const std::string& name);
+    static TimeZone load(const std::string& name, const std::string& directory);
+    // 从内存中的 TZif 数据构造，用于编译进程序的时区数据；data 只在调用期间被读取 
+    static TimeZone fromTzif(const std::string& name, const char* data, size_t length);
+
+    const std::string& name() const;
+    size_t transitionCount() const;
+
+    // 返回带逐日偏移表的副本：[fromUtcSeconds, toUtcSeconds) 内的查询为 O(1) 查表，表外回退到二分查找 
+    // 每天一项（8 字节），记录当天的转换时刻及其前后的本地时间类型 
+    TimeZone withOffsetCache(int64_t fromUtcSeconds, int64_t toUtcSeconds) const;
+    // 以当前时刻为中心，前后各 daysAroundNow 天 
+    TimeZone withOffsetCache(int daysAroundNow = 3 * 366) const;
+    // 命中情况在启用 DATETIME_ENABLE_STATS 时计入 stats() 的 zoneCacheHits / zoneCacheMisses 
+    bool hasOffsetCache() const;
+
+    // utcSeconds 为 Unix 秒数 
+    TimeZoneOffset lookup(int64_t utcSeconds) const;
+    int32_t utcOffset(int64_t utcSeconds) const;
+
+private:
+    friend class DateTime;
+    friend class TimeZoneDatabase;
+
+    // 本地时间类型；abbreviation 为驻留表下标 
+    struct LocalType {
+        int32_t utcOffset;
+        unsigned short abbreviation;
+        bool isDst;
+
+        bool operator==(const LocalType& other) const {
+            return utcOffset == other.utcOffset && abbreviation == other.abbreviation && isDst == other.isDst;
+        }
+        bool operator!=(const LocalType& other) const { return !(*this == other); }
+    };
+
+    struct Data;
+    struct OffsetCache;
+
+    explicit TimeZone(std::shared_ptr<const Data> data);
+    LocalType localType(int64_t utcSeconds) const;
+    LocalType searchLocalType(int64_t utcSeconds) const;
+
+    std::shared_ptr<const Data> data_;
+    std::shared_ptr<const OffsetCache> cache_;
+};
+
+// 预编译的时区库镜像：把多个 TZif 文件的内容编译成一个平坦的二进制文件（tools/datetime_zonedb） 
+// openMapped 以只读方式映射整个文件，各进程共享同一份物理页；打开时只校验文件头，不做任何解析 
+// load 在目录中二分查找，返回的 TimeZone 直接引用映射中的转换表，映射在最后一个引用释放后才解除 
+// 镜像使用本机字节序，只能在生成它的同类平台上使用 
+class TimeZoneDatabase {
+public:
+    // 文件不存在、不是时区镜像或字节序不符时抛出异常 
+    static TimeZoneDatabase openMapped(const std::string& path);
+    // 从 directory 读取 names 中的时区并写入 path；names 可以无序，写入时按名称排序 
+    // 先写同目录的临时文件再改名替换，已映射旧镜像的进程不受影响；写入失败时抛出异常且 path 保持原样 
+    static void compile(const std::string& directory, const std::vector<std::string>& names,
+                        const std::string& path);
+
+    size_t size() const;
+    std::string name(size_t index) const;
+    bool contains(const std::string& name) const;
+    // 找不到时抛出异常 
+    TimeZone load(const std::string& name) const;
+
+private:
+    struct Mapping;
+
+    explicit TimeZoneDatabase(std::shared_ptr<const Mapping> mapping);
+    const detail::ZoneImageEntry* findZone(const std::string& name) const;
+
+    std::shared_ptr<const Mapping> mapping_;
+};
+
+} // namespace datetime
+
+#ifdef DATETIME_HEADER_ONLY
+#include "datetime_timezone.cpp"
+#endif
+
+#endif // DATETIME_TIMEZONE_H
@@ -1,525 +1,1841 @@
 #include "datetime.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifdef DATETIME_ENABLE_STATS
+#include <vector>
+#if defined(DATETIME_STATS_CYCLES) && (defined(__x86_64__) || defined(__i386__)) && !defined(_MSC_VER)
+#include <x86intrin.h>
+#define DATETIME_STATS_RDTSC
+#elif defined(DATETIME_STATS_CYCLES) && defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define DATETIME_STATS_RDTSC
+#endif
+#endif
 
 namespace datetime {
 
-// DateTime 实现 
-DateTime::DateTime() : time_point_(std::chrono::system_clock::now()) {}
+#ifdef DATETIME_ENABLE_STATS
+namespace detail {
 
-DateTime::DateTime(int year, int month, int day, int hour, int minute, int second) {
-    if (month < 1 || month > 12) {
-        throw std::invalid_argument("Month must be between 1 and 12");
+enum StatCounter {
+    kLocaltimeCalls, kMktimeCalls, kParseCalls, kParseFailures, kFormatCalls, kZoneCacheHits, kZoneCacheMisses,
+    kStatCounters
+};
+enum StatTimer { kLocaltimeTimer, kMktimeTimer, kParseTimer, kFormatTimer, kStatTimers };
+
+// 所有统计量放在一个平坦数组中：先是各计数器，再依次是每个计时器的直方图桶与耗时总和 
+const int kStatHistogramSlots = CycleHistogram::kBuckets + 1;
+const int kStatSlots = kStatCounters + kStatTimers * kStatHistogramSlots;
+
+// 一个线程的统计量：只有所属线程写入，汇总时以 relaxed 读取，写入无需原子读改写 
+struct ThreadStats {
+    std::atomic<uint64_t> slots[kStatSlots];
+
+    ThreadStats();
+    ~ThreadStats();
+    ThreadStats(const ThreadStats&) = delete;
+    ThreadStats& operator=(const ThreadStats&) = delete;
+
+    void add(int slot, uint64_t n) {
+        slots[slot].store(slots[slot].load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
     }
+};
+
+// 存活线程的统计量；线程退出时计数并入 retired，baseline 为最近一次 resetStats() 时的总和 
+struct StatsRegistry {
+    std::mutex mutex;
+    std::vector<ThreadStats*> threads;
+    uint64_t retired[kStatSlots];
+    uint64_t baseline[kStatSlots];
+};
+
+// 有意不析构：其他线程的 thread_local 可能在静态对象析构之后才退出 
+DATETIME_INLINE StatsRegistry& statsRegistry() {
+    static StatsRegistry* registry = new StatsRegistry();
+    return *registry;
+}
 
-    // 检查日期是否在有效范围内 
-    int days_in_month[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
-    if (isLeapYear(year)) {
-        // 闰年，2月有29天 
-        days_in_month[1] = 29;
+DATETIME_INLINE ThreadStats::ThreadStats() {
+    for (std::atomic<uint64_t>& slot : slots) {
+        slot.store(0, std::memory_order_relaxed);
+    }
+    StatsRegistry& registry = statsRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.threads.push_back(this);
+}
+
+DATETIME_INLINE ThreadStats::~ThreadStats() {
+    StatsRegistry& registry = statsRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (int i = 0; i < kStatSlots; ++i) {
+        registry.retired[i] += slots[i].load(std::memory_order_relaxed);
+    }
+    registry.threads.erase(std::find(registry.threads.begin(), registry.threads.end(), this));
+}
+
+DATETIME_INLINE ThreadStats& threadStats() {
+    thread_local ThreadStats stats;
+    return stats;
+}
+
+// 调用方持有 registry.mutex 
+DATETIME_INLINE void sumStats(StatsRegistry& registry, uint64_t* totals) {
+    std::copy(registry.retired, registry.retired + kStatSlots, totals);
+    for (const ThreadStats* thread : registry.threads) {
+        for (int i = 0; i < kStatSlots; ++i) {
+            totals[i] += thread->slots[i].load(std::memory_order_relaxed);
+        }
+    }
+}
+
+DATETIME_INLINE void countStat(StatCounter counter, uint64_t n = 1) {
+    threadStats().add(counter, n);
+}
+
+DATETIME_INLINE void countZoneCacheLookup(bool hit) {
+    countStat(hit ? kZoneCacheHits : kZoneCacheMisses);
+}
+
+#ifdef DATETIME_STATS_CYCLES
+DATETIME_INLINE uint64_t readCycles() {
+#ifdef DATETIME_STATS_RDTSC
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// 作用域计时：析构时把耗时记入对应直方图，异常退出同样计入 
+class CycleScope {
+public:
+    explicit CycleScope(StatTimer timer) : timer_(timer), start_(readCycles()) {}
+    ~CycleScope() {
+        uint64_t elapsed = readCycles() - start_;
+        int bucket = 0;
+        while (bucket + 1 < CycleHistogram::kBuckets && (elapsed >> (bucket + 1)) != 0) {
+            ++bucket;
+        }
+        ThreadStats& stats = threadStats();
+        int base = kStatCounters + timer_ * kStatHistogramSlots;
+        stats.add(base + bucket, 1);
+        stats.add(base + CycleHistogram::kBuckets, elapsed);
+    }
+    CycleScope(const CycleScope&) = delete;
+    CycleScope& operator=(const CycleScope&) = delete;
+
+private:
+    StatTimer timer_;
+    uint64_t start_;
+};
+#endif
+
+} // namespace detail
+#endif
+
+// 插桩点：未启用统计时展开为空语句，参数不会被求值 
+#ifdef DATETIME_ENABLE_STATS
+#define DATETIME_STAT_ADD(counter, n) ::datetime::detail::countStat(::datetime::detail::counter, (n))
+#else
+#define DATETIME_STAT_ADD(counter, n) ((void)0)
+#endif
+#define DATETIME_STAT_COUNT(counter) DATETIME_STAT_ADD(counter, 1)
+#if defined(DATETIME_ENABLE_STATS) && defined(DATETIME_STATS_CYCLES)
+#define DATETIME_STAT_TIME(timer) ::datetime::detail::CycleScope datetimeStatScope(::datetime::detail::timer)
+#else
+#define DATETIME_STAT_TIME(timer) ((void)0)
+#endif
+
+namespace {
+
+// 将时间戳转换为本地时间，所有本地时间分解都经过这里 
+std::tm toLocalTm(time_t time) {
+    DATETIME_STAT_COUNT(kLocaltimeCalls);
+    DATETIME_STAT_TIME(kLocaltimeTimer);
+    std::tm tm{};
+#if defined(_MSC_VER) || defined(__MINGW32__)
+    // Windows 使用 localtime_s
+    if (localtime_s(&tm, &time) != 0) {
+        DATETIME_THROW("Failed to convert time to local time");
+    }
+#else
+    // Linux/macOS 使用 localtime_r
+    if (localtime_r(&time, &tm) == nullptr) {
+        DATETIME_THROW("Failed to convert time to local time");
+    }
+#endif
+
+    return tm;
+}
+
+DateTimeFields fieldsFromTm(const std::tm& tm) {
+    DateTimeFields fields;
+    fields.year = tm.tm_year + 1900;
+    fields.month = tm.tm_mon + 1;
+    fields.day = tm.tm_mday;
+    fields.hour = tm.tm_hour;
+    fields.minute = tm.tm_min;
+    fields.second = tm.tm_sec;
+    fields.weekday = tm.tm_wday;
+    fields.dayOfYear = tm.tm_yday + 1;
+    return fields;
+}
+
+// 向下取整的 Unix 秒数：纪元之前带小数秒的时刻属于前一秒，与 makeContext 一致 
+long long flooredSeconds(const std::chrono::system_clock::time_point& tp) {
+    long long total = std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+    return civil::detail::floorDiv(total, 1000000000LL);
+}
+
+// %Z 的输出：UTC 模式为 "UTC"，in() 得到的时刻为时区缩写，缩写未能登记时为空串 
+const char* zoneLabel(bool zoned, unsigned short zone) {
+    if (!zoned) {
+        return "UTC";
+    }
+    const char* abbreviation = detail::zoneAbbreviation(zone);
+    return abbreviation != nullptr ? abbreviation : "";
+}
+
+// UTC / 固定偏移模式下用 civil 算法构造 tm，不经过 gmtime_r 
+std::tm toUtcTm(time_t time, long offset, const char* zoneName) {
+    DateTimeFields fields = civil::fieldsFromSeconds(static_cast<long long>(time) + offset);
+
+    std::tm tm{};
+    tm.tm_year = fields.year - 1900;
+    tm.tm_mon = fields.month - 1;
+    tm.tm_mday = fields.day;
+    tm.tm_hour = fields.hour;
+    tm.tm_min = fields.minute;
+    tm.tm_sec = fields.second;
+    tm.tm_wday = fields.weekday;
+    tm.tm_yday = fields.dayOfYear - 1;
+    tm.tm_isdst = 0;
+#if defined(__GLIBC__) || defined(__APPLE__) || defined(__FreeBSD__)
+    tm.tm_gmtoff = offset;
+    tm.tm_zone = const_cast<char*>(zoneName);
+#else
+    (void)zoneName;
+#endif
+    return tm;
+}
+
+std::tm toTm(time_t time, bool utc, long offset, const char* zoneName) {
+    return utc ? toUtcTm(time, offset, zoneName) : toLocalTm(time);
+}
+
+// 本地墙上时间转时间戳，所有 mktime 调用都经过这里 
+time_t localMktime(std::tm& tm) {
+    DATETIME_STAT_COUNT(kMktimeCalls);
+    DATETIME_STAT_TIME(kMktimeTimer);
+    return std::mktime(&tm);
+}
+
+// tm 转回时间戳；与 mktime 一样允许字段越界并自动进位；civil 模式下 tm 为 UTC+offset 的墙上时间 
+time_t fromTm(std::tm& tm, bool utc, long offset = 0) {
+    if (!utc) {
+        tm.tm_isdst = -1;
+        return localMktime(tm);
+    }
+
+    long long months = static_cast<long long>(tm.tm_year + 1900) * 12 + tm.tm_mon;
+    long long year = civil::detail::floorDiv(months, 12);
+    int month = static_cast<int>(months - year * 12) + 1;
+    long long days = civil::daysFromCivil(static_cast<int>(year), month, 1) + tm.tm_mday - 1;
+    return static_cast<time_t>(days * 86400 + tm.tm_hour * 3600LL + tm.tm_min * 60LL + tm.tm_sec - offset);
+}
+
+// 按墙上时间取整：offset 为 UTC/固定偏移模式的偏移，本地模式由 localtime 求出当前偏移 
+std::chrono::system_clock::time_point roundTimePoint(const std::chrono::system_clock::time_point& tp, bool utc,
+                                                     long offset, TimeUnit unit, civil::Rounding mode) {
+    const long long kNanosPerSecond = 1000000000LL;
+    long long nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+    long long seconds = civil::detail::floorDiv(nanos, kNanosPerSecond);
+    long long offsetSeconds = offset;
+    if (!utc) {
+        std::tm tm = toLocalTm(static_cast<time_t>(seconds));
+        offsetSeconds = civil::secondsFromCivil(tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+                                                tm.tm_hour, tm.tm_min, tm.tm_sec) - seconds;
+    }
+
+    long long wall = nanos + offsetSeconds * kNanosPerSecond;
+    long long target = civil::roundTicks(wall, kNanosPerSecond, unit, mode);
+    if (!utc && unit >= TimeUnit::Day && target != wall) {
+        // 边界处的偏移可能与当前不同，按墙上时间交给 mktime 
+        DateTimeFields fields = civil::fieldsFromSeconds(civil::detail::floorDiv(target, kNanosPerSecond));
+        std::tm tm{};
+        tm.tm_year = fields.year - 1900;
+        tm.tm_mon = fields.month - 1;
+        tm.tm_mday = fields.day;
+        return std::chrono::system_clock::from_time_t(fromTm(tm, false));
+    }
+    return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+        std::chrono::nanoseconds(target - offsetSeconds * kNanosPerSecond)));
+}
+
+// 按墙上日期平移 months 个月所需的时间差；UTC/固定偏移模式为纯整数运算，本地模式由 mktime 解析新日期的偏移 
+std::chrono::system_clock::duration monthShift(const std::chrono::system_clock::time_point& tp, bool utc,
+                                               long offset, long long months, MonthOverflow overflow) {
+    long long nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+    long long seconds = civil::detail::floorDiv(nanos, 1000000000LL);
+    std::tm tm{};
+    long long days = 0;
+    if (utc) {
+        days = civil::detail::floorDiv(seconds + offset, 86400);
+    } else {
+        tm = toLocalTm(static_cast<time_t>(seconds));
+        days = civil::daysFromCivil(tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday);
+    }
+
+    bool overflowed = false;
+    long long shifted = civil::addMonthsToDays(days, months, overflow, overflowed);
+    if (overflowed && overflow == MonthOverflow::Throw) {
+        DATETIME_THROW("Day does not exist in the target month");
+    }
+    if (utc) {
+        return std::chrono::seconds((shifted - days) * 86400);
+    }
+
+    civil::CivilDate date = civil::civilFromDays(shifted);
+    tm.tm_year = date.year - 1900;
+    tm.tm_mon = date.month - 1;
+    tm.tm_mday = date.day;
+    return std::chrono::seconds(static_cast<long long>(fromTm(tm, false)) - seconds);
+}
+
+Status civilStatus(int year, int month, int day, int hour, int minute, int second) {
+    if (month < 1 || month > 12) {
+        return Status::InvalidMonth;
     }
 
-    if (day < 1 || day > days_in_month[month - 1]) {
-        throw std::invalid_argument("Invalid day for the given month");
+    // 检查日期是否在有效范围内 
+    if (day < 1 || day > daysInMonth(year, month)) {
+        return Status::InvalidDay;
     }
 
     // 检查小时、分钟、秒数范围 
     if (hour < 0 || hour >= 24) {
-        throw std::invalid_argument("Hour must be between 0 and 23");
+        return Status::InvalidHour;
     }
     if (minute < 0 || minute >= 60) {
-        throw std::invalid_argument("Minute must be between 0 and 59");
+        return Status::InvalidMinute;
     }
     if (second < 0 || second >= 60) {
-        throw std::invalid_argument("Second must be between 0 and 59");
+        return Status::InvalidSecond;
     }
+    return Status::Ok;
+}
 
-    std::tm tm = {};
-    tm.tm_year = year - 1900;
-    tm.tm_mon = month - 1;
-    tm.tm_mday = day;
-    tm.tm_hour = hour;
-    tm.tm_min = minute;
-    tm.tm_sec = second;
-    tm.tm_isdst = -1;
+// 解析失败时抛出的消息，字段错误注明来自字符串 
+const char* parseMessage(Status status) {
+    switch (status) {
+    case Status::InvalidMonth: return "Invalid month in date string";
+    case Status::InvalidDay: return "Invalid day for the given month";
+    case Status::InvalidHour: return "Invalid hour in date string";
+    case Status::InvalidMinute: return "Invalid minute in date string";
+    case Status::InvalidSecond: return "Invalid second in date string";
+    default: return statusMessage(status);
+    }
+}
+
+// 按格式解析，字段尚未检查，tm 尚未转换为时间戳 
+bool parseTm(const std::string& dateStr, const std::string& format, std::tm& tm) {
+    tm = std::tm{};
+    std::istringstream ss(dateStr);
+    ss >> std::get_time(&tm, format.c_str());
+    return !ss.fail();
+}
+
+const char kDigitPairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// 写入 6 位微秒数字（CachedNowFormatter 改写缓存结果中的 %f） 
+inline void writeMicroseconds(char* out, int value) {
+    std::memcpy(out, &kDigitPairs[(value / 10000) * 2], 2);
+    std::memcpy(out + 2, &kDigitPairs[(value / 100 % 100) * 2], 2);
+    std::memcpy(out + 4, &kDigitPairs[(value % 100) * 2], 2);
+}
+
+// 写入定长缓冲区，与 std::strftime 一样为结尾的'\0'预留一个字节 
+class BufferWriter {
+public:
+    BufferWriter(char* out, size_t capacity)
+        : begin_(out), pos_(out), end_(out + capacity), overflow_(capacity == 0) {}
+
+    void put(char c) {
+        if (end_ - pos_ > 1) {
+            *pos_++ = c;
+        } else {
+            overflow_ = true;
+        }
+    }
+
+    void append(const char* data, size_t length) {
+        if (static_cast<size_t>(end_ - pos_) > length) {
+            std::memcpy(pos_, data, length);
+            pos_ += length;
+        } else {
+            overflow_ = true;
+        }
+    }
+
+    // 两位数字，value 必须在 [0, 99] 内 
+    void putTwoDigits(int value) {
+        append(&kDigitPairs[value * 2], 2);
+    }
+
+    // 十进制整数，不足 width 位时用 pad 补齐 
+    void putNumber(long long value, int width, char pad) {
+        char digits[24];
+        int length = 0;
+        bool negative = value < 0;
+        unsigned long long magnitude = negative ? 0ULL - static_cast<unsigned long long>(value)
+                                                : static_cast<unsigned long long>(value);
+        do {
+            digits[length++] = static_cast<char>('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude != 0);
+
+        if (negative) {
+            put('-');
+        }
+        for (int i = length + (negative ? 1 : 0); i < width; ++i) {
+            put(pad);
+        }
+        while (length > 0) {
+            put(digits[--length]);
+        }
+    }
 
-    time_t time = std::mktime(&tm);
-    if (time == -1) {
-        throw std::invalid_argument("Invalid date/time");
+    void putYear(int year) {
+        if (year >= 1000 && year <= 9999) {
+            putTwoDigits(year / 100);
+            putTwoDigits(year % 100);
+        } else {
+            putNumber(year, 0, '0');
+        }
     }
-    time_point_ = std::chrono::system_clock::from_time_t(time);
+
+    size_t finish() {
+        if (overflow_) {
+            if (begin_ != end_) {
+                *begin_ = '\0';
+            }
+            return 0;
+        }
+        *pos_ = '\0';
+        return static_cast<size_t>(pos_ - begin_);
+    }
+
+private:
+    char* begin_;
+    char* pos_;
+    char* end_;
+    bool overflow_;
+};
+
+// 一次格式化所需的全部输入，每次调用只构造一次 
+struct FormatContext {
+    std::tm tm;
+    long nanoseconds;      // 秒内的纳秒部分 
+    long utcOffset;        // 相对 UTC 的偏移（秒） 
+    const char* zoneName;  // %Z 的输出；为空时交给 std::strftime（本地时间模式） 
+};
+
+FormatContext makeContext(const std::chrono::system_clock::time_point& tp, bool utc, long offset,
+                          const char* zoneName) {
+    long long total = std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+    long long seconds = civil::detail::floorDiv(total, 1000000000LL);
+
+    FormatContext ctx;
+    ctx.tm = toTm(static_cast<time_t>(seconds), utc, offset, zoneName);
+    ctx.zoneName = utc ? zoneName : nullptr;
+    ctx.nanoseconds = static_cast<long>(total - seconds * 1000000000LL);
+    ctx.utcOffset = static_cast<long>(civil::secondsFromCivil(ctx.tm.tm_year + 1900, ctx.tm.tm_mon + 1,
+                                                              ctx.tm.tm_mday, ctx.tm.tm_hour,
+                                                              ctx.tm.tm_min, ctx.tm.tm_sec) - seconds);
+    return ctx;
 }
 
-DateTime::DateTime(const std::chrono::system_clock::time_point& tp) : time_point_(tp) {}
+void writeOffset(BufferWriter& writer, long offset, bool colon) {
+    writer.put(offset < 0 ? '-' : '+');
+    long magnitude = offset < 0 ? -offset : offset;
+    writer.putTwoDigits(static_cast<int>(magnitude / 3600 % 100));
+    if (colon) {
+        writer.put(':');
+    }
+    writer.putTwoDigits(static_cast<int>(magnitude / 60 % 60));
+}
 
-DateTime::DateTime(time_t timestamp) : time_point_(std::chrono::system_clock::from_time_t(timestamp)) {}
+// 写出单个转换说明符。常用的数字说明符直接按 tm 写出，其余（星期/月份名称、
+// %c、%Z 等与 locale 相关的）逐个交给 std::strftime 处理 
+void writeConversion(BufferWriter& writer, char conversion, char modifier, const FormatContext& ctx) {
+    const std::tm& tm = ctx.tm;
+    int year = tm.tm_year + 1900;
+
+    if (modifier == 'E' || modifier == 'O') {
+        char spec[4] = { '%', modifier, conversion, '\0' };
+        char buffer[128];
+        size_t length = std::strftime(buffer, sizeof(buffer), spec, &tm);
+        writer.append(buffer, length);
+        return;
+    }
 
-DateTime DateTime::now() {
-    return { std::chrono::system_clock::now() };
+    switch (conversion) {
+    case 'Y': writer.putYear(year); break;
+    case 'm': writer.putTwoDigits(tm.tm_mon + 1); break;
+    case 'd': writer.putTwoDigits(tm.tm_mday); break;
+    case 'e': writer.putNumber(tm.tm_mday, 2, ' '); break;
+    case 'H': writer.putTwoDigits(tm.tm_hour); break;
+    case 'I': writer.putTwoDigits(tm.tm_hour % 12 == 0 ? 12 : tm.tm_hour % 12); break;
+    case 'M': writer.putTwoDigits(tm.tm_min); break;
+    case 'S': writer.putTwoDigits(tm.tm_sec); break;
+    case 'y': writer.putTwoDigits((year % 100 + 100) % 100); break;
+    case 'C': writer.putNumber(civil::detail::floorDiv(year, 100), 2, '0'); break;
+    case 'j': writer.putNumber(tm.tm_yday + 1, 3, '0'); break;
+    case 'u': writer.put(static_cast<char>('0' + (tm.tm_wday == 0 ? 7 : tm.tm_wday))); break;
+    case 'w': writer.put(static_cast<char>('0' + tm.tm_wday)); break;
+    case 'f': writer.putNumber(ctx.nanoseconds / 1000, 6, '0'); break;
+    case 'z': writeOffset(writer, ctx.utcOffset, modifier == ':'); break;
+    case 'Z':
+        if (ctx.zoneName == nullptr) {
+            char buffer[64];
+            size_t length = std::strftime(buffer, sizeof(buffer), "%Z", &tm);
+            writer.append(buffer, length);
+        } else {
+            writer.append(ctx.zoneName, std::strlen(ctx.zoneName));
+        }
+        break;
+    case 'n': writer.put('\n'); break;
+    case 't': writer.put('\t'); break;
+    case '%': writer.put('%'); break;
+    case 'F':
+        writer.putYear(year);
+        writer.put('-');
+        writer.putTwoDigits(tm.tm_mon + 1);
+        writer.put('-');
+        writer.putTwoDigits(tm.tm_mday);
+        break;
+    case 'T':
+        writer.putTwoDigits(tm.tm_hour);
+        writer.put(':');
+        writer.putTwoDigits(tm.tm_min);
+        writer.put(':');
+        writer.putTwoDigits(tm.tm_sec);
+        break;
+    case 'R':
+        writer.putTwoDigits(tm.tm_hour);
+        writer.put(':');
+        writer.putTwoDigits(tm.tm_min);
+        break;
+    default: {
+        char spec[3] = { '%', conversion, '\0' };
+        char buffer[128];
+        size_t length = std::strftime(buffer, sizeof(buffer), spec, &tm);
+        writer.append(buffer, length);
+        break;
+    }
+    }
 }
 
-DateTime DateTime::fromString(const std::string& dateStr, const std::string& format) {
-    std::tm tm = {};
-    std::istringstream ss(dateStr);
-    ss >> std::get_time(&tm, format.c_str());
+// 逐字符解释格式串 
+size_t formatWithPattern(char* out, size_t capacity, const char* format, const FormatContext& ctx) {
+    BufferWriter writer(out, capacity);
+
+    for (const char* p = format; *p != '\0'; ++p) {
+        if (*p != '%') {
+            writer.put(*p);
+            continue;
+        }
+        if (p[1] == '\0') {
+            writer.put('%');
+            break;
+        }
+        if ((p[1] == ':' && p[2] == 'z') || ((p[1] == 'E' || p[1] == 'O') && p[2] != '\0')) {
+            writeConversion(writer, p[2], p[1], ctx);
+            p += 2;
+            continue;
+        }
+        writeConversion(writer, *++p, '\0', ctx);
+    }
+
+    return writer.finish();
+}
 
-    if (ss.fail()) {
-        throw std::invalid_argument("Failed to parse date string");
+// 定长布局："YYYY-MM-DD?HH:MM:SS"，out 至少 20 字节，年份必须在 [0, 9999] 内 
+size_t formatIsoTm(char* out, const std::tm& tm, char separator) {
+    int year = tm.tm_year + 1900;
+    std::memcpy(out, &kDigitPairs[(year / 100) * 2], 2);
+    std::memcpy(out + 2, &kDigitPairs[(year % 100) * 2], 2);
+    out[4] = '-';
+    std::memcpy(out + 5, &kDigitPairs[(tm.tm_mon + 1) * 2], 2);
+    out[7] = '-';
+    std::memcpy(out + 8, &kDigitPairs[tm.tm_mday * 2], 2);
+    out[10] = separator;
+    std::memcpy(out + 11, &kDigitPairs[tm.tm_hour * 2], 2);
+    out[13] = ':';
+    std::memcpy(out + 14, &kDigitPairs[tm.tm_min * 2], 2);
+    out[16] = ':';
+    std::memcpy(out + 17, &kDigitPairs[tm.tm_sec * 2], 2);
+    out[19] = '\0';
+    return 19;
+}
+
+size_t formatWithSpec(char* out, size_t capacity, const FormatSpec& spec, const FormatContext& ctx) {
+    if (!spec.compiled()) {
+        return formatWithPattern(out, capacity, spec.pattern().c_str(), ctx);
     }
 
-    // 手动检查日期的有效性 
-    if (tm.tm_mon < 0 || tm.tm_mon > 11) {
-        throw std::invalid_argument("Invalid month in date string");
+    int year = ctx.tm.tm_year + 1900;
+    bool fixedYear = year >= 0 && year <= 9999;
+    switch (spec.layout()) {
+    case FormatSpec::DateTimeLayout:
+        if (fixedYear && capacity >= 20) {
+            return formatIsoTm(out, ctx.tm, ' ');
+        }
+        break;
+    case FormatSpec::Iso8601:
+        if (fixedYear && capacity >= 20) {
+            return formatIsoTm(out, ctx.tm, 'T');
+        }
+        break;
+    case FormatSpec::Rfc3339:
+        if (fixedYear && capacity >= 26) {
+            formatIsoTm(out, ctx.tm, 'T');
+            BufferWriter writer(out + 19, capacity - 19);
+            writeOffset(writer, ctx.utcOffset, true);
+            return 19 + writer.finish();
+        }
+        break;
+    case FormatSpec::Generic:
+        break;
+    }
+
+    BufferWriter writer(out, capacity);
+    for (size_t i = 0; i < spec.size(); ++i) {
+        const FormatSpec::Op& op = spec[i];
+        if (op.conversion == '\0') {
+            writer.put(op.value);
+        } else {
+            writeConversion(writer, op.conversion, op.value, ctx);
+        }
+    }
+    return writer.finish();
+}
+
+// 解析得到的原始字段，尚未做范围检查 
+struct ParsedFields {
+    int year;
+    int month;
+    int day;
+    int hour;
+    int minute;
+    int second;
+    long nanoseconds;
+    bool hasOffset;
+    long utcOffset;
+};
+
+bool isDigit(char c) {
+    return static_cast<unsigned>(c - '0') <= 9;
+}
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+// 读取 [minDigits, maxDigits] 位十进制数 
+bool parseNumber(const char*& p, const char* end, int minDigits, int maxDigits, int& value) {
+    int digits = 0;
+    value = 0;
+    while (p != end && digits < maxDigits && isDigit(*p)) {
+        value = value * 10 + (*p++ - '0');
+        ++digits;
     }
+    return digits >= minDigits;
+}
 
-    int days_in_month[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
-    if (isLeapYear(tm.tm_year)) {
-        // 闰年，2月29天 
-        days_in_month[1] = 29;
+// 读取定长两位数字 
+int twoDigits(const char* p) {
+    return (p[0] - '0') * 10 + (p[1] - '0');
+}
+
+// 秒的小数部分，最多取 9 位，多余的位被忽略 
+bool parseFraction(const char*& p, const char* end, long& nanoseconds) {
+    long value = 0;
+    int digits = 0;
+    while (p != end && isDigit(*p)) {
+        if (digits < 9) {
+            value = value * 10 + (*p - '0');
+            ++digits;
+        }
+        ++p;
+    }
+    if (digits == 0) {
+        return false;
+    }
+    for (int i = digits; i < 9; ++i) {
+        value *= 10;
     }
+    nanoseconds = value;
+    return true;
+}
 
-    if (tm.tm_mday < 1 || tm.tm_mday > days_in_month[tm.tm_mon]) {
-        throw std::invalid_argument("Invalid day for the given month");
+// "Z" 或 ±hh[[:]mm] 
+bool parseOffset(const char*& p, const char* end, long& offset) {
+    if (p != end && (*p == 'Z' || *p == 'z')) {
+        ++p;
+        offset = 0;
+        return true;
+    }
+    if (end - p < 3 || (*p != '+' && *p != '-') || !isDigit(p[1]) || !isDigit(p[2])) {
+        return false;
+    }
+    bool negative = *p == '-';
+    int hours = twoDigits(p + 1);
+    int minutes = 0;
+    p += 3;
+    if (p != end && *p == ':') {
+        if (end - p < 3 || !isDigit(p[1]) || !isDigit(p[2])) {
+            return false;
+        }
+        minutes = twoDigits(p + 1);
+        p += 3;
+    } else if (end - p >= 2 && isDigit(p[0]) && isDigit(p[1])) {
+        minutes = twoDigits(p);
+        p += 2;
     }
+    if (hours > 23 || minutes > 59) {
+        return false;
+    }
+    offset = (negative ? -1 : 1) * (hours * 3600L + minutes * 60L);
+    return true;
+}
 
-    // 检查小时、分钟、秒数 
-    if (tm.tm_hour < 0 || tm.tm_hour > 23) {
-        throw std::invalid_argument("Invalid hour in date string");
+// 定长布局的快速路径：所有数字位置固定，不逐个解释操作 
+bool parseFixedLayout(const char* p, const char* end, const FormatSpec& spec, ParsedFields& out) {
+    static const int kDigitPositions[] = { 0, 1, 2, 3, 5, 6, 8, 9, 11, 12, 14, 15, 17, 18 };
+    if (end - p < 19) {
+        return false;
     }
-    if (tm.tm_min < 0 || tm.tm_min > 59) {
-        throw std::invalid_argument("Invalid minute in date string");
+    for (int position : kDigitPositions) {
+        if (!isDigit(p[position])) {
+            return false;
+        }
     }
-    if (tm.tm_sec < 0 || tm.tm_sec > 59) {
-        throw std::invalid_argument("Invalid second in date string");
+    char separator = spec.layout() == FormatSpec::DateTimeLayout ? ' ' : 'T';
+    if (p[4] != '-' || p[7] != '-' || p[10] != separator || p[13] != ':' || p[16] != ':') {
+        return false;
     }
 
-    tm.tm_isdst = -1;
-    time_t time = std::mktime(&tm);
-    if (time == -1) {
-        throw std::invalid_argument("Invalid date/time");
+    out.year = twoDigits(p) * 100 + twoDigits(p + 2);
+    out.month = twoDigits(p + 5);
+    out.day = twoDigits(p + 8);
+    out.hour = twoDigits(p + 11);
+    out.minute = twoDigits(p + 14);
+    out.second = twoDigits(p + 17);
+
+    if (spec.layout() == FormatSpec::Rfc3339) {
+        p += 19;
+        if (p != end && *p == '.') {
+            ++p;
+            if (!parseFraction(p, end, out.nanoseconds)) {
+                return false;
+            }
+        }
+        if (!parseOffset(p, end, out.utcOffset)) {
+            return false;
+        }
+        out.hasOffset = true;
+    }
+    return true;
+}
+
+// 按操作序列解析；与 std::get_time 一样，格式中的空白匹配任意多个空白，输入末尾多余的字符被忽略 
+bool parseWithSpec(const char* p, const char* end, const FormatSpec& spec, ParsedFields& out) {
+    out.year = 1900;
+    out.month = 1;
+    out.day = 0;
+    out.hour = 0;
+    out.minute = 0;
+    out.second = 0;
+    out.nanoseconds = 0;
+    out.hasOffset = false;
+    out.utcOffset = 0;
+
+    if (spec.layout() != FormatSpec::Generic && parseFixedLayout(p, end, spec, out)) {
+        return true;
     }
 
-    return { std::chrono::system_clock::from_time_t(time) };
+    for (size_t i = 0; i < spec.size(); ++i) {
+        const FormatSpec::Op& op = spec[i];
+        char c = op.conversion == '\0' ? op.value : '\0';
+        if (c != '\0' || op.conversion == 'n' || op.conversion == 't') {
+            if (c == '\0' || isSpace(c)) {
+                while (p != end && isSpace(*p)) {
+                    ++p;
+                }
+            } else if (p == end || *p++ != c) {
+                return false;
+            }
+            continue;
+        }
+
+        bool ok = true;
+        switch (op.conversion) {
+        case 'Y': ok = parseNumber(p, end, 1, 4, out.year); break;
+        case 'm': ok = parseNumber(p, end, 1, 2, out.month); break;
+        case 'd': ok = parseNumber(p, end, 1, 2, out.day); break;
+        case 'e':
+            if (p != end && *p == ' ') {
+                ++p;
+            }
+            ok = parseNumber(p, end, 1, 2, out.day);
+            break;
+        case 'H': ok = parseNumber(p, end, 1, 2, out.hour); break;
+        case 'M': ok = parseNumber(p, end, 1, 2, out.minute); break;
+        case 'S': ok = parseNumber(p, end, 1, 2, out.second); break;
+        case 'y':
+            ok = parseNumber(p, end, 2, 2, out.year);
+            out.year += out.year < 69 ? 2000 : 1900;
+            break;
+        case 'f': ok = parseFraction(p, end, out.nanoseconds); break;
+        case 'z':
+            ok = parseOffset(p, end, out.utcOffset);
+            out.hasOffset = true;
+            break;
+        case '%': ok = p != end && *p++ == '%'; break;
+        default: ok = false; break;
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
 }
 
-DateTime DateTime::fromTimestamp(time_t timestamp) {
-    return { timestamp };
+Status parsedStatus(const ParsedFields& fields) {
+    return civilStatus(fields.year, fields.month, fields.day, fields.hour, fields.minute, fields.second);
 }
 
-int DateTime::year() const {
-    time_t time = std::chrono::system_clock::to_time_t(time_point_);
+// 时间戳能否用 system_clock::time_point 表示（libstdc++ 上约为 1678-2262 年） 
+bool fitsTimePoint(long long seconds) {
+    typedef std::chrono::duration<long long> LongSeconds;
+    long long limit = std::chrono::duration_cast<LongSeconds>(std::chrono::system_clock::duration::max()).count();
+    return seconds > -limit && seconds < limit;
+}
 
-    std::tm tm{};
-#if defined(_MSC_VER) || defined(__MINGW32__)
-    // Windows 使用 localtime_s
-    if (localtime_s(&tm, &time) != 0) {
-        throw std::invalid_argument("Failed to convert time to local time");
+// ISO 8601 扫描：所有字段都在固定偏移处读取，整个输入必须被完全消费 
+bool scanIso8601(const char* p, const char* end, ParsedFields& out) {
+    out.hour = 0;
+    out.minute = 0;
+    out.second = 0;
+    out.nanoseconds = 0;
+    out.hasOffset = false;
+    out.utcOffset = 0;
+
+    if (end - p < 10 || !isDigit(p[0]) || !isDigit(p[1]) || !isDigit(p[2]) || !isDigit(p[3]) ||
+        p[4] != '-' || !isDigit(p[5]) || !isDigit(p[6]) || p[7] != '-' || !isDigit(p[8]) || !isDigit(p[9])) {
+        return false;
     }
-#else
-    // Linux/macOS 使用 localtime_r
-    if (localtime_r(&time, &tm) == nullptr) {
-        throw std::invalid_argument("Failed to convert time to local time");
+    out.year = twoDigits(p) * 100 + twoDigits(p + 2);
+    out.month = twoDigits(p + 5);
+    out.day = twoDigits(p + 8);
+    p += 10;
+    if (p == end) {
+        return true;
     }
-#endif
 
-    return tm.tm_year + 1900;
+    if ((*p != 'T' && *p != 't' && *p != ' ') || end - p < 6 ||
+        !isDigit(p[1]) || !isDigit(p[2]) || p[3] != ':' || !isDigit(p[4]) || !isDigit(p[5])) {
+        return false;
+    }
+    out.hour = twoDigits(p + 1);
+    out.minute = twoDigits(p + 4);
+    p += 6;
+
+    if (p != end && *p == ':') {
+        if (end - p < 3 || !isDigit(p[1]) || !isDigit(p[2])) {
+            return false;
+        }
+        out.second = twoDigits(p + 1);
+        p += 3;
+        if (p != end && (*p == '.' || *p == ',')) {
+            ++p;
+            if (!parseFraction(p, end, out.nanoseconds)) {
+                return false;
+            }
+        }
+    }
+
+    if (p != end) {
+        if (!parseOffset(p, end, out.utcOffset)) {
+            return false;
+        }
+        out.hasOffset = true;
+    }
+    return p == end;
 }
 
-int DateTime::month() const {
-    time_t time = std::chrono::system_clock::to_time_t(time_point_);
+bool parseIso8601Uncounted(const char* str, size_t length, bool utc, DateTime& out) {
+    ParsedFields fields;
+    if (str == nullptr || !scanIso8601(str, str + length, fields) ||
+        parsedStatus(fields) != Status::Ok) {
+        return false;
+    }
 
-    std::tm tm{};
-#if defined(_MSC_VER) || defined(__MINGW32__)
-    // Windows 使用 localtime_s
-    if (localtime_s(&tm, &time) != 0) {
-        throw std::invalid_argument("Failed to convert time to local time");
+    long long seconds = 0;
+    if (utc || fields.hasOffset) {
+        seconds = civil::secondsFromCivil(fields.year, fields.month, fields.day, fields.hour,
+                                          fields.minute, fields.second) - fields.utcOffset;
+    } else {
+        std::tm tm = {};
+        tm.tm_year = fields.year - 1900;
+        tm.tm_mon = fields.month - 1;
+        tm.tm_mday = fields.day;
+        tm.tm_hour = fields.hour;
+        tm.tm_min = fields.minute;
+        tm.tm_sec = fields.second;
+        seconds = fromTm(tm, false);
+        if (seconds == -1 && (tm.tm_year != 69 || tm.tm_mon != 11 || tm.tm_mday != 31)) {
+            return false;
+        }
     }
-#else
-    // Linux/macOS 使用 localtime_r
-    if (localtime_r(&time, &tm) == nullptr) {
-        throw std::invalid_argument("Failed to convert time to local time");
+    if (!fitsTimePoint(seconds)) {
+        return false;
     }
-#endif
 
-    return tm.tm_mon + 1;
+    DateTime result(std::chrono::system_clock::from_time_t(static_cast<time_t>(seconds)) +
+                    std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                        std::chrono::nanoseconds(fields.nanoseconds)));
+    out = utc ? result.toUtc() : result;
+    return true;
 }
 
-int DateTime::day() const {
-    time_t time = std::chrono::system_clock::to_time_t(time_point_);
+bool parseIso8601Impl(const char* str, size_t length, bool utc, DateTime& out) {
+    DATETIME_STAT_TIME(kParseTimer);
+    bool ok = parseIso8601Uncounted(str, length, utc, out);
+    DATETIME_STAT_COUNT(kParseCalls);
+    DATETIME_STAT_ADD(kParseFailures, ok ? 0 : 1);
+    return ok;
+}
 
-    std::tm tm{};
-#if defined(_MSC_VER) || defined(__MINGW32__)
-    // Windows 使用 localtime_s
-    if (localtime_s(&tm, &time) != 0) {
-        throw std::invalid_argument("Failed to convert time to local time");
+// 带偏移的字符串直接得到绝对时刻；否则按 utc 选择 civil 算法或 mktime；失败时不修改 out 
+Status parseDateTimeUncounted(const std::string& dateStr, const FormatSpec& spec, bool utc, DateTime& out) {
+    ParsedFields fields;
+    if (!spec.parsable()) {
+        std::tm tm;
+        if (!parseTm(dateStr, spec.pattern(), tm)) {
+            return Status::ParseError;
+        }
+        fields = ParsedFields{ tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour,
+                               tm.tm_min, tm.tm_sec, 0, false, 0 };
+    } else if (!parseWithSpec(dateStr.data(), dateStr.data() + dateStr.size(), spec, fields)) {
+        return Status::ParseError;
     }
-#else
-    // Linux/macOS 使用 localtime_r
-    if (localtime_r(&time, &tm) == nullptr) {
-        throw std::invalid_argument("Failed to convert time to local time");
+    Status status = parsedStatus(fields);
+    if (status != Status::Ok) {
+        return status;
+    }
+
+    long long seconds = 0;
+    if (utc || fields.hasOffset) {
+        seconds = civil::secondsFromCivil(fields.year, fields.month, fields.day, fields.hour,
+                                          fields.minute, fields.second) - fields.utcOffset;
+    } else {
+        std::tm tm = {};
+        tm.tm_year = fields.year - 1900;
+        tm.tm_mon = fields.month - 1;
+        tm.tm_mday = fields.day;
+        tm.tm_hour = fields.hour;
+        tm.tm_min = fields.minute;
+        tm.tm_sec = fields.second;
+        seconds = fromTm(tm, false);
+        if (seconds == -1) {
+            return Status::OutOfRange;
+        }
+    }
+    if (!fitsTimePoint(seconds)) {
+        return Status::OutOfRange;
     }
-#endif
 
-    return tm.tm_mday;
+    DateTime result(std::chrono::system_clock::from_time_t(static_cast<time_t>(seconds)) +
+                    std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                        std::chrono::nanoseconds(fields.nanoseconds)));
+    out = utc ? result.toUtc() : result;
+    return Status::Ok;
 }
 
-int DateTime::hour() const {
-    time_t time = std::chrono::system_clock::to_time_t(time_point_);
+// fromString / tryParse 的共同入口 
+Status parseDateTime(const std::string& dateStr, const FormatSpec& spec, bool utc, DateTime& out) {
+    DATETIME_STAT_TIME(kParseTimer);
+    Status status = parseDateTimeUncounted(dateStr, spec, utc, out);
+    DATETIME_STAT_COUNT(kParseCalls);
+    DATETIME_STAT_ADD(kParseFailures, status == Status::Ok ? 0 : 1);
+    return status;
+}
 
-    std::tm tm{};
-#if defined(_MSC_VER) || defined(__MINGW32__)
-    // Windows 使用 localtime_s
-    if (localtime_s(&tm, &time) != 0) {
-        throw std::invalid_argument("Failed to convert time to local time");
+DateTime parseOrThrow(const std::string& dateStr, const FormatSpec& spec, bool utc) {
+    DateTime result{ std::chrono::system_clock::time_point() };
+    Status status = parseDateTime(dateStr, spec, utc, result);
+    if (status != Status::Ok) {
+        DATETIME_THROW(parseMessage(status));
     }
-#else
-    // Linux/macOS 使用 localtime_r
-    if (localtime_r(&time, &tm) == nullptr) {
-        throw std::invalid_argument("Failed to convert time to local time");
+    return result;
+}
+
+// 本地时间构造：tm 由 mktime 规范化，可直接作为字段缓存 
+Status makeLocal(int year, int month, int day, int hour, int minute, int second, std::tm& tm,
+                 std::chrono::system_clock::time_point& out) {
+    Status status = civilStatus(year, month, day, hour, minute, second);
+    if (status != Status::Ok) {
+        return status;
     }
-#endif
 
-    return tm.tm_hour;
-}
+    tm = std::tm{};
+    tm.tm_year = year - 1900;
+    tm.tm_mon = month - 1;
+    tm.tm_mday = day;
+    tm.tm_hour = hour;
+    tm.tm_min = minute;
+    tm.tm_sec = second;
+    tm.tm_isdst = -1;
 
-int DateTime::minute() const {
-    time_t time = std::chrono::system_clock::to_time_t(time_point_);
+    time_t time = localMktime(tm);
+    if (time == -1 || !fitsTimePoint(time)) {
+        return Status::OutOfRange;
+    }
+    out = std::chrono::system_clock::from_time_t(time);
+    return Status::Ok;
+}
 
-    std::tm tm{};
-#if defined(_MSC_VER) || defined(__MINGW32__)
-    // Windows 使用 localtime_s
-    if (localtime_s(&tm, &time) != 0) {
-        throw std::invalid_argument("Failed to convert time to local time");
+Status makeUtc(int year, int month, int day, int hour, int minute, int second, DateTime& out) {
+    Status status = civilStatus(year, month, day, hour, minute, second);
+    if (status != Status::Ok) {
+        return status;
     }
-#else
-    // Linux/macOS 使用 localtime_r
-    if (localtime_r(&time, &tm) == nullptr) {
-        throw std::invalid_argument("Failed to convert time to local time");
+    long long seconds = civil::secondsFromCivil(year, month, day, hour, minute, second);
+    if (!fitsTimePoint(seconds)) {
+        return Status::OutOfRange;
     }
+    out = DateTime(static_cast<time_t>(seconds)).toUtc();
+    return Status::Ok;
+}
+
+const char kDefaultPattern[] = "%Y-%m-%d %H:%M:%S";
+
+const FormatSpec& defaultSpec() {
+    static const FormatSpec spec(kDefaultPattern);
+    return spec;
+}
+
+} // namespace
+
+namespace detail {
+
+DATETIME_INLINE void failFast(const char* message) {
+    std::fprintf(stderr, "datetime: %s\n", message);
+    std::abort();
+}
+
+DATETIME_INLINE void failFast(const std::string& message) {
+    failFast(message.c_str());
+}
+
+DATETIME_INLINE std::string temporaryPath(const std::string& path) {
+#ifdef _WIN32
+    unsigned long process = GetCurrentProcessId();
+#else
+    long process = static_cast<long>(getpid());
 #endif
+    size_t thread = std::hash<std::thread::id>()(std::this_thread::get_id());
+    return path + ".tmp." + std::to_string(process) + "." + std::to_string(thread);
+}
 
-    return tm.tm_min;
+DATETIME_INLINE bool replaceFile(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
 }
 
-int DateTime::second() const {
-    time_t time = std::chrono::system_clock::to_time_t(time_point_);
+DATETIME_INLINE bool writeFileReplacing(const std::string& path, const char* data, size_t size) {
+    std::string temporary = temporaryPath(path);
+    bool written;
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(data, static_cast<std::streamsize>(size));
+        // 关闭时才会冲刷缓冲区，磁盘写满等错误要在 close 之后检查 
+        file.close();
+        written = !file.fail();
+    }
+    if (!written || !replaceFile(temporary, path)) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
 
-    std::tm tm{};
-#if defined(_MSC_VER) || defined(__MINGW32__)
-    // Windows 使用 localtime_s
-    if (localtime_s(&tm, &time) != 0) {
-        throw std::invalid_argument("Failed to convert time to local time");
+const size_t kMaxZoneAbbreviations = 1024;
+const size_t kZoneAbbreviationSize = 8;
+
+// 仅头文件模式下各翻译单元必须共享同一张表，因此不放在匿名命名空间中 
+// 写入方持锁追加，发布时以 release 递增 size；读取方以 acquire 读 size 后直接访问已发布的槽位 
+struct ZoneAbbreviationPool {
+    std::mutex mutex;
+    std::atomic<unsigned> size;
+    char names[kMaxZoneAbbreviations][kZoneAbbreviationSize];
+};
+
+DATETIME_INLINE ZoneAbbreviationPool& zoneAbbreviationPool() {
+    static ZoneAbbreviationPool pool;
+    return pool;
+}
+
+DATETIME_INLINE unsigned short internZoneAbbreviation(const char* abbreviation, size_t length) {
+    if (length == 0 || length >= kZoneAbbreviationSize) {
+        return 0;
     }
-#else
-    // Linux/macOS 使用 localtime_r
-    if (localtime_r(&time, &tm) == nullptr) {
-        throw std::invalid_argument("Failed to convert time to local time");
+    ZoneAbbreviationPool& pool = zoneAbbreviationPool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    unsigned size = pool.size.load(std::memory_order_relaxed);
+    for (unsigned i = 0; i < size; ++i) {
+        if (std::strncmp(pool.names[i], abbreviation, length) == 0 && pool.names[i][length] == '\0') {
+            return static_cast<unsigned short>(i + 1);
+        }
     }
-#endif
+    if (size == kMaxZoneAbbreviations) {
+        return 0;
+    }
+    std::memcpy(pool.names[size], abbreviation, length);
+    pool.names[size][length] = '\0';
+    pool.size.store(size + 1, std::memory_order_release);
+    return static_cast<unsigned short>(size + 1);
+}
 
-    return tm.tm_sec;
+DATETIME_INLINE const char* zoneAbbreviation(unsigned short id) {
+    ZoneAbbreviationPool& pool = zoneAbbreviationPool();
+    if (id == 0 || id > pool.size.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    return pool.names[id - 1];
 }
 
-int DateTime::weekday() const {
-    time_t time = std::chrono::system_clock::to_time_t(time_point_);
+} // namespace detail
 
-    std::tm tm{};
-#if defined(_MSC_VER) || defined(__MINGW32__)
-    // Windows 使用 localtime_s
-    if (localtime_s(&tm, &time) != 0) {
-        throw std::invalid_argument("Failed to convert time to local time");
+namespace detail {
+
+// CoarseClock 的后台刷新线程；与驻留表一样在仅头文件模式下必须全进程唯一 
+// control 串行化启动与停止，mutex/wake 只用于让线程按间隔休眠并能被及时唤醒 
+struct CoarseTicker {
+    std::mutex control;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::thread thread;
+    bool stopping = false;
+    std::atomic<bool> running;
+    std::atomic<std::chrono::system_clock::rep> ticks;
+    std::atomic<long long> interval;
+
+    CoarseTicker() : running(false), ticks(0), interval(0) {}
+
+    // 进程退出时静态对象析构，先停止线程，避免 std::thread 以可 join 状态析构 
+    ~CoarseTicker() { stop(); }
+
+    void publish() {
+        ticks.store(std::chrono::system_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
     }
-#else
-    // Linux/macOS 使用 localtime_r
-    if (localtime_r(&time, &tm) == nullptr) {
-        throw std::invalid_argument("Failed to convert time to local time");
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            publish();
+            wake.wait_for(lock, std::chrono::nanoseconds(interval.load(std::memory_order_relaxed)));
+        }
+    }
+
+    void start(std::chrono::nanoseconds period) {
+        std::lock_guard<std::mutex> guard(control);
+        interval.store(period.count(), std::memory_order_relaxed);
+        if (thread.joinable()) {
+            wake.notify_one();
+            return;
+        }
+        stopping = false;
+        // 先发布一次，读取方看到 running 时一定有有效的时间戳 
+        publish();
+        thread = std::thread(&CoarseTicker::run, this);
+        running.store(true, std::memory_order_release);
     }
-#endif
 
-    return tm.tm_wday;
+    void stop() {
+        std::lock_guard<std::mutex> guard(control);
+        if (!thread.joinable()) {
+            return;
+        }
+        running.store(false, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        thread.join();
+    }
+};
+
+DATETIME_INLINE CoarseTicker& coarseTicker() {
+    static CoarseTicker ticker;
+    return ticker;
 }
 
-int DateTime::dayOfYear() const {
-    time_t time = std::chrono::system_clock::to_time_t(time_point_);
+} // namespace detail
 
-    std::tm tm{};
-#if defined(_MSC_VER) || defined(__MINGW32__)
-    // Windows 使用 localtime_s
-    if (localtime_s(&tm, &time) != 0) {
-        throw std::invalid_argument("Failed to convert time to local time");
+DATETIME_INLINE CoarseClock::time_point CoarseClock::now() noexcept {
+    detail::CoarseTicker& ticker = detail::coarseTicker();
+    if (ticker.running.load(std::memory_order_acquire)) {
+        return time_point(duration(ticker.ticks.load(std::memory_order_relaxed)));
     }
-#else
-    // Linux/macOS 使用 localtime_r
-    if (localtime_r(&time, &tm) == nullptr) {
-        throw std::invalid_argument("Failed to convert time to local time");
+#ifdef CLOCK_REALTIME_COARSE
+    timespec ts;
+    if (clock_gettime(CLOCK_REALTIME_COARSE, &ts) == 0) {
+        return time_point(std::chrono::duration_cast<duration>(std::chrono::seconds(ts.tv_sec) +
+                                                               std::chrono::nanoseconds(ts.tv_nsec)));
     }
 #endif
-
-    return tm.tm_yday + 1;
+    return std::chrono::system_clock::now();
 }
 
-std::string DateTime::toString(const std::string& format) const {
-    return strftime(format);
+DATETIME_INLINE void CoarseClock::startTicker(std::chrono::nanoseconds interval) {
+    if (interval.count() <= 0) {
+        DATETIME_THROW("CoarseClock ticker interval must be positive");
+    }
+    detail::coarseTicker().start(interval);
 }
 
-std::string DateTime::isoformat() const {
-    return strftime("%Y-%m-%dT%H:%M:%S");
+DATETIME_INLINE void CoarseClock::stopTicker() {
+    detail::coarseTicker().stop();
 }
 
-std::string DateTime::strftime(const std::string& format) const {
-    time_t time = std::chrono::system_clock::to_time_t(time_point_);
+DATETIME_INLINE bool CoarseClock::tickerRunning() {
+    return detail::coarseTicker().running.load(std::memory_order_acquire);
+}
 
-    std::tm tm{};
-#if defined(_MSC_VER) || defined(__MINGW32__)
-    // Windows 使用 localtime_s
-    if (localtime_s(&tm, &time) != 0) {
-        throw std::invalid_argument("Failed to convert time to local time");
+DATETIME_INLINE std::chrono::nanoseconds CoarseClock::resolution() {
+    detail::CoarseTicker& ticker = detail::coarseTicker();
+    if (ticker.running.load(std::memory_order_acquire)) {
+        return std::chrono::nanoseconds(ticker.interval.load(std::memory_order_relaxed));
     }
-#else
-    // Linux/macOS 使用 localtime_r
-    if (localtime_r(&time, &tm) == nullptr) {
-        throw std::invalid_argument("Failed to convert time to local time");
+#ifdef CLOCK_REALTIME_COARSE
+    timespec ts;
+    if (clock_getres(CLOCK_REALTIME_COARSE, &ts) == 0) {
+        return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
     }
 #endif
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration(1));
+}
 
-    char buffer[256]{};
-    std::strftime(buffer, sizeof(buffer), format.c_str(), &tm);
-    return { buffer };
+// FormatSpec 实现 
+DATETIME_INLINE FormatSpec::FormatSpec(const char* pattern) : pattern_(pattern) {
+    compile();
 }
 
-time_t DateTime::timestamp() const {
-    return std::chrono::system_clock::to_time_t(time_point_);
+DATETIME_INLINE FormatSpec::FormatSpec(const std::string& pattern) : pattern_(pattern) {
+    compile();
 }
 
-long long DateTime::milliseconds() const {
-    auto duration = time_point_.time_since_epoch();
-    return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+DATETIME_INLINE const FormatSpec& FormatSpec::iso8601() {
+    static const FormatSpec spec("%Y-%m-%dT%H:%M:%S");
+    return spec;
 }
 
-DateTime DateTime::addYears(int years) const {
-    std::tm tm = {};
-    time_t time = std::chrono::system_clock::to_time_t(time_point_);
+DATETIME_INLINE const FormatSpec& FormatSpec::rfc3339() {
+    static const FormatSpec spec("%Y-%m-%dT%H:%M:%S%:z");
+    return spec;
+}
 
-#if defined(_MSC_VER) || defined(__MINGW32__)
-    // Windows 使用 localtime_s
-    if (localtime_s(&tm, &time) != 0) {
-        throw std::invalid_argument("Failed to convert time to local time");
+DATETIME_INLINE void FormatSpec::push(char conversion, char value) {
+    if (size_ == kMaxOps) {
+        compiled_ = false;
+        return;
     }
-#else
-    // Linux/macOS 使用 localtime_r
-    if (localtime_r(&time, &tm) == nullptr) {
-        throw std::invalid_argument("Failed to convert time to local time");
+    ops_[size_].conversion = conversion;
+    ops_[size_].value = value;
+    ++size_;
+}
+
+DATETIME_INLINE void FormatSpec::compile() {
+    size_ = 0;
+    layout_ = Generic;
+    compiled_ = true;
+    parsable_ = true;
+
+    for (const char* p = pattern_.c_str(); *p != '\0'; ++p) {
+        if (*p != '%') {
+            push('\0', *p);
+            continue;
+        }
+        if (p[1] == '\0') {
+            push('\0', '%');
+            break;
+        }
+        if (p[1] == ':' && p[2] == 'z') {
+            push('z', ':');
+            p += 2;
+            continue;
+        }
+        if ((p[1] == 'E' || p[1] == 'O') && p[2] != '\0') {
+            push(p[2], p[1]);
+            parsable_ = false;
+            p += 2;
+            continue;
+        }
+
+        // 复合说明符展开成基本操作，解析和定长布局识别都只需处理基本操作 
+        switch (*++p) {
+        case 'F':
+            push('Y', '\0'); push('\0', '-'); push('m', '\0'); push('\0', '-'); push('d', '\0');
+            break;
+        case 'T':
+            push('H', '\0'); push('\0', ':'); push('M', '\0'); push('\0', ':'); push('S', '\0');
+            break;
+        case 'R':
+            push('H', '\0'); push('\0', ':'); push('M', '\0');
+            break;
+        default:
+            push(*p, '\0');
+            parsable_ = parsable_ && isParsableConversion(*p);
+            break;
+        }
+    }
+
+    if (!compiled_) {
+        return;
+    }
+
+    static const Op kIsoOps[] = {
+        { 'Y', '\0' }, { '\0', '-' }, { 'm', '\0' }, { '\0', '-' }, { 'd', '\0' }, { '\0', 'T' },
+        { 'H', '\0' }, { '\0', ':' }, { 'M', '\0' }, { '\0', ':' }, { 'S', '\0' }, { 'z', ':' }
+    };
+    bool isoPrefix = size_ >= 11;
+    for (size_t i = 0; isoPrefix && i < 11; ++i) {
+        isoPrefix = i == 5 || (ops_[i].conversion == kIsoOps[i].conversion && ops_[i].value == kIsoOps[i].value);
+    }
+    if (!isoPrefix || ops_[5].conversion != '\0') {
+        return;
+    }
+    if (size_ == 11 && ops_[5].value == ' ') {
+        layout_ = DateTimeLayout;
+    } else if (size_ == 11 && ops_[5].value == 'T') {
+        layout_ = Iso8601;
+    } else if (size_ == 12 && ops_[5].value == 'T' && ops_[11].conversion == 'z' && ops_[11].value == ':') {
+        layout_ = Rfc3339;
     }
+}
+
+// DateTime 实现 
+DATETIME_INLINE DateTime::DateTime() : time_point_(std::chrono::system_clock::now()) {}
+
+DATETIME_INLINE DateTime::DateTime(int year, int month, int day, int hour, int minute, int second) {
+    std::tm tm;
+    Status status = makeLocal(year, month, day, hour, minute, second, tm, time_point_);
+    if (status != Status::Ok) {
+        DATETIME_THROW(statusMessage(status));
+    }
+#ifdef DATETIME_CACHE_FIELDS
+    // mktime 已经规范化了 tm，直接作为缓存 
+    fields_cache_ = fieldsFromTm(tm);
+    fields_cached_ = true;
 #endif
+}
 
-    tm.tm_year += years;
-    tm.tm_isdst = -1;
+DATETIME_INLINE DateTime DateTime::now() {
+    return { std::chrono::system_clock::now() };
+}
 
-    time_t new_time = std::mktime(&tm);
-    return { std::chrono::system_clock::from_time_t(new_time) };
+DATETIME_INLINE DateTime DateTime::fromString(const std::string& dateStr, const std::string& format) {
+    if (format == kDefaultPattern) {
+        return parseOrThrow(dateStr, defaultSpec(), false);
+    }
+    return parseOrThrow(dateStr, FormatSpec(format), false);
 }
 
-DateTime DateTime::addMonths(int months) const {
-    std::tm tm = {};
-    time_t time = std::chrono::system_clock::to_time_t(time_point_);
+DATETIME_INLINE DateTime DateTime::fromString(const std::string& dateStr, const FormatSpec& spec) {
+    return parseOrThrow(dateStr, spec, false);
+}
 
-#if defined(_MSC_VER) || defined(__MINGW32__)
-    // Windows 使用 localtime_s
-    if (localtime_s(&tm, &time) != 0) {
-        throw std::invalid_argument("Failed to convert time to local time");
+DATETIME_INLINE DateTime DateTime::utc(int year, int month, int day, int hour, int minute, int second) {
+    DateTime result{ std::chrono::system_clock::time_point() };
+    Status status = makeUtc(year, month, day, hour, minute, second, result);
+    if (status != Status::Ok) {
+        DATETIME_THROW(statusMessage(status));
     }
-#else
-    // Linux/macOS 使用 localtime_r
-    if (localtime_r(&time, &tm) == nullptr) {
-        throw std::invalid_argument("Failed to convert time to local time");
+    return result;
+}
+
+DATETIME_INLINE DateTime DateTime::nowCoarse() {
+    return { CoarseClock::now() };
+}
+
+DATETIME_INLINE DateTime DateTime::utcNow() {
+    return now().toUtc();
+}
+
+DATETIME_INLINE DateTime DateTime::fromStringUtc(const std::string& dateStr, const std::string& format) {
+    if (format == kDefaultPattern) {
+        return parseOrThrow(dateStr, defaultSpec(), true);
     }
+    return parseOrThrow(dateStr, FormatSpec(format), true);
+}
+
+DATETIME_INLINE DateTime DateTime::fromStringUtc(const std::string& dateStr, const FormatSpec& spec) {
+    return parseOrThrow(dateStr, spec, true);
+}
+
+DATETIME_INLINE Status DateTime::tryMake(int year, int month, int day, DateTime& out) {
+    return tryMake(year, month, day, 0, 0, 0, out);
+}
+
+DATETIME_INLINE Status DateTime::tryMake(int year, int month, int day, int hour, int minute, int second,
+                                         DateTime& out) {
+    std::tm tm;
+    std::chrono::system_clock::time_point tp;
+    Status status = makeLocal(year, month, day, hour, minute, second, tm, tp);
+    if (status == Status::Ok) {
+        out = DateTime(tp);
+#ifdef DATETIME_CACHE_FIELDS
+        out.fields_cache_ = fieldsFromTm(tm);
+        out.fields_cached_ = true;
 #endif
+    }
+    return status;
+}
 
-    tm.tm_mon += months;
-    tm.tm_isdst = -1;
+DATETIME_INLINE Status DateTime::tryMakeUtc(int year, int month, int day, DateTime& out) {
+    return makeUtc(year, month, day, 0, 0, 0, out);
+}
 
-    time_t new_time = std::mktime(&tm);
-    return { std::chrono::system_clock::from_time_t(new_time) };
+DATETIME_INLINE Status DateTime::tryMakeUtc(int year, int month, int day, int hour, int minute, int second,
+                                            DateTime& out) {
+    return makeUtc(year, month, day, hour, minute, second, out);
 }
 
-DateTime DateTime::addDays(int days) const {
-    auto new_time = time_point_ + std::chrono::hours(24 * days);
-    return { new_time };
+DATETIME_INLINE Status DateTime::tryParse(const std::string& dateStr, DateTime& out) {
+    return parseDateTime(dateStr, defaultSpec(), false, out);
 }
 
-DateTime DateTime::addHours(int hours) const {
-    auto new_time = time_point_ + std::chrono::hours(hours);
-    return { new_time };
+DATETIME_INLINE Status DateTime::tryParse(const std::string& dateStr, const std::string& format, DateTime& out) {
+    if (format == kDefaultPattern) {
+        return parseDateTime(dateStr, defaultSpec(), false, out);
+    }
+    return parseDateTime(dateStr, FormatSpec(format), false, out);
 }
 
-DateTime DateTime::addMinutes(int minutes) const {
-    auto new_time = time_point_ + std::chrono::minutes(minutes);
-    return { new_time };
+DATETIME_INLINE Status DateTime::tryParse(const std::string& dateStr, const FormatSpec& spec, DateTime& out) {
+    return parseDateTime(dateStr, spec, false, out);
 }
 
-DateTime DateTime::addSeconds(int seconds) const {
-    auto new_time = time_point_ + std::chrono::seconds(seconds);
-    return { new_time };
+DATETIME_INLINE Status DateTime::tryParseUtc(const std::string& dateStr, DateTime& out) {
+    return parseDateTime(dateStr, defaultSpec(), true, out);
 }
 
-DateTime DateTime::replace(int year, int month, int day, int hour, int minute, int second) const {
-    time_t time = std::chrono::system_clock::to_time_t(time_point_);
+DATETIME_INLINE Status DateTime::tryParseUtc(const std::string& dateStr, const std::string& format, DateTime& out) {
+    if (format == kDefaultPattern) {
+        return parseDateTime(dateStr, defaultSpec(), true, out);
+    }
+    return parseDateTime(dateStr, FormatSpec(format), true, out);
+}
 
-    std::tm tm{};
-#if defined(_MSC_VER) || defined(__MINGW32__)
-    // Windows 使用 localtime_s
-    if (localtime_s(&tm, &time) != 0) {
-        throw std::invalid_argument("Failed to convert time to local time");
+DATETIME_INLINE Status DateTime::tryParseUtc(const std::string& dateStr, const FormatSpec& spec, DateTime& out) {
+    return parseDateTime(dateStr, spec, true, out);
+}
+
+DATETIME_INLINE DateTimeFields DateTime::fields() const {
+#ifdef DATETIME_CACHE_FIELDS
+    if (!fields_cached_) {
+        long long seconds = flooredSeconds(time_point_);
+        fields_cache_ = utc_ ? civil::fieldsFromSeconds(seconds + static_cast<long long>(offset_))
+                             : fieldsFromTm(toLocalTm(static_cast<time_t>(seconds)));
+        fields_cached_ = true;
     }
+    return fields_cache_;
 #else
-    // Linux/macOS 使用 localtime_r
-    if (localtime_r(&time, &tm) == nullptr) {
-        throw std::invalid_argument("Failed to convert time to local time");
-    }
+    long long seconds = flooredSeconds(time_point_);
+    return utc_ ? civil::fieldsFromSeconds(seconds + static_cast<long long>(offset_))
+                : fieldsFromTm(toLocalTm(static_cast<time_t>(seconds)));
 #endif
+}
 
-    if (year != -1) tm.tm_year = year - 1900;
-    if (month != -1) tm.tm_mon = month - 1;
-    if (day != -1) tm.tm_mday = day;
-    if (hour != -1) tm.tm_hour = hour;
-    if (minute != -1) tm.tm_min = minute;
-    if (second != -1) tm.tm_sec = second;
+DATETIME_INLINE int DateTime::year() const {
+    return fields().year;
+}
 
-    tm.tm_isdst = -1;
-    time_t new_time = std::mktime(&tm);
-    return { std::chrono::system_clock::from_time_t(new_time) };
+DATETIME_INLINE int DateTime::month() const {
+    return fields().month;
 }
 
-bool DateTime::operator==(const DateTime& other) const {
-    return time_point_ == other.time_point_;
+DATETIME_INLINE int DateTime::day() const {
+    return fields().day;
 }
 
-bool DateTime::operator!=(const DateTime& other) const {
-    return !(*this == other);
+DATETIME_INLINE int DateTime::hour() const {
+    return fields().hour;
 }
 
-bool DateTime::operator<(const DateTime& other) const {
-    return time_point_ < other.time_point_;
+DATETIME_INLINE int DateTime::minute() const {
+    return fields().minute;
 }
 
-bool DateTime::operator<=(const DateTime& other) const {
-    return time_point_ <= other.time_point_;
+DATETIME_INLINE int DateTime::second() const {
+    return fields().second;
 }
 
-bool DateTime::operator>(const DateTime& other) const {
-    return time_point_ > other.time_point_;
+DATETIME_INLINE int DateTime::weekday() const {
+    return fields().weekday;
 }
 
-bool DateTime::operator>=(const DateTime& other) const {
-    return time_point_ >= other.time_point_;
+DATETIME_INLINE int DateTime::dayOfYear() const {
+    return fields().dayOfYear;
 }
 
-std::chrono::system_clock::time_point DateTime::getTimePoint() const {
-    return time_point_;
+DATETIME_INLINE std::string DateTime::toString(const std::string& format) const {
+    return strftime(format);
 }
 
-// TimeDelta 实现 
-TimeDelta::TimeDelta() : duration_(0) {}
+DATETIME_INLINE std::string DateTime::toString(const std::string& format, const TimeZone& tz) const {
+    return in(tz).strftime(format);
+}
 
-TimeDelta::TimeDelta(int days, int hours, int minutes, int seconds)
-	: duration_(std::chrono::seconds(days * 24 * 3600 + hours * 3600 + minutes * 60 + seconds)) {
-    //duration_ = std::chrono::seconds(days * 24 * 3600 + hours * 3600 + minutes * 60 + seconds);
+DATETIME_INLINE std::string DateTime::isoformat() const {
+    char buffer[32];
+    size_t length = formatTo(buffer, sizeof(buffer), FormatSpec::iso8601());
+    return { buffer, length };
 }
 
-TimeDelta::TimeDelta(const std::chrono::seconds& duration) : duration_(duration) {}
+DATETIME_INLINE std::string DateTime::strftime(const std::string& format) const {
+    char buffer[256];
+    size_t length = formatTo(buffer, sizeof(buffer), format.c_str());
+    return { buffer, length };
+}
 
-long long TimeDelta::totalSeconds() const {
-    return duration_.count();
+DATETIME_INLINE std::string DateTime::strftime(const FormatSpec& spec) const {
+    char buffer[256];
+    size_t length = formatTo(buffer, sizeof(buffer), spec);
+    return { buffer, length };
 }
 
-int TimeDelta::days() const {
-    return static_cast<int>(duration_.count() / (24 * 3600));
+DATETIME_INLINE size_t DateTime::formatTo(char* out, size_t capacity, const char* format) const {
+    DATETIME_STAT_COUNT(kFormatCalls);
+    DATETIME_STAT_TIME(kFormatTimer);
+    return formatUncounted(out, capacity, format);
 }
 
-int TimeDelta::seconds() const {
-    return static_cast<int>(duration_.count() % (24 * 3600));
+DATETIME_INLINE size_t DateTime::formatUncounted(char* out, size_t capacity, const char* format) const {
+    return formatWithPattern(out, capacity, format, makeContext(time_point_, utc_, offset_, zoneLabel(zoned_, zone_)));
 }
 
-TimeDelta TimeDelta::operator+(const TimeDelta& other) const {
-    return { duration_ + other.duration_ };
+DATETIME_INLINE size_t DateTime::formatTo(char* out, size_t capacity, const FormatSpec& spec) const {
+    DATETIME_STAT_COUNT(kFormatCalls);
+    DATETIME_STAT_TIME(kFormatTimer);
+    return formatWithSpec(out, capacity, spec, makeContext(time_point_, utc_, offset_, zoneLabel(zoned_, zone_)));
 }
 
-TimeDelta TimeDelta::operator-(const TimeDelta& other) const {
-    return { duration_ - other.duration_ };
+DATETIME_INLINE CachedNowFormatter::CachedNowFormatter(const std::string& pattern, bool utc)
+    : pattern_(pattern), utc_(utc), cacheable_(true), fractionCount_(0), fractions_(),
+      sequence_(0), second_(std::numeric_limits<long long>::min()), layout_(0) {
+    for (std::atomic<unsigned long long>& word : words_) {
+        word.store(0, std::memory_order_relaxed);
+    }
+    // 记录 %f 的位置；"%%" 等其他说明符整体跳过 
+    for (size_t i = 0; i + 1 < pattern_.size(); ++i) {
+        if (pattern_[i] != '%') {
+            continue;
+        }
+        if (pattern_[i + 1] == 'f') {
+            if (fractionCount_ == kMaxFractions) {
+                cacheable_ = false;
+                break;
+            }
+            fractions_[fractionCount_++] = i;
+        }
+        ++i;
+    }
 }
 
-TimeDelta TimeDelta::operator*(int multiplier) const {
-    return { duration_ * multiplier };
+DATETIME_INLINE size_t CachedNowFormatter::formatTo(char* out, size_t capacity) const {
+    return formatTo(out, capacity, std::chrono::system_clock::now());
 }
 
-TimeDelta TimeDelta::operator/(int divisor) const {
-    return { duration_ / divisor };
+DATETIME_INLINE size_t CachedNowFormatter::formatTo(char* out, size_t capacity,
+                                                    const std::chrono::system_clock::time_point& tp) const {
+    DATETIME_STAT_COUNT(kFormatCalls);
+    DATETIME_STAT_TIME(kFormatTimer);
+    if (!cacheable_) {
+        DateTime dt(tp);
+        return (utc_ ? dt.toUtc() : dt).formatUncounted(out, capacity, pattern_.c_str());
+    }
+    long long total = std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+    long long second = civil::detail::floorDiv(total, 1000000000LL);
+    int microseconds = static_cast<int>((total - second * 1000000000LL) / 1000);
+
+    // seqlock 读：序号为偶数且前后一致时拷贝到的内容完整 
+    unsigned long long words[kWords];
+    unsigned long long layout = 0;
+    for (;;) {
+        unsigned begin = sequence_.load(std::memory_order_acquire);
+        if ((begin & 1) != 0 || second_.load(std::memory_order_relaxed) != second) {
+            return refresh(second, microseconds, out, capacity);
+        }
+        layout = layout_.load(std::memory_order_relaxed);
+        size_t used = ((layout & 0xFF) + 7) / 8;
+        for (size_t i = 0; i < used; ++i) {
+            words[i] = words_[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence_.load(std::memory_order_relaxed) == begin) {
+            break;
+        }
+    }
+
+    size_t length = static_cast<size_t>(layout & 0xFF);
+    if (length >= capacity) {
+        return 0;
+    }
+    std::memcpy(out, words, length);
+    out[length] = '\0';
+    for (size_t i = 0; i < fractionCount_; ++i) {
+        writeMicroseconds(out + ((layout >> (8 * (i + 1))) & 0xFF), microseconds);
+    }
+    return length;
 }
 
-bool TimeDelta::operator==(const TimeDelta& other) const {
-    return duration_ == other.duration_;
+DATETIME_INLINE size_t CachedNowFormatter::refresh(long long second, int microseconds, char* out,
+                                                   size_t capacity) const {
+    DateTime dt(std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::seconds(second))));
+    if (utc_) {
+        dt = dt.toUtc();
+    }
+
+    // 以 %f 为界分段格式化，%f 先占位，记录其在结果中的位置 
+    std::string text;
+    unsigned long long layout = 0;
+    size_t begin = 0;
+    for (size_t i = 0; i <= fractionCount_; ++i) {
+        size_t end = i < fractionCount_ ? fractions_[i] : pattern_.size();
+        if (end > begin) {
+            char buffer[256];
+            size_t length = dt.formatUncounted(buffer, sizeof(buffer), pattern_.substr(begin, end - begin).c_str());
+            text.append(buffer, length);
+        }
+        if (i < fractionCount_) {
+            layout |= static_cast<unsigned long long>(text.size() & 0xFF) << (8 * (i + 1));
+            text.append(6, '0');
+            begin = end + 2;
+        }
+    }
+
+    bool fits = text.size() < kCapacity;
+    if (fits) {
+        layout |= text.size();
+        // seqlock 写：抢到奇数序号的线程发布，其余线程直接使用自己的结果 
+        unsigned sequence = sequence_.load(std::memory_order_relaxed);
+        if ((sequence & 1) == 0 &&
+            sequence_.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire)) {
+            std::atomic_thread_fence(std::memory_order_release);
+            for (size_t i = 0; i * 8 < text.size(); ++i) {
+                unsigned long long word = 0;
+                std::memcpy(&word, text.data() + i * 8, std::min<size_t>(8, text.size() - i * 8));
+                words_[i].store(word, std::memory_order_relaxed);
+            }
+            layout_.store(layout, std::memory_order_relaxed);
+            second_.store(second, std::memory_order_relaxed);
+            sequence_.store(sequence + 2, std::memory_order_release);
+        }
+    }
+
+    if (text.size() >= capacity) {
+        return 0;
+    }
+    std::memcpy(out, text.data(), text.size());
+    out[text.size()] = '\0';
+    if (fits) {
+        for (size_t i = 0; i < fractionCount_; ++i) {
+            writeMicroseconds(out + ((layout >> (8 * (i + 1))) & 0xFF), microseconds);
+        }
+    } else {
+        // 超出缓存容量时结果中的 %f 位置无法用 8 位记录，整体重新格式化 
+        DateTime exact(dt.getTimePoint() + std::chrono::microseconds(microseconds));
+        return (utc_ ? exact.toUtc() : exact).formatUncounted(out, capacity, pattern_.c_str());
+    }
+    return text.size();
 }
 
-bool TimeDelta::operator!=(const TimeDelta& other) const {
-    return !(*this == other);
+DATETIME_INLINE std::string CachedNowFormatter::format() const {
+    char buffer[kCapacity];
+    size_t length = formatTo(buffer, sizeof(buffer));
+    if (length == 0 && !pattern_.empty()) {
+        DateTime dt = DateTime::now();
+        return (utc_ ? dt.toUtc() : dt).strftime(pattern_);
+    }
+    return { buffer, length };
 }
 
-bool TimeDelta::operator<(const TimeDelta& other) const {
-    return duration_ < other.duration_;
+DATETIME_INLINE DateTime DateTime::addYears(int years, MonthOverflow overflow) const {
+    return shiftedBy(monthShift(time_point_, utc_, offset_, years * 12LL, overflow));
 }
 
-bool TimeDelta::operator<=(const TimeDelta& other) const {
-    return duration_ <= other.duration_;
+DATETIME_INLINE DateTime DateTime::addMonths(int months, MonthOverflow overflow) const {
+    return shiftedBy(monthShift(time_point_, utc_, offset_, months, overflow));
 }
 
-bool TimeDelta::operator>(const TimeDelta& other) const {
-    return duration_ > other.duration_;
+DATETIME_INLINE DateTime DateTime::replace(int year, int month, int day, int hour, int minute, int second) const {
+    std::tm tm = toTm(std::chrono::system_clock::to_time_t(time_point_), utc_, offset_, zoneLabel(zoned_, zone_));
+
+    if (year != -1) tm.tm_year = year - 1900;
+    if (month != -1) tm.tm_mon = month - 1;
+    if (day != -1) tm.tm_mday = day;
+    if (hour != -1) tm.tm_hour = hour;
+    if (minute != -1) tm.tm_min = minute;
+    if (second != -1) tm.tm_sec = second;
+
+    time_t new_time = fromTm(tm, utc_, offset_);
+    return shiftedBy(std::chrono::system_clock::from_time_t(new_time) - time_point_);
 }
 
-bool TimeDelta::operator>=(const TimeDelta& other) const {
-    return duration_ >= other.duration_;
+DATETIME_INLINE DateTime DateTime::floor(TimeUnit unit) const {
+    return shiftedBy(roundTimePoint(time_point_, utc_, offset_, unit, civil::Rounding::Floor) - time_point_);
 }
 
-std::string TimeDelta::toString() const {
-    long long total_seconds = duration_.count();
-    int days = static_cast<int>(total_seconds / (24 * 3600));
-    int hours = static_cast<int>((total_seconds % (24 * 3600)) / 3600);
-    int minutes = static_cast<int>((total_seconds % 3600) / 60);
-    int seconds = static_cast<int>(total_seconds % 60);
+DATETIME_INLINE DateTime DateTime::ceil(TimeUnit unit) const {
+    return shiftedBy(roundTimePoint(time_point_, utc_, offset_, unit, civil::Rounding::Ceil) - time_point_);
+}
 
-    std::ostringstream oss;
-    if (days != 0) {
-        oss << days << " day" << (days != 1 ? "s" : "") << ", ";
-    }
+DATETIME_INLINE DateTime DateTime::round(TimeUnit unit) const {
+    return shiftedBy(roundTimePoint(time_point_, utc_, offset_, unit, civil::Rounding::Nearest) - time_point_);
+}
 
-    oss << std::setfill('0') << std::setw(2) << hours << ":"
-        << std::setw(2) << minutes << ":" << std::setw(2) << seconds;
+// TimeDelta 实现 
+#ifndef DATETIME_HEADER_ONLY
+template class BasicTimeDelta<std::chrono::seconds>;
+#endif
 
-    return oss.str();
+// 工具函数 
+DATETIME_INLINE const char* statusMessage(Status status) {
+    switch (status) {
+    case Status::Ok: return "OK";
+    case Status::InvalidMonth: return "Month must be between 1 and 12";
+    case Status::InvalidDay: return "Invalid day for the given month";
+    case Status::InvalidHour: return "Hour must be between 0 and 23";
+    case Status::InvalidMinute: return "Minute must be between 0 and 59";
+    case Status::InvalidSecond: return "Second must be between 0 and 59";
+    case Status::ParseError: return "Failed to parse date string";
+    case Status::OutOfRange: return "Invalid date/time";
+    }
+    return "Unknown status";
 }
 
-// DateTime 和 TimeDelta 之间的运算 
-DateTime operator+(const DateTime& dt, const TimeDelta& td) {
-    auto new_time = dt.getTimePoint() + std::chrono::seconds(td.totalSeconds());
-    return { new_time };
+DATETIME_INLINE uint64_t CycleHistogram::count() const {
+    uint64_t sum = 0;
+    for (uint64_t bucket : buckets) {
+        sum += bucket;
+    }
+    return sum;
 }
 
-DateTime operator-(const DateTime& dt, const TimeDelta& td) {
-    auto new_time = dt.getTimePoint() - std::chrono::seconds(td.totalSeconds());
-    return { new_time };
+DATETIME_INLINE uint64_t CycleHistogram::percentile(double q) const {
+    uint64_t samples = count();
+    if (samples == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(samples) + 0.999999);
+    uint64_t seen = 0;
+    for (int i = 0; i + 1 < kBuckets; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return 1ULL << (i + 1);
+        }
+    }
+    return std::numeric_limits<uint64_t>::max();
 }
 
-TimeDelta operator-(const DateTime& dt1, const DateTime& dt2) {
-    auto diff = dt1.getTimePoint() - dt2.getTimePoint();
-    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(diff);
-    return { seconds };
+DATETIME_INLINE bool statsEnabled() {
+#ifdef DATETIME_ENABLE_STATS
+    return true;
+#else
+    return false;
+#endif
 }
 
-// 工具函数 
-bool isLeapYear(int year) {
-    return (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
+DATETIME_INLINE Stats stats() {
+    Stats result = Stats();
+#ifdef DATETIME_ENABLE_STATS
+    uint64_t totals[detail::kStatSlots];
+    {
+        detail::StatsRegistry& registry = detail::statsRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        detail::sumStats(registry, totals);
+        for (int i = 0; i < detail::kStatSlots; ++i) {
+            totals[i] -= registry.baseline[i];
+        }
+    }
+    result.localtimeCalls = totals[detail::kLocaltimeCalls];
+    result.mktimeCalls = totals[detail::kMktimeCalls];
+    result.parseCalls = totals[detail::kParseCalls];
+    result.parseFailures = totals[detail::kParseFailures];
+    result.formatCalls = totals[detail::kFormatCalls];
+    result.zoneCacheHits = totals[detail::kZoneCacheHits];
+    result.zoneCacheMisses = totals[detail::kZoneCacheMisses];
+    CycleHistogram* histograms[] = { &result.localtimeCycles, &result.mktimeCycles, &result.parseCycles,
+                                     &result.formatCycles };
+    for (int t = 0; t < detail::kStatTimers; ++t) {
+        const uint64_t* slots = totals + detail::kStatCounters + t * detail::kStatHistogramSlots;
+        std::copy(slots, slots + CycleHistogram::kBuckets, histograms[t]->buckets);
+        histograms[t]->total = slots[CycleHistogram::kBuckets];
+    }
+#endif
+    return result;
+}
+
+DATETIME_INLINE void resetStats() {
+#ifdef DATETIME_ENABLE_STATS
+    detail::StatsRegistry& registry = detail::statsRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    detail::sumStats(registry, registry.baseline);
+#endif
 }
 
-int daysInMonth(int year, int month) {
+DATETIME_INLINE int daysInMonth(int year, int month) {
     static const int days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
     if (month == 2 && isLeapYear(year)) {
         return 29;
@@ -527,8 +1843,24 @@ int daysInMonth(int year, int month) {
     return days[month - 1];
 }
 
-std::string formatDuration(const TimeDelta& td) {
+DATETIME_INLINE std::string formatDuration(const TimeDelta& td) {
     return td.toString();
 }
 
+DATETIME_INLINE bool parseIso8601(const char* str, size_t length, DateTime& out) {
+    return parseIso8601Impl(str, length, false, out);
+}
+
+DATETIME_INLINE bool parseIso8601(const std::string& str, DateTime& out) {
+    return parseIso8601Impl(str.data(), str.size(), false, out);
+}
+
+DATETIME_INLINE bool parseIso8601Utc(const char* str, size_t length, DateTime& out) {
+    return parseIso8601Impl(str, length, true, out);
+}
+
+DATETIME_INLINE bool parseIso8601Utc(const std::string& str, DateTime& out) {
+    return parseIso8601Impl(str.data(), str.size(), true, out);
+}
+
 } // namespace datetime
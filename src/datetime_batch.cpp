@@ -0,0 +1,1269 @@
+#include "datetime_batch.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define DATETIME_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+namespace datetime {
+
+namespace {
+// 仅头文件模式下与 datetime.cpp 位于同一翻译单元，辅助函数放在独立的命名空间中避免重名 
+namespace column {
+
+// 校验范围后换算为 Unix 秒数 
+inline int64_t composeRow(int year, int month, int day, int hour, int minute, int second) {
+    if (month < 1 || month > 12 || day < 1 || day > civil::daysInMonth(year, month) ||
+        hour > 23 || minute > 59 || second > 59) {
+        return kInvalidEpoch;
+    }
+    return civil::secondsFromCivil(year, month, day, hour, minute, second);
+}
+
+inline bool isDigit(char c) {
+    return static_cast<unsigned>(c - '0') <= 9;
+}
+
+inline int twoDigits(const char* p) {
+    return (p[0] - '0') * 10 + (p[1] - '0');
+}
+
+// 行尾的 ":SS" 不在 16 字节向量内，单独检查 
+inline bool secondsTailValid(const char* p) {
+    return p[16] == ':' && isDigit(p[17]) && isDigit(p[18]);
+}
+
+int64_t parseRowScalar(const char* p) {
+    static const int kDigitPositions[] = { 0, 1, 2, 3, 5, 6, 8, 9, 11, 12, 14, 15, 17, 18 };
+    for (int position : kDigitPositions) {
+        if (!isDigit(p[position])) {
+            return kInvalidEpoch;
+        }
+    }
+    if (p[4] != '-' || p[7] != '-' || (p[10] != ' ' && p[10] != 'T') || p[13] != ':' || p[16] != ':') {
+        return kInvalidEpoch;
+    }
+    return composeRow(twoDigits(p) * 100 + twoDigits(p + 2), twoDigits(p + 5), twoDigits(p + 8),
+                      twoDigits(p + 11), twoDigits(p + 14), twoDigits(p + 17));
+}
+
+size_t parseColumnScalar(const char* base, size_t stride, size_t n, int64_t* outEpoch) {
+    size_t parsed = 0;
+    for (size_t i = 0; i < n; ++i) {
+        outEpoch[i] = parseRowScalar(base + i * stride);
+        parsed += outEpoch[i] != kInvalidEpoch;
+    }
+    return parsed;
+}
+
+const char kDigitPairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// 定长布局的一行：7 个两位数（世纪、年、月、日、时、分、秒） 
+struct RowDigits {
+    int values[7];
+};
+
+// 年份不在 [0, 9999] 内时返回 false 
+inline bool splitRow(int64_t epoch, RowDigits& row) {
+    if (epoch == kInvalidEpoch) {
+        return false;
+    }
+    DateTimeFields f = civil::fieldsFromSeconds(epoch);
+    if (f.year < 0 || f.year > 9999) {
+        return false;
+    }
+    row.values[0] = f.year / 100;
+    row.values[1] = f.year % 100;
+    row.values[2] = f.month;
+    row.values[3] = f.day;
+    row.values[4] = f.hour;
+    row.values[5] = f.minute;
+    row.values[6] = f.second;
+    return true;
+}
+
+// 布局的第 10 个字符和 19 字节之后的后缀 
+struct FixedLayout {
+    char separator;
+    const char* suffix;
+    size_t width;
+};
+
+inline void blankRow(char* row, size_t stride) {
+    std::memset(row, ' ', stride);
+}
+
+void formatRowScalar(const RowDigits& digits, const FixedLayout& layout, char* row) {
+    static const int kOffsets[] = { 0, 2, 5, 8, 11, 14, 17 };
+    for (int k = 0; k < 7; ++k) {
+        std::memcpy(row + kOffsets[k], &kDigitPairs[digits.values[k] * 2], 2);
+    }
+    row[4] = '-';
+    row[7] = '-';
+    row[10] = layout.separator;
+    row[13] = ':';
+    row[16] = ':';
+}
+
+size_t formatColumnScalar(const int64_t* epochs, size_t n, char* out, size_t stride, const FixedLayout& layout) {
+    size_t written = 0;
+    for (size_t i = 0; i < n; ++i) {
+        char* row = out + i * stride;
+        RowDigits digits;
+        blankRow(row, stride);
+        if (splitRow(epochs[i], digits)) {
+            formatRowScalar(digits, layout, row);
+            std::memcpy(row + 19, layout.suffix, layout.width - 19);
+            ++written;
+        }
+    }
+    return written;
+}
+
+// extractFields 可以分解的秒数范围，保证年份落在 int32 内 
+const int64_t kMaxFieldEpoch = 1LL << 55;
+
+inline void writeFields(const DateTimeFields& f, Field mask, const ColumnOut& out, size_t i) {
+    if (hasField(mask, Field::Year)) out.year[i] = f.year;
+    if (hasField(mask, Field::Month)) out.month[i] = static_cast<uint8_t>(f.month);
+    if (hasField(mask, Field::Day)) out.day[i] = static_cast<uint8_t>(f.day);
+    if (hasField(mask, Field::Hour)) out.hour[i] = static_cast<uint8_t>(f.hour);
+    if (hasField(mask, Field::Minute)) out.minute[i] = static_cast<uint8_t>(f.minute);
+    if (hasField(mask, Field::Second)) out.second[i] = static_cast<uint8_t>(f.second);
+    if (hasField(mask, Field::Weekday)) out.weekday[i] = static_cast<uint8_t>(f.weekday);
+    if (hasField(mask, Field::DayOfYear)) out.dayOfYear[i] = static_cast<uint16_t>(f.dayOfYear);
+}
+
+inline bool extractRow(int64_t epoch, Field mask, const ColumnOut& out, size_t i) {
+    if (epoch == kInvalidEpoch || epoch < -kMaxFieldEpoch || epoch > kMaxFieldEpoch) {
+        DateTimeFields zero = {};
+        writeFields(zero, mask, out, i);
+        return false;
+    }
+    writeFields(civil::fieldsFromSeconds(epoch), mask, out, i);
+    return true;
+}
+
+size_t extractFieldsScalar(const int64_t* epochs, size_t begin, size_t end, Field mask, const ColumnOut& out) {
+    size_t valid = 0;
+    for (size_t i = begin; i < end; ++i) {
+        valid += extractRow(epochs[i], mask, out, i);
+    }
+    return valid;
+}
+
+#ifdef DATETIME_X86_DISPATCH
+
+// 向量内核只处理每行前 16 字节 "YYYY-MM-DD HH:MM"：
+// 减去 '0' 后用无符号 min 判断数字位，用模板比较判断分隔符，
+// 再用 pshufb 收集 12 个数字、pmaddubsw 按 (10, 1) 加权，一次得到 6 个两位数 
+
+__attribute__((target("sse4.2")))
+size_t parseColumnSse42(const char* base, size_t stride, size_t n, int64_t* outEpoch) {
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i layout = _mm_setr_epi8('0', '0', '0', '0', '-', '0', '0', '-',
+                                         '0', '0', ' ', '0', '0', ':', '0', '0');
+    const __m128i altLayout = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 'T', 0, 0, 0, 0, 0);
+    const __m128i altMask = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -1, 0, 0, 0, 0, 0);
+    const __m128i digitMask = _mm_setr_epi8(-1, -1, -1, -1, 0, -1, -1, 0, -1, -1, 0, -1, -1, 0, -1, -1);
+    const __m128i gather = _mm_setr_epi8(0, 1, 2, 3, 5, 6, 8, 9, 11, 12, 14, 15, -1, -1, -1, -1);
+    const __m128i weights = _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 0, 0, 0, 0);
+
+    size_t parsed = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const char* row = base + i * stride;
+        __m128i text = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row));
+        __m128i digits = _mm_sub_epi8(text, zero);
+        __m128i digitOk = _mm_cmpeq_epi8(_mm_min_epu8(digits, nine), digits);
+        __m128i separatorOk = _mm_or_si128(_mm_cmpeq_epi8(text, layout),
+                                           _mm_and_si128(_mm_cmpeq_epi8(text, altLayout), altMask));
+        __m128i ok = _mm_blendv_epi8(separatorOk, digitOk, digitMask);
+
+        if (_mm_movemask_epi8(ok) != 0xFFFF || !secondsTailValid(row)) {
+            outEpoch[i] = kInvalidEpoch;
+            continue;
+        }
+
+        alignas(16) uint16_t pairs[8];
+        _mm_store_si128(reinterpret_cast<__m128i*>(pairs),
+                        _mm_maddubs_epi16(_mm_shuffle_epi8(digits, gather), weights));
+        outEpoch[i] = composeRow(pairs[0] * 100 + pairs[1], pairs[2], pairs[3],
+                                 pairs[4], pairs[5], twoDigits(row + 17));
+        parsed += outEpoch[i] != kInvalidEpoch;
+    }
+    return parsed;
+}
+
+// 每次处理两行，各占一个 128 位通道 
+__attribute__((target("avx2")))
+size_t parseColumnAvx2(const char* base, size_t stride, size_t n, int64_t* outEpoch) {
+    const __m256i zero = _mm256_set1_epi8('0');
+    const __m256i nine = _mm256_set1_epi8(9);
+    const __m256i layout = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8('0', '0', '0', '0', '-', '0', '0', '-', '0', '0', ' ', '0', '0', ':', '0', '0'));
+    const __m256i altLayout = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 'T', 0, 0, 0, 0, 0));
+    const __m256i altMask = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -1, 0, 0, 0, 0, 0));
+    const __m256i digitMask = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(-1, -1, -1, -1, 0, -1, -1, 0, -1, -1, 0, -1, -1, 0, -1, -1));
+    const __m256i gather = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(0, 1, 2, 3, 5, 6, 8, 9, 11, 12, 14, 15, -1, -1, -1, -1));
+    const __m256i weights = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 0, 0, 0, 0));
+
+    size_t parsed = 0;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        const char* rows[2] = { base + i * stride, base + (i + 1) * stride };
+        __m256i text = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[0]))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[1])), 1);
+        __m256i digits = _mm256_sub_epi8(text, zero);
+        __m256i digitOk = _mm256_cmpeq_epi8(_mm256_min_epu8(digits, nine), digits);
+        __m256i separatorOk = _mm256_or_si256(_mm256_cmpeq_epi8(text, layout),
+                                              _mm256_and_si256(_mm256_cmpeq_epi8(text, altLayout), altMask));
+        unsigned mask = static_cast<unsigned>(
+            _mm256_movemask_epi8(_mm256_blendv_epi8(separatorOk, digitOk, digitMask)));
+
+        alignas(32) uint16_t pairs[16];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(pairs),
+                           _mm256_maddubs_epi16(_mm256_shuffle_epi8(digits, gather), weights));
+
+        for (int lane = 0; lane < 2; ++lane) {
+            const uint16_t* p = pairs + lane * 8;
+            int64_t epoch = kInvalidEpoch;
+            if (((mask >> (lane * 16)) & 0xFFFF) == 0xFFFF && secondsTailValid(rows[lane])) {
+                epoch = composeRow(p[0] * 100 + p[1], p[2], p[3], p[4], p[5], twoDigits(rows[lane] + 17));
+            }
+            outEpoch[i + lane] = epoch;
+            parsed += epoch != kInvalidEpoch;
+        }
+    }
+    return parsed + parseColumnSse42(base + i * stride, stride, n - i, outEpoch + i);
+}
+
+// 数字输出：7 个两位数放进 16 位通道，tens = v * 6554 >> 16（v < 100 时等于 v / 10），
+// ones = v - tens * 10，拼成 [tens, ones] 字节对后加 '0'，再用 pshufb 排到输出位置，
+// 与分隔符模板按位或；行尾 ":SS" 与后缀单独写出 
+
+__attribute__((target("sse4.2")))
+inline __m128i digitPairsSse(const RowDigits& digits) {
+    __m128i values = _mm_setr_epi16(static_cast<short>(digits.values[0]), static_cast<short>(digits.values[1]),
+                                    static_cast<short>(digits.values[2]), static_cast<short>(digits.values[3]),
+                                    static_cast<short>(digits.values[4]), static_cast<short>(digits.values[5]),
+                                    static_cast<short>(digits.values[6]), 0);
+    __m128i tens = _mm_mulhi_epu16(values, _mm_set1_epi16(6554));
+    __m128i ones = _mm_sub_epi16(values, _mm_mullo_epi16(tens, _mm_set1_epi16(10)));
+    return _mm_add_epi8(_mm_or_si128(tens, _mm_slli_epi16(ones, 8)), _mm_set1_epi8('0'));
+}
+
+__attribute__((target("sse4.2")))
+size_t formatColumnSse42(const int64_t* epochs, size_t n, char* out, size_t stride, const FixedLayout& layout) {
+    const __m128i place = _mm_setr_epi8(0, 1, 2, 3, -1, 4, 5, -1, 6, 7, -1, 8, 9, -1, 10, 11);
+    const __m128i separators = _mm_setr_epi8(0, 0, 0, 0, '-', 0, 0, '-', 0, 0, layout.separator, 0, 0, ':', 0, 0);
+
+    size_t written = 0;
+    for (size_t i = 0; i < n; ++i) {
+        char* row = out + i * stride;
+        RowDigits digits;
+        blankRow(row, stride);
+        if (!splitRow(epochs[i], digits)) {
+            continue;
+        }
+        __m128i pairs = digitPairsSse(digits);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row),
+                         _mm_or_si128(_mm_shuffle_epi8(pairs, place), separators));
+        row[16] = ':';
+        row[17] = static_cast<char>(_mm_extract_epi8(pairs, 12));
+        row[18] = static_cast<char>(_mm_extract_epi8(pairs, 13));
+        std::memcpy(row + 19, layout.suffix, layout.width - 19);
+        ++written;
+    }
+    return written;
+}
+
+// 每次处理两行，各占一个 128 位通道 
+__attribute__((target("avx2")))
+size_t formatColumnAvx2(const int64_t* epochs, size_t n, char* out, size_t stride, const FixedLayout& layout) {
+    const __m256i place = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(0, 1, 2, 3, -1, 4, 5, -1, 6, 7, -1, 8, 9, -1, 10, 11));
+    const __m256i separators = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(0, 0, 0, 0, '-', 0, 0, '-', 0, 0, layout.separator, 0, 0, ':', 0, 0));
+    const __m256i multiplier = _mm256_set1_epi16(6554);
+    const __m256i ten = _mm256_set1_epi16(10);
+    const __m256i zero = _mm256_set1_epi8('0');
+
+    size_t written = 0;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        RowDigits digits[2] = {};
+        bool valid[2] = { splitRow(epochs[i], digits[0]), splitRow(epochs[i + 1], digits[1]) };
+        const int* a = digits[0].values;
+        const int* b = digits[1].values;
+        __m256i values = _mm256_setr_epi16(
+            static_cast<short>(a[0]), static_cast<short>(a[1]), static_cast<short>(a[2]), static_cast<short>(a[3]),
+            static_cast<short>(a[4]), static_cast<short>(a[5]), static_cast<short>(a[6]), 0,
+            static_cast<short>(b[0]), static_cast<short>(b[1]), static_cast<short>(b[2]), static_cast<short>(b[3]),
+            static_cast<short>(b[4]), static_cast<short>(b[5]), static_cast<short>(b[6]), 0);
+        if (!valid[0] || !valid[1]) {
+            values = _mm256_setzero_si256();
+        }
+        __m256i tens = _mm256_mulhi_epu16(values, multiplier);
+        __m256i ones = _mm256_sub_epi16(values, _mm256_mullo_epi16(tens, ten));
+        __m256i pairs = _mm256_add_epi8(_mm256_or_si256(tens, _mm256_slli_epi16(ones, 8)), zero);
+        __m256i text = _mm256_or_si256(_mm256_shuffle_epi8(pairs, place), separators);
+
+        alignas(32) char lanes[32];
+        alignas(32) char tails[32];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), text);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(tails), pairs);
+        for (int lane = 0; lane < 2; ++lane) {
+            char* row = out + (i + lane) * stride;
+            blankRow(row, stride);
+            if (!valid[lane]) {
+                continue;
+            }
+            if (!valid[1 - lane]) {
+                formatRowScalar(digits[lane], layout, row);
+            } else {
+                std::memcpy(row, lanes + lane * 16, 16);
+                row[16] = ':';
+                row[17] = tails[lane * 16 + 12];
+                row[18] = tails[lane * 16 + 13];
+            }
+            std::memcpy(row + 19, layout.suffix, layout.width - 19);
+            ++written;
+        }
+    }
+    return written + formatColumnSse42(epochs + i, n - i, out + i * stride, stride, layout);
+}
+
+// 字段分解：8 行一组，天数与日内秒数先在 double 通道中求出（|epoch| < 2^51 时精确），
+// 之后的 civil 算法全部在 32 位整数通道中进行；常数除法用单精度除法加 floor， 
+// 被除数小于 2^24 时结果精确 
+// 向量路径要求 z = days + 719468 落在 [0, 2^23)，即 0000-03-01 至约 22900 年 
+const int64_t kSimdFieldMinEpoch = -719468LL * 86400;
+const int64_t kSimdFieldMaxEpoch = ((1LL << 23) - 719468LL) * 86400 - 1;
+
+__attribute__((target("avx2")))
+inline __m256i floorDivSmall(__m256i a, float divisor) {
+    return _mm256_cvttps_epi32(_mm256_floor_ps(_mm256_div_ps(_mm256_cvtepi32_ps(a), _mm256_set1_ps(divisor))));
+}
+
+// 4 个 int64 秒数 -> 4 个 int32 天数与日内秒数；int64 -> double 使用 2^52 + 2^51 魔数技巧 
+__attribute__((target("avx2")))
+inline void splitEpochs(const int64_t* p, __m128i& days, __m128i& sod) {
+    const __m256i magicBits = _mm256_set1_epi64x(0x4338000000000000LL);
+    const __m256d magic = _mm256_set1_pd(6755399441055744.0);
+    const __m256d secondsPerDay = _mm256_set1_pd(86400.0);
+    __m256i epochs = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256d value = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_add_epi64(epochs, magicBits)), magic);
+    __m256d dayValue = _mm256_floor_pd(_mm256_div_pd(value, secondsPerDay));
+    days = _mm256_cvttpd_epi32(dayValue);
+    sod = _mm256_cvttpd_epi32(_mm256_sub_pd(value, _mm256_mul_pd(dayValue, secondsPerDay)));
+}
+
+// 取每个 32 位通道的低字节 / 低 16 位，写出 8 个元素 
+__attribute__((target("avx2")))
+inline void storeBytes(uint8_t* out, __m256i values) {
+    const __m256i pick = _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                          0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    __m256i bytes = _mm256_shuffle_epi8(values, pick);
+    __m128i packed = _mm_unpacklo_epi32(_mm256_castsi256_si128(bytes), _mm256_extracti128_si256(bytes, 1));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out), packed);
+}
+
+__attribute__((target("avx2")))
+inline void storeShorts(uint16_t* out, __m256i values) {
+    const __m256i pick = _mm256_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1,
+                                          0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1);
+    __m256i shorts = _mm256_shuffle_epi8(values, pick);
+    __m128i packed = _mm_unpacklo_epi64(_mm256_castsi256_si128(shorts), _mm256_extracti128_si256(shorts, 1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), packed);
+}
+
+__attribute__((target("avx2")))
+size_t extractFieldsAvx2(const int64_t* epochs, size_t n, Field mask, const ColumnOut& out) {
+    const __m256i low = _mm256_set1_epi64x(kSimdFieldMinEpoch - 1);
+    const __m256i high = _mm256_set1_epi64x(kSimdFieldMaxEpoch + 1);
+    const __m256i one = _mm256_set1_epi32(1);
+
+    size_t valid = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(epochs + i));
+        __m256i second = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(epochs + i + 4));
+        __m256i inRange = _mm256_and_si256(
+            _mm256_and_si256(_mm256_cmpgt_epi64(first, low), _mm256_cmpgt_epi64(high, first)),
+            _mm256_and_si256(_mm256_cmpgt_epi64(second, low), _mm256_cmpgt_epi64(high, second)));
+        if (_mm256_movemask_epi8(inRange) != -1) {
+            valid += extractFieldsScalar(epochs, i, i + 8, mask, out);
+            continue;
+        }
+
+        __m128i days0, sod0, days1, sod1;
+        splitEpochs(epochs + i, days0, sod0);
+        splitEpochs(epochs + i + 4, days1, sod1);
+        __m256i days = _mm256_inserti128_si256(_mm256_castsi128_si256(days0), days1, 1);
+        __m256i sod = _mm256_inserti128_si256(_mm256_castsi128_si256(sod0), sod1, 1);
+
+        if (hasField(mask, Field::Date | Field::DayOfYear)) {
+            __m256i z = _mm256_add_epi32(days, _mm256_set1_epi32(719468));
+            __m256i era = floorDivSmall(z, 146097.0f);
+            __m256i doe = _mm256_sub_epi32(z, _mm256_mullo_epi32(era, _mm256_set1_epi32(146097)));
+            __m256i yoeNumerator = _mm256_add_epi32(
+                _mm256_sub_epi32(doe, floorDivSmall(doe, 1460.0f)),
+                _mm256_sub_epi32(floorDivSmall(doe, 36524.0f), floorDivSmall(doe, 146096.0f)));
+            __m256i yoe = floorDivSmall(yoeNumerator, 365.0f);
+            __m256i doy = _mm256_sub_epi32(
+                doe, _mm256_sub_epi32(_mm256_add_epi32(_mm256_mullo_epi32(yoe, _mm256_set1_epi32(365)),
+                                                       _mm256_srli_epi32(yoe, 2)),
+                                      floorDivSmall(yoe, 100.0f)));
+            __m256i mp = floorDivSmall(_mm256_add_epi32(_mm256_mullo_epi32(doy, _mm256_set1_epi32(5)),
+                                                        _mm256_set1_epi32(2)), 153.0f);
+            // mp >= 10 为次年一、二月 
+            __m256i janFeb = _mm256_cmpgt_epi32(mp, _mm256_set1_epi32(9));
+            __m256i year = _mm256_sub_epi32(_mm256_add_epi32(yoe, _mm256_mullo_epi32(era, _mm256_set1_epi32(400))),
+                                            janFeb);
+
+            if (hasField(mask, Field::Year)) {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out.year + i), year);
+            }
+            if (hasField(mask, Field::Month)) {
+                __m256i month = _mm256_sub_epi32(_mm256_add_epi32(mp, _mm256_set1_epi32(3)),
+                                                 _mm256_and_si256(janFeb, _mm256_set1_epi32(12)));
+                storeBytes(out.month + i, month);
+            }
+            if (hasField(mask, Field::Day)) {
+                __m256i monthStart = floorDivSmall(_mm256_add_epi32(_mm256_mullo_epi32(mp, _mm256_set1_epi32(153)),
+                                                                    _mm256_set1_epi32(2)), 5.0f);
+                storeBytes(out.day + i, _mm256_add_epi32(_mm256_sub_epi32(doy, monthStart), one));
+            }
+            if (hasField(mask, Field::DayOfYear)) {
+                // 一、二月：doy - 305；三月起：doy + 60 + 闰年 
+                __m256i century = floorDivSmall(year, 100.0f);
+                __m256i divisibleBy4 = _mm256_cmpeq_epi32(_mm256_and_si256(year, _mm256_set1_epi32(3)),
+                                                          _mm256_setzero_si256());
+                __m256i notCentury = _mm256_xor_si256(
+                    _mm256_cmpeq_epi32(_mm256_mullo_epi32(century, _mm256_set1_epi32(100)), year),
+                    _mm256_set1_epi32(-1));
+                __m256i divisibleBy400 = _mm256_and_si256(
+                    _mm256_cmpeq_epi32(_mm256_and_si256(century, _mm256_set1_epi32(3)), _mm256_setzero_si256()),
+                    _mm256_xor_si256(notCentury, _mm256_set1_epi32(-1)));
+                __m256i leap = _mm256_and_si256(_mm256_and_si256(divisibleBy4, _mm256_or_si256(notCentury, divisibleBy400)),
+                                                one);
+                __m256i marchOnward = _mm256_add_epi32(doy, _mm256_add_epi32(_mm256_set1_epi32(60), leap));
+                __m256i dayOfYear = _mm256_blendv_epi8(marchOnward, _mm256_sub_epi32(doy, _mm256_set1_epi32(305)),
+                                                       janFeb);
+                storeShorts(out.dayOfYear + i, dayOfYear);
+            }
+        }
+        if (hasField(mask, Field::Time)) {
+            __m256i hour = floorDivSmall(sod, 3600.0f);
+            __m256i rest = _mm256_sub_epi32(sod, _mm256_mullo_epi32(hour, _mm256_set1_epi32(3600)));
+            __m256i minute = floorDivSmall(rest, 60.0f);
+            if (hasField(mask, Field::Hour)) {
+                storeBytes(out.hour + i, hour);
+            }
+            if (hasField(mask, Field::Minute)) {
+                storeBytes(out.minute + i, minute);
+            }
+            if (hasField(mask, Field::Second)) {
+                storeBytes(out.second + i, _mm256_sub_epi32(rest, _mm256_mullo_epi32(minute, _mm256_set1_epi32(60))));
+            }
+        }
+        if (hasField(mask, Field::Weekday)) {
+            // 1970-01-01 为星期四 
+            __m256i shifted = _mm256_add_epi32(days, _mm256_set1_epi32(4));
+            __m256i weekday = _mm256_sub_epi32(shifted, _mm256_mullo_epi32(floorDivSmall(shifted, 7.0f),
+                                                                           _mm256_set1_epi32(7)));
+            storeBytes(out.weekday + i, weekday);
+        }
+        valid += 8;
+    }
+    return valid + extractFieldsScalar(epochs, i, n, mask, out);
+}
+
+#endif // DATETIME_X86_DISPATCH
+
+SimdLevel detectSimdLevel() {
+#ifdef DATETIME_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::Avx2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return SimdLevel::Sse42;
+    }
+#endif
+    return SimdLevel::Scalar;
+}
+
+// 批量运算的元素访问：秒数列带无效值，PackedDateTime 没有 
+inline int64_t& raw(int64_t& value) {
+    return value;
+}
+
+inline int64_t raw(const int64_t& value) {
+    return value;
+}
+
+inline int64_t& raw(PackedDateTime& value) {
+    return value.nanos;
+}
+
+inline int64_t raw(const PackedDateTime& value) {
+    return value.nanos;
+}
+
+inline bool invalid(int64_t value) {
+    return value == kInvalidEpoch;
+}
+
+inline bool invalid(const PackedDateTime&) {
+    return false;
+}
+
+// 二进制补码回绕的加减，避免有符号溢出 
+inline int64_t wrappingAdd(int64_t a, int64_t b) {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+}
+
+inline int64_t wrappingSub(int64_t a, int64_t b) {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b));
+}
+
+// 每个线程至少处理的元素数，低于此规模时线程开销超过收益 
+const size_t kParallelChunk = 1 << 16;
+
+// Parallel 时使用的线程数；规模较小时为 1 
+inline size_t parallelThreads(size_t n, Execution execution) {
+    if (execution != Execution::Parallel) {
+        return 1;
+    }
+    return std::max<size_t>(1, std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()),
+                                                n / kParallelChunk));
+}
+
+// 把 [0, n) 分成至多 threads 个连续的块，各自在一个线程中执行 body(index, begin, end)；调用线程处理第一块 
+// 相同的 n 与 threads 总是得到相同的块，可以分几轮处理同一组块 
+template <class Body>
+void forEachChunkIndexed(size_t n, size_t threads, Body body) {
+    if (threads <= 1) {
+        body(static_cast<size_t>(0), static_cast<size_t>(0), n);
+        return;
+    }
+    // 块边界按 8 个元素对齐，相邻线程不共享缓存行 
+    size_t chunk = ((n + threads - 1) / threads + 7) & ~static_cast<size_t>(7);
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (size_t begin = chunk; begin < n; begin += chunk) {
+        workers.emplace_back(body, begin / chunk, begin, std::min(n, begin + chunk));
+    }
+    body(static_cast<size_t>(0), static_cast<size_t>(0), std::min(n, chunk));
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+// 把 [0, n) 分成连续的块执行 body(begin, end)；调用线程处理第一块 
+template <class Body>
+void forEachChunk(size_t n, Execution execution, Body body) {
+    forEachChunkIndexed(n, parallelThreads(n, execution), [body](size_t, size_t begin, size_t end) {
+        body(begin, end);
+    });
+}
+
+template <class T>
+void addKernel(T* values, size_t begin, size_t end, int64_t delta) {
+    for (size_t i = begin; i < end; ++i) {
+        int64_t value = raw(values[i]);
+        raw(values[i]) = invalid(values[i]) ? value : wrappingAdd(value, delta);
+    }
+}
+
+template <class T>
+void differenceKernel(const T* a, const T* b, size_t begin, size_t end, int64_t* out) {
+    for (size_t i = begin; i < end; ++i) {
+        bool bad = invalid(a[i]) || invalid(b[i]);
+        int64_t diff = wrappingSub(raw(a[i]), raw(b[i]));
+        out[i] = bad ? kInvalidEpoch : diff;
+    }
+}
+
+// 秒数列超出 extractFields 范围的行无法分解出 int 年份 
+inline bool calendarRange(int64_t value) {
+    return value >= -kMaxFieldEpoch && value <= kMaxFieldEpoch;
+}
+
+inline bool calendarRange(const PackedDateTime&) {
+    return true;
+}
+
+// apply 为 false 时只统计溢出的行数，不修改数据；秒数列超出范围的行写入 kInvalidEpoch 
+template <class T>
+size_t addMonthsKernel(T* values, size_t begin, size_t end, long long months, int64_t ticksPerDay,
+                       MonthOverflow overflow, bool apply) {
+    size_t overflowed = 0;
+    for (size_t i = begin; i < end; ++i) {
+        if (invalid(values[i])) {
+            continue;
+        }
+        if (!calendarRange(values[i])) {
+            if (apply) {
+                raw(values[i]) = kInvalidEpoch;
+            }
+            continue;
+        }
+        int64_t value = raw(values[i]);
+        long long days = civil::detail::floorDiv(value, ticksPerDay);
+        bool over = false;
+        long long shifted = civil::addMonthsToDays(days, months, overflow, over);
+        overflowed += over ? 1 : 0;
+        if (apply) {
+            uint64_t delta = static_cast<uint64_t>(shifted - days) * static_cast<uint64_t>(ticksPerDay);
+            raw(values[i]) = wrappingAdd(value, static_cast<int64_t>(delta));
+        }
+    }
+    return overflowed;
+}
+
+// Throw 时先检查整列，有溢出就在修改任何数据之前抛出 
+template <class T>
+size_t addMonthsColumn(T* values, size_t n, long long months, int64_t ticksPerDay, MonthOverflow overflow,
+                       Execution execution) {
+    std::atomic<size_t> overflowed(0);
+    if (overflow == MonthOverflow::Throw) {
+        forEachChunk(n, execution, [&](size_t begin, size_t end) {
+            overflowed += addMonthsKernel(values, begin, end, months, ticksPerDay, overflow, false);
+        });
+        if (overflowed.load() != 0) {
+            DATETIME_THROW("Day does not exist in the target month");
+        }
+    }
+    forEachChunk(n, execution, [&](size_t begin, size_t end) {
+        overflowed += addMonthsKernel(values, begin, end, months, ticksPerDay, overflow, true);
+    });
+    return overflowed.load();
+}
+
+// 定长单位：除数为编译期常量，编译器把除法换成乘法与移位 
+template <int64_t Unit, civil::Rounding Mode, class T>
+void roundKernel(T* values, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        int64_t value = raw(values[i]);
+        int64_t remainder = value % Unit;
+        remainder += remainder < 0 ? Unit : 0;
+        int64_t step = Mode == civil::Rounding::Floor ? 0
+                     : Mode == civil::Rounding::Ceil ? (remainder != 0 ? Unit : 0)
+                     : (remainder * 2 >= Unit ? Unit : 0);
+        raw(values[i]) = invalid(values[i]) ? value : value - remainder + step;
+    }
+}
+
+template <int64_t Unit, civil::Rounding Mode, class T>
+void roundFixed(T* values, size_t n, Execution execution) {
+    forEachChunk(n, execution, [values](size_t begin, size_t end) { roundKernel<Unit, Mode>(values, begin, end); });
+}
+
+// 周与日历单位逐元素走 civil 算法 
+template <class T>
+void roundCalendar(T* values, size_t n, int64_t ticksPerSecond, TimeUnit unit, civil::Rounding mode,
+                   Execution execution) {
+    forEachChunk(n, execution, [=](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (!invalid(values[i])) {
+                raw(values[i]) = civil::roundTicks(raw(values[i]), ticksPerSecond, unit, mode);
+            }
+        }
+    });
+}
+
+template <civil::Rounding Mode>
+void roundEpochs(int64_t* epochs, size_t n, TimeUnit unit, Execution execution) {
+    switch (unit) {
+    case TimeUnit::Nanosecond:
+    case TimeUnit::Microsecond:
+    case TimeUnit::Millisecond:
+    case TimeUnit::Second: break;
+    case TimeUnit::Minute: roundFixed<60, Mode>(epochs, n, execution); break;
+    case TimeUnit::Hour: roundFixed<3600, Mode>(epochs, n, execution); break;
+    case TimeUnit::Day: roundFixed<86400, Mode>(epochs, n, execution); break;
+    case TimeUnit::Week:
+    case TimeUnit::Month:
+    case TimeUnit::Quarter:
+    case TimeUnit::Year: roundCalendar(epochs, n, 1, unit, Mode, execution); break;
+    }
+}
+
+template <civil::Rounding Mode>
+void roundPacked(PackedDateTime* values, size_t n, TimeUnit unit, Execution execution) {
+    switch (unit) {
+    case TimeUnit::Nanosecond: break;
+    case TimeUnit::Microsecond: roundFixed<1000LL, Mode>(values, n, execution); break;
+    case TimeUnit::Millisecond: roundFixed<1000000LL, Mode>(values, n, execution); break;
+    case TimeUnit::Second: roundFixed<1000000000LL, Mode>(values, n, execution); break;
+    case TimeUnit::Minute: roundFixed<60000000000LL, Mode>(values, n, execution); break;
+    case TimeUnit::Hour: roundFixed<3600000000000LL, Mode>(values, n, execution); break;
+    case TimeUnit::Day: roundFixed<86400000000000LL, Mode>(values, n, execution); break;
+    case TimeUnit::Week:
+    case TimeUnit::Month:
+    case TimeUnit::Quarter:
+    case TimeUnit::Year: roundCalendar(values, n, 1000000000LL, unit, Mode, execution); break;
+    }
+}
+
+// 排序键：翻转符号位后按无符号整数比较，与有符号比较的顺序一致；kInvalidEpoch 排在最前 
+inline uint64_t radixKey(int64_t value) {
+    return static_cast<uint64_t>(value) ^ (1ULL << 63);
+}
+
+inline uint64_t radixKey(const PackedDateTime& value) {
+    return radixKey(value.nanos);
+}
+
+inline int64_t timeTicks(const DateTime& dt) {
+    return static_cast<int64_t>(dt.getTimePoint().time_since_epoch().count());
+}
+
+inline uint64_t radixKey(const DateTime& value) {
+    return radixKey(timeTicks(value));
+}
+
+// 对象较大时（如定义了 DATETIME_CACHE_FIELDS）排序的是 (键, 行号)，最后按行号重排一次对象 
+struct KeyedRow {
+    uint64_t key;
+    size_t row;
+};
+
+inline uint64_t radixKey(const KeyedRow& value) {
+    return value.key;
+}
+
+// 每遍至多 11 位：直方图与各桶的写入位置仍能留在一级、二级缓存中 
+const int kRadixMaxBits = 11;
+const int kRadixMaxPasses = (64 + kRadixMaxBits - 1) / kRadixMaxBits;
+const size_t kRadixMaxBuckets = size_t(1) << kRadixMaxBits;
+// 低于此规模时直方图与额外缓冲区的开销超过收益，改用比较排序 
+const size_t kRadixMinRows = 256;
+
+// 键先减去最小值、再去掉所有行共有的低位（如纳秒计数中恒为 0 的部分），只对剩下的有效位分遍 
+struct RadixLayout {
+    uint64_t base;
+    int shift;
+    int bits;    // 每遍的位数
+    int passes;
+
+    size_t digit(uint64_t key, int pass) const {
+        return static_cast<size_t>(((key - base) >> (shift + pass * bits)) & ((uint64_t(1) << bits) - 1));
+    }
+};
+
+struct KeySpan {
+    uint64_t low;
+    uint64_t high;
+    uint64_t differing;  // 与第一行的键不同的位
+};
+
+template <class T>
+RadixLayout radixLayout(const T* values, size_t n, size_t threads) {
+    std::vector<KeySpan> spans(threads, KeySpan{ ~uint64_t(0), 0, 0 });
+    uint64_t first = radixKey(values[0]);
+    forEachChunkIndexed(n, threads, [values, first, &spans](size_t chunk, size_t begin, size_t end) {
+        KeySpan span = spans[chunk];
+        for (size_t i = begin; i < end; ++i) {
+            uint64_t key = radixKey(values[i]);
+            span.low = std::min(span.low, key);
+            span.high = std::max(span.high, key);
+            span.differing |= key ^ first;
+        }
+        spans[chunk] = span;
+    });
+    KeySpan total = spans[0];
+    for (const KeySpan& span : spans) {
+        total.low = std::min(total.low, span.low);
+        total.high = std::max(total.high, span.high);
+        total.differing |= span.differing;
+    }
+
+    RadixLayout layout = { total.low, 0, 0, 0 };
+    if (total.differing == 0) {
+        return layout;
+    }
+    while (((total.differing >> layout.shift) & 1) == 0) {
+        ++layout.shift;
+    }
+    uint64_t range = (total.high - total.low) >> layout.shift;
+    int significant = 0;
+    while (significant < 64 && (range >> significant) != 0) {
+        ++significant;
+    }
+    layout.passes = (significant + kRadixMaxBits - 1) / kRadixMaxBits;
+    layout.bits = (significant + layout.passes - 1) / layout.passes;
+    return layout;
+}
+
+// 每个块在每一遍上的直方图：counts[(chunk * kRadixMaxPasses + pass) * buckets + digit] 
+template <class T>
+void radixHistogram(const T* values, size_t begin, size_t end, const RadixLayout& layout, size_t* counts,
+                    int firstPass, int lastPass) {
+    size_t buckets = size_t(1) << layout.bits;
+    for (size_t i = begin; i < end; ++i) {
+        uint64_t key = radixKey(values[i]);
+        for (int pass = firstPass; pass < lastPass; ++pass) {
+            ++counts[pass * buckets + layout.digit(key, pass)];
+        }
+    }
+}
+
+// LSD 基数排序，稳定；遍数由键的有效位数决定（30 年跨度的秒数为 3 遍），所有行在某一遍上都相同时跳过该遍 
+// 并行时每一遍先由各块统计本块的直方图，按 (桶, 块) 的顺序求出写入位置后各块独立分发 
+template <class T>
+void radixSort(T* values, size_t n, Execution execution) {
+    if (n < kRadixMinRows) {
+        std::stable_sort(values, values + n, [](const T& a, const T& b) { return radixKey(a) < radixKey(b); });
+        return;
+    }
+    size_t threads = parallelThreads(n, execution);
+    RadixLayout layout = radixLayout(values, n, threads);
+    if (layout.passes == 0) {
+        return;
+    }
+    size_t buckets = size_t(1) << layout.bits;
+    size_t stride = kRadixMaxPasses * buckets;
+    std::vector<size_t> counts(threads * stride);
+    forEachChunkIndexed(n, threads, [values, &layout, &counts, stride](size_t chunk, size_t begin, size_t end) {
+        radixHistogram(values, begin, end, layout, &counts[chunk * stride], 0, layout.passes);
+    });
+
+    std::vector<T> buffer(n, values[0]);
+    T* source = values;
+    T* target = buffer.data();
+    bool firstScatter = true;
+    std::vector<size_t> offsets(threads * buckets);
+    for (int pass = 0; pass < layout.passes; ++pass) {
+        bool trivial = false;
+        for (size_t digit = 0; digit < buckets && !trivial; ++digit) {
+            size_t total = 0;
+            for (size_t chunk = 0; chunk < threads; ++chunk) {
+                total += counts[chunk * stride + pass * buckets + digit];
+            }
+            trivial = total == n;
+        }
+        if (trivial) {
+            continue;
+        }
+        // 单个块的直方图不随分发改变；多个块时，第一次分发之后各块的内容已经变了，需要重新统计 
+        if (threads > 1 && !firstScatter) {
+            forEachChunkIndexed(n, threads, [source, &layout, &counts, stride, buckets, pass](size_t chunk, size_t begin,
+                                                                                            size_t end) {
+                size_t* chunkCounts = &counts[chunk * stride];
+                std::fill(chunkCounts + pass * buckets, chunkCounts + (pass + 1) * buckets, 0);
+                radixHistogram(source, begin, end, layout, chunkCounts, pass, pass + 1);
+            });
+        }
+        size_t next = 0;
+        for (size_t digit = 0; digit < buckets; ++digit) {
+            for (size_t chunk = 0; chunk < threads; ++chunk) {
+                offsets[chunk * buckets + digit] = next;
+                next += counts[chunk * stride + pass * buckets + digit];
+            }
+        }
+        forEachChunkIndexed(n, threads, [source, target, &layout, &offsets, buckets, pass](size_t chunk, size_t begin,
+                                                                                         size_t end) {
+            size_t* offset = &offsets[chunk * buckets];
+            for (size_t i = begin; i < end; ++i) {
+                target[offset[layout.digit(radixKey(source[i]), pass)]++] = source[i];
+            }
+        });
+        std::swap(source, target);
+        firstScatter = false;
+    }
+    if (source != values) {
+        forEachChunk(n, execution, [source, values](size_t begin, size_t end) {
+            std::copy(source + begin, source + end, values + begin);
+        });
+    }
+}
+
+// DateTime 不超过 (键, 行号) 的 16 字节时直接分发对象，省去按行号重排的随机访问 
+inline void sortDateTimes(DateTime* values, size_t n, Execution execution, std::true_type) {
+    radixSort(values, n, execution);
+}
+
+inline void sortDateTimes(DateTime* values, size_t n, Execution execution, std::false_type) {
+    std::vector<KeyedRow> rows(n);
+    forEachChunk(n, execution, [values, &rows](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            rows[i].key = radixKey(values[i]);
+            rows[i].row = i;
+        }
+    });
+    radixSort(rows.data(), n, execution);
+    std::vector<DateTime> original(values, values + n);
+    forEachChunk(n, execution, [values, &rows, &original](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            values[i] = original[rows[i].row];
+        }
+    });
+}
+
+inline int64_t ticksOf(const int64_t& value) {
+    return value;
+}
+
+inline int64_t ticksOf(const PackedDateTime& value) {
+    return value.nanos;
+}
+
+inline int64_t ticksOf(const DateTime& value) {
+    return timeTicks(value);
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+#define DATETIME_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define DATETIME_PREFETCH(address) ((void)0)
+#endif
+
+// 无分支二分查找：每步只用条件传送更新起点，不产生难以预测的跳转；下一步的两个候选位置提前预取 
+template <class T>
+size_t branchlessLowerBound(const T* sorted, size_t n, int64_t key) {
+    if (n == 0) {
+        return 0;
+    }
+    const T* base = sorted;
+    size_t length = n;
+    while (length > 1) {
+        size_t half = length / 2;
+        DATETIME_PREFETCH(base + half / 2);
+        DATETIME_PREFETCH(base + half + half / 2);
+        base = ticksOf(base[half]) < key ? base + half : base;
+        length -= half;
+    }
+    return static_cast<size_t>(base - sorted) + (ticksOf(*base) < key ? 1 : 0);
+}
+
+
+inline RowRange rowRange(size_t begin, size_t end) {
+    RowRange range;
+    range.begin = begin;
+    range.end = std::max(begin, end);
+    return range;
+}
+
+// 按中序遍历把有序的第 i 行放到 BFS 位置 k；递归深度为树高 
+template <class T>
+size_t eytzingerFill(const T* sorted, size_t n, size_t i, size_t k, int64_t* keys) {
+    if (k <= n) {
+        i = eytzingerFill(sorted, n, i, 2 * k, keys);
+        keys[k] = raw(sorted[i]);
+        i = eytzingerFill(sorted, n, i + 1, 2 * k + 1, keys);
+    }
+    return i;
+}
+
+inline int floorLog2(size_t k) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(static_cast<unsigned long long>(k));
+#else
+    int log = 0;
+    while (k >>= 1) {
+        ++log;
+    }
+    return log;
+#endif
+}
+
+// BFS 位置 k 在有序列中的行号：先求它在高为 height 的满二叉树中的中序位置， 
+// 再减去排在它前面、最后一层缺失的叶子（最后一层只有左起 lastLevel 个结点） 
+inline size_t eytzingerRow(size_t k, int height, size_t lastLevel) {
+    int depth = floorLog2(k);
+    size_t column = k - (size_t(1) << depth);
+    size_t rank = ((2 * column + 1) << (height - depth)) - 1;
+    size_t leavesBefore = (rank + 1) / 2;
+    return rank - (leavesBefore > lastLevel ? leavesBefore - lastLevel : 0);
+}
+
+} // namespace column
+} // namespace
+
+DATETIME_INLINE SimdLevel simdLevel() {
+    static const SimdLevel level = column::detectSimdLevel();
+    return level;
+}
+
+DATETIME_INLINE const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Avx2: return "avx2";
+    case SimdLevel::Sse42: return "sse4.2";
+    case SimdLevel::Scalar: break;
+    }
+    return "scalar";
+}
+
+DATETIME_INLINE size_t parseColumn(const char* base, size_t stride, size_t n, int64_t* outEpoch) {
+    return parseColumn(base, stride, n, outEpoch, simdLevel());
+}
+
+DATETIME_INLINE size_t parseColumn(const char* base, size_t stride, size_t n, int64_t* outEpoch, SimdLevel level) {
+    if (stride < 19) {
+        for (size_t i = 0; i < n; ++i) {
+            outEpoch[i] = kInvalidEpoch;
+        }
+        return 0;
+    }
+    if (static_cast<int>(level) > static_cast<int>(simdLevel())) {
+        level = simdLevel();
+    }
+
+#ifdef DATETIME_X86_DISPATCH
+    switch (level) {
+    case SimdLevel::Avx2: return column::parseColumnAvx2(base, stride, n, outEpoch);
+    case SimdLevel::Sse42: return column::parseColumnSse42(base, stride, n, outEpoch);
+    case SimdLevel::Scalar: break;
+    }
+#endif
+    return column::parseColumnScalar(base, stride, n, outEpoch);
+}
+
+DATETIME_INLINE size_t formatColumn(const int64_t* epochs, size_t n, char* out, size_t stride, const FormatSpec& spec) {
+    return formatColumn(epochs, n, out, stride, spec, simdLevel());
+}
+
+DATETIME_INLINE size_t formatColumn(const int64_t* epochs, size_t n, char* out, size_t stride, const FormatSpec& spec,
+                    SimdLevel level) {
+    column::FixedLayout layout = { ' ', "", 19 };
+    switch (spec.layout()) {
+    case FormatSpec::DateTimeLayout: break;
+    case FormatSpec::Iso8601: layout.separator = 'T'; break;
+    case FormatSpec::Rfc3339: layout = { 'T', "+00:00", 25 }; break;
+    case FormatSpec::Generic: layout.width = 0; break;
+    }
+
+    if (layout.width == 0 || stride < layout.width) {
+        // 通用格式逐行格式化；超出 system_clock 范围的时间戳无法构造 DateTime 
+        typedef std::chrono::duration<long long> LongSeconds;
+        const long long limit = std::chrono::duration_cast<LongSeconds>(
+            std::chrono::system_clock::duration::max()).count();
+
+        size_t written = 0;
+        for (size_t i = 0; i < n; ++i) {
+            char* row = out + i * stride;
+            column::blankRow(row, stride);
+            if (epochs[i] == kInvalidEpoch || epochs[i] <= -limit || epochs[i] >= limit) {
+                continue;
+            }
+            char buffer[256];
+            size_t length = DateTime(static_cast<time_t>(epochs[i])).toUtc().formatTo(buffer, sizeof(buffer), spec);
+            if (length == 0 || length > stride) {
+                continue;
+            }
+            std::memcpy(row, buffer, length);
+            ++written;
+        }
+        return written;
+    }
+
+    if (static_cast<int>(level) > static_cast<int>(simdLevel())) {
+        level = simdLevel();
+    }
+
+#ifdef DATETIME_X86_DISPATCH
+    switch (level) {
+    case SimdLevel::Avx2: return column::formatColumnAvx2(epochs, n, out, stride, layout);
+    case SimdLevel::Sse42: return column::formatColumnSse42(epochs, n, out, stride, layout);
+    case SimdLevel::Scalar: break;
+    }
+#endif
+    return column::formatColumnScalar(epochs, n, out, stride, layout);
+}
+
+DATETIME_INLINE size_t extractFields(const int64_t* epochs, size_t n, Field mask, const ColumnOut& out) {
+    return extractFields(epochs, n, mask, out, simdLevel());
+}
+
+DATETIME_INLINE size_t extractFields(const int64_t* epochs, size_t n, Field mask, const ColumnOut& out,
+                                     SimdLevel level) {
+    if ((hasField(mask, Field::Year) && out.year == nullptr) ||
+        (hasField(mask, Field::Month) && out.month == nullptr) ||
+        (hasField(mask, Field::Day) && out.day == nullptr) ||
+        (hasField(mask, Field::Hour) && out.hour == nullptr) ||
+        (hasField(mask, Field::Minute) && out.minute == nullptr) ||
+        (hasField(mask, Field::Second) && out.second == nullptr) ||
+        (hasField(mask, Field::Weekday) && out.weekday == nullptr) ||
+        (hasField(mask, Field::DayOfYear) && out.dayOfYear == nullptr)) {
+        DATETIME_THROW("extractFields: missing output column for requested field");
+    }
+    if (static_cast<int>(level) > static_cast<int>(simdLevel())) {
+        level = simdLevel();
+    }
+#ifdef DATETIME_X86_DISPATCH
+    if (level == SimdLevel::Avx2) {
+        return column::extractFieldsAvx2(epochs, n, mask, out);
+    }
+#endif
+    return column::extractFieldsScalar(epochs, 0, n, mask, out);
+}
+
+DATETIME_INLINE void addSeconds(int64_t* epochs, size_t n, int64_t seconds, Execution execution) {
+    column::forEachChunk(n, execution, [epochs, seconds](size_t begin, size_t end) {
+        column::addKernel(epochs, begin, end, seconds);
+    });
+}
+
+DATETIME_INLINE void addDuration(PackedDateTime* values, size_t n, std::chrono::nanoseconds delta,
+                                 Execution execution) {
+    int64_t nanos = static_cast<int64_t>(delta.count());
+    column::forEachChunk(n, execution, [values, nanos](size_t begin, size_t end) {
+        column::addKernel(values, begin, end, nanos);
+    });
+}
+
+DATETIME_INLINE void difference(const int64_t* a, const int64_t* b, size_t n, int64_t* out, Execution execution) {
+    column::forEachChunk(n, execution, [a, b, out](size_t begin, size_t end) {
+        column::differenceKernel(a, b, begin, end, out);
+    });
+}
+
+DATETIME_INLINE void difference(const PackedDateTime* a, const PackedDateTime* b, size_t n, int64_t* outNanoseconds,
+                                Execution execution) {
+    column::forEachChunk(n, execution, [a, b, outNanoseconds](size_t begin, size_t end) {
+        column::differenceKernel(a, b, begin, end, outNanoseconds);
+    });
+}
+
+DATETIME_INLINE size_t addMonths(int64_t* epochs, size_t n, int months, MonthOverflow overflow,
+                                 Execution execution) {
+    return column::addMonthsColumn(epochs, n, months, 86400, overflow, execution);
+}
+
+DATETIME_INLINE size_t addMonths(PackedDateTime* values, size_t n, int months, MonthOverflow overflow,
+                                 Execution execution) {
+    return column::addMonthsColumn(values, n, months, 86400000000000LL, overflow, execution);
+}
+
+DATETIME_INLINE size_t addYears(int64_t* epochs, size_t n, int years, MonthOverflow overflow, Execution execution) {
+    return column::addMonthsColumn(epochs, n, years * 12LL, 86400, overflow, execution);
+}
+
+DATETIME_INLINE size_t addYears(PackedDateTime* values, size_t n, int years, MonthOverflow overflow,
+                                Execution execution) {
+    return column::addMonthsColumn(values, n, years * 12LL, 86400000000000LL, overflow, execution);
+}
+
+DATETIME_INLINE void truncateTo(int64_t* epochs, size_t n, TimeUnit unit, Execution execution) {
+    column::roundEpochs<civil::Rounding::Floor>(epochs, n, unit, execution);
+}
+
+DATETIME_INLINE void truncateTo(PackedDateTime* values, size_t n, TimeUnit unit, Execution execution) {
+    column::roundPacked<civil::Rounding::Floor>(values, n, unit, execution);
+}
+
+DATETIME_INLINE void ceilTo(int64_t* epochs, size_t n, TimeUnit unit, Execution execution) {
+    column::roundEpochs<civil::Rounding::Ceil>(epochs, n, unit, execution);
+}
+
+DATETIME_INLINE void ceilTo(PackedDateTime* values, size_t n, TimeUnit unit, Execution execution) {
+    column::roundPacked<civil::Rounding::Ceil>(values, n, unit, execution);
+}
+
+DATETIME_INLINE void roundTo(int64_t* epochs, size_t n, TimeUnit unit, Execution execution) {
+    column::roundEpochs<civil::Rounding::Nearest>(epochs, n, unit, execution);
+}
+
+DATETIME_INLINE void roundTo(PackedDateTime* values, size_t n, TimeUnit unit, Execution execution) {
+    column::roundPacked<civil::Rounding::Nearest>(values, n, unit, execution);
+}
+
+DATETIME_INLINE void sortTimes(int64_t* epochs, size_t n, Execution execution) {
+    column::radixSort(epochs, n, execution);
+}
+
+DATETIME_INLINE void sortTimes(PackedDateTime* values, size_t n, Execution execution) {
+    column::radixSort(values, n, execution);
+}
+
+DATETIME_INLINE void sortTimes(DateTime* values, size_t n, Execution execution) {
+    column::sortDateTimes(values, n, execution, std::integral_constant<bool, sizeof(DateTime) <= 16>());
+}
+
+DATETIME_INLINE size_t lowerBoundTime(const int64_t* sorted, size_t n, int64_t epoch) {
+    return column::branchlessLowerBound(sorted, n, epoch);
+}
+
+DATETIME_INLINE size_t lowerBoundTime(const PackedDateTime* sorted, size_t n, PackedDateTime t) {
+    return column::branchlessLowerBound(sorted, n, t.nanos);
+}
+
+DATETIME_INLINE size_t lowerBoundTime(const DateTime* sorted, size_t n, const DateTime& t) {
+    return column::branchlessLowerBound(sorted, n, column::timeTicks(t));
+}
+
+DATETIME_INLINE RowRange rangeQuery(const int64_t* sorted, size_t n, int64_t from, int64_t to) {
+    return column::rowRange(lowerBoundTime(sorted, n, from), lowerBoundTime(sorted, n, to));
+}
+
+DATETIME_INLINE RowRange rangeQuery(const PackedDateTime* sorted, size_t n, PackedDateTime from, PackedDateTime to) {
+    return column::rowRange(lowerBoundTime(sorted, n, from), lowerBoundTime(sorted, n, to));
+}
+
+DATETIME_INLINE RowRange rangeQuery(const DateTime* sorted, size_t n, const DateTime& from, const DateTime& to) {
+    return column::rowRange(lowerBoundTime(sorted, n, from), lowerBoundTime(sorted, n, to));
+}
+
+DATETIME_INLINE EytzingerIndex::EytzingerIndex() : keys_(1), height_(0), lastLevel_(0) {}
+
+DATETIME_INLINE EytzingerIndex::EytzingerIndex(const int64_t* sorted, size_t n)
+    : keys_(n + 1), height_(n == 0 ? 0 : column::floorLog2(n)),
+      lastLevel_(n == 0 ? 0 : n - ((size_t(1) << height_) - 1)) {
+    column::eytzingerFill(sorted, n, 0, 1, keys_.data());
+}
+
+DATETIME_INLINE EytzingerIndex::EytzingerIndex(const PackedDateTime* sorted, size_t n)
+    : keys_(n + 1), height_(n == 0 ? 0 : column::floorLog2(n)),
+      lastLevel_(n == 0 ? 0 : n - ((size_t(1) << height_) - 1)) {
+    column::eytzingerFill(sorted, n, 0, 1, keys_.data());
+}
+
+DATETIME_INLINE size_t EytzingerIndex::lowerBound(int64_t key) const {
+    size_t n = size();
+    const int64_t* keys = keys_.data();
+    size_t k = 1;
+    while (k <= n) {
+        // 四层之后的 16 个后代在内存中相邻，提前取入缓存 
+        DATETIME_PREFETCH(keys + std::min(16 * k, n));
+        k = 2 * k + (keys[k] < key ? 1 : 0);
+    }
+    // 去掉最后一串向右的步，回到最后一次向左时所在的结点 
+    while ((k & 1) != 0) {
+        k >>= 1;
+    }
+    k >>= 1;
+    return k == 0 ? n : column::eytzingerRow(k, height_, lastLevel_);
+}
+
+DATETIME_INLINE RowRange EytzingerIndex::range(int64_t from, int64_t to) const {
+    return column::rowRange(lowerBound(from), lowerBound(to));
+}
+
+} // namespace datetime
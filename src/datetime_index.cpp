@@ -0,0 +1,470 @@
+#include "datetime_index.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifndef DATETIME_PREFETCH
+#if defined(__GNUC__) || defined(__clang__)
+#define DATETIME_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define DATETIME_PREFETCH(address) ((void)0)
+#endif
+#endif
+
+namespace datetime {
+
+namespace detail {
+
+// 索引镜像布局（本机字节序，偏移均相对文件开头并按 8 字节对齐）： 
+// TimeIndexImageHeader | TimeIndexBlock[blockCount] | 打包数据 uint64_t[wordCount] | 顶层索引 int64_t[groupCount] | 未满块 int64_t[tailCount] 
+// 顶层索引的项数由块数决定，不另存 
+struct TimeIndexImageHeader {
+    char magic[8];             // "DTIDX1\0\0"
+    uint32_t byteOrder;        // 写入 0x01020304，用来拒绝其他字节序生成的镜像
+    uint32_t blockRows;        // 须与 TimeIndex::kBlockRows 相同
+    uint64_t blockCount;
+    uint64_t wordCount;
+    uint64_t tailCount;
+    uint64_t blocksOffset;
+    uint64_t wordsOffset;
+    uint64_t groupsOffset;
+    uint64_t tailOffset;
+    uint64_t totalSize;
+};
+
+static_assert(sizeof(TimeIndexImageHeader) == 80, "TimeIndexImageHeader must not contain padding");
+
+} // namespace detail
+
+namespace {
+// 仅头文件模式下与其他源文件位于同一翻译单元，辅助函数放在独立的命名空间中避免重名 
+namespace timeindex {
+
+const char kImageMagic[8] = { 'D', 'T', 'I', 'D', 'X', '1', '\0', '\0' };
+const uint32_t kImageByteOrder = 0x01020304u;
+
+// [offset, offset + count * elementSize) 是否落在镜像内，避免乘法溢出 
+inline bool fitsInImage(uint64_t offset, uint64_t count, size_t elementSize, size_t imageSize) {
+    return offset <= imageSize && count <= (imageSize - offset) / elementSize;
+}
+
+// 一个块的打包数据占用的字数，末尾多留的一个字让解码总能读取相邻的两个字 
+inline uint64_t blockWords(unsigned bits) {
+    return (static_cast<uint64_t>(TimeIndex::kBlockRows) * bits + 63) / 64 + 1;
+}
+
+inline size_t groupCountFor(size_t blockCount) {
+    return (blockCount + TimeIndex::kBlocksPerGroup - 1) / TimeIndex::kBlocksPerGroup;
+}
+
+// 块内第 offset 行打包的值（与最小值之差除以 scale），bits 须大于 0 
+inline uint64_t unpack(const uint64_t* words, unsigned bits, size_t offset) {
+    uint64_t position = static_cast<uint64_t>(offset) * bits;
+    const uint64_t* word = words + (position >> 6);
+    unsigned bit = static_cast<unsigned>(position & 63);
+    // 分两次移位，bit 为 0 时不会出现移动 64 位的未定义行为 
+    uint64_t value = (word[0] >> bit) | ((word[1] << 1) << (63 - bit));
+    return value & (~0ULL >> (64 - bits));
+}
+
+inline uint64_t gcd(uint64_t a, uint64_t b) {
+    while (b != 0) {
+        uint64_t r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+} // namespace timeindex
+} // namespace
+
+// 映射的索引镜像；析构时解除映射 
+struct TimeIndex::Mapping {
+    const char* base = nullptr;
+    size_t size = 0;
+    const detail::TimeIndexBlock* blocks = nullptr;
+    size_t blockCount = 0;
+    const uint64_t* words = nullptr;
+    size_t wordCount = 0;
+    const int64_t* groups = nullptr;
+
+    Mapping() = default;
+    Mapping(const Mapping&) = delete;
+    Mapping& operator=(const Mapping&) = delete;
+
+    ~Mapping() {
+        if (base == nullptr) {
+            return;
+        }
+#ifdef _WIN32
+        UnmapViewOfFile(base);
+#else
+        munmap(const_cast<char*>(base), size);
+#endif
+    }
+};
+
+DATETIME_INLINE TimeIndex::TimeIndex() {}
+
+DATETIME_INLINE size_t TimeIndex::blockCount() const {
+    return mapping_ ? mapping_->blockCount : blocks_.size();
+}
+
+DATETIME_INLINE const detail::TimeIndexBlock* TimeIndex::blocks() const {
+    return mapping_ ? mapping_->blocks : blocks_.data();
+}
+
+DATETIME_INLINE const uint64_t* TimeIndex::words() const {
+    return mapping_ ? mapping_->words : words_.data();
+}
+
+DATETIME_INLINE const int64_t* TimeIndex::groups() const {
+    return mapping_ ? mapping_->groups : groups_.data();
+}
+
+DATETIME_INLINE size_t TimeIndex::groupCount() const {
+    return timeindex::groupCountFor(blockCount());
+}
+
+DATETIME_INLINE size_t TimeIndex::memoryBytes() const {
+    size_t wordCount = mapping_ ? mapping_->wordCount : words_.size();
+    return blockCount() * sizeof(detail::TimeIndexBlock) + wordCount * sizeof(uint64_t) +
+           groupCount() * sizeof(int64_t) + tail_.size() * sizeof(int64_t);
+}
+
+DATETIME_INLINE int64_t TimeIndex::blockValue(const detail::TimeIndexBlock& block, size_t offset) const {
+    if (block.bits == 0) {
+        return block.min;
+    }
+    uint64_t difference = timeindex::unpack(words() + block.wordOffset, block.bits, offset) * block.scale;
+    return static_cast<int64_t>(static_cast<uint64_t>(block.min) + difference);
+}
+
+// 要求 block.min < t <= block.max；直接比较打包的差值，无分支二分查找 
+DATETIME_INLINE size_t TimeIndex::blockLowerBound(const detail::TimeIndexBlock& block, int64_t t) const {
+    if (block.bits == 0) {
+        return 0;
+    }
+    const uint64_t* words = this->words() + block.wordOffset;
+    unsigned bits = block.bits;
+    // 第一个打包值不小于 (t - min) / scale（向上取整）的行 
+    uint64_t difference = static_cast<uint64_t>(t) - static_cast<uint64_t>(block.min);
+    uint64_t target = difference / block.scale + (difference % block.scale != 0 ? 1 : 0);
+    size_t base = 0;
+    size_t length = kBlockRows;
+    while (length > 1) {
+        size_t half = length / 2;
+        DATETIME_PREFETCH(words + (base + half / 2) * bits / 64);
+        DATETIME_PREFETCH(words + (base + half + half / 2) * bits / 64);
+        base = timeindex::unpack(words, bits, base + half) < target ? base + half : base;
+        length -= half;
+    }
+    return base + (timeindex::unpack(words, bits, base) < target ? 1 : 0);
+}
+
+// 把满的 tail_ 压缩成一个块 
+DATETIME_INLINE void TimeIndex::seal() {
+    const int64_t* values = tail_.data();
+    detail::TimeIndexBlock block;
+    std::memset(&block, 0, sizeof(block));
+    block.min = values[0];
+    block.max = values[kBlockRows - 1];
+
+    // 公约数降到 1 后不必再算 
+    uint64_t scale = 0;
+    for (size_t i = 1; i < kBlockRows && scale != 1; ++i) {
+        scale = timeindex::gcd(static_cast<uint64_t>(values[i]) - static_cast<uint64_t>(block.min), scale);
+    }
+    unsigned bits = 0;
+    if (scale != 0) {
+        uint64_t span = (static_cast<uint64_t>(block.max) - static_cast<uint64_t>(block.min)) / scale;
+        while (bits < 64 && (span >> bits) != 0) {
+            ++bits;
+        }
+    }
+    block.bits = static_cast<uint8_t>(bits);
+    block.scale = scale;
+    block.wordOffset = words_.size();
+
+    if (bits != 0) {
+        words_.resize(words_.size() + timeindex::blockWords(bits), 0);
+        uint64_t* words = words_.data() + block.wordOffset;
+        for (size_t i = 0; i < kBlockRows; ++i) {
+            uint64_t value = (static_cast<uint64_t>(values[i]) - static_cast<uint64_t>(block.min)) / scale;
+            uint64_t position = static_cast<uint64_t>(i) * bits;
+            unsigned bit = static_cast<unsigned>(position & 63);
+            words[position >> 6] |= value << bit;
+            if (bit + bits > 64) {
+                words[(position >> 6) + 1] |= value >> (64 - bit);
+            }
+        }
+    }
+
+    blocks_.push_back(block);
+    size_t group = (blocks_.size() - 1) / kBlocksPerGroup;
+    if (group == groups_.size()) {
+        groups_.push_back(block.max);
+    } else {
+        groups_[group] = block.max;
+    }
+    tail_.clear();
+}
+
+// 映射的数据复制到内存后才能修改 
+DATETIME_INLINE void TimeIndex::detach() {
+    if (!mapping_) {
+        return;
+    }
+    const Mapping& mapping = *mapping_;
+    blocks_.assign(mapping.blocks, mapping.blocks + mapping.blockCount);
+    words_.assign(mapping.words, mapping.words + mapping.wordCount);
+    groups_.assign(mapping.groups, mapping.groups + timeindex::groupCountFor(mapping.blockCount));
+    mapping_.reset();
+}
+
+DATETIME_INLINE void TimeIndex::append(PackedDateTime t) {
+    append(&t, 1);
+}
+
+DATETIME_INLINE void TimeIndex::append(const DateTime& t) {
+    PackedDateTime packed = PackedDateTime::fromDateTime(t);
+    append(&packed, 1);
+}
+
+DATETIME_INLINE void TimeIndex::append(const PackedDateTime* values, size_t n) {
+    if (n == 0) {
+        return;
+    }
+    int64_t previous = !tail_.empty() ? tail_.back() : blockCount() != 0 ? blocks()[blockCount() - 1].max : values[0].nanos;
+    for (size_t i = 0; i < n; ++i) {
+        if (values[i].nanos < previous) {
+            DATETIME_THROW("TimeIndex rows must be appended in time order");
+        }
+        previous = values[i].nanos;
+    }
+
+    detach();
+    tail_.reserve(kBlockRows);
+    size_t i = 0;
+    while (i < n) {
+        size_t count = std::min(n - i, static_cast<size_t>(kBlockRows) - tail_.size());
+        for (size_t end = i + count; i < end; ++i) {
+            tail_.push_back(values[i].nanos);
+        }
+        if (tail_.size() == kBlockRows) {
+            seal();
+        }
+    }
+}
+
+DATETIME_INLINE PackedDateTime TimeIndex::at(size_t row) const {
+    if (row >= size()) {
+        DATETIME_THROW("TimeIndex row out of range");
+    }
+    size_t block = row / kBlockRows;
+    if (block < blockCount()) {
+        return PackedDateTime::fromNanoseconds(blockValue(blocks()[block], row % kBlockRows));
+    }
+    return PackedDateTime::fromNanoseconds(tail_[row - sealedRows()]);
+}
+
+DATETIME_INLINE void TimeIndex::read(RowRange rows, PackedDateTime* out) const {
+    if (rows.begin > rows.end || rows.end > size()) {
+        DATETIME_THROW("TimeIndex row out of range");
+    }
+    size_t row = rows.begin;
+    size_t sealed = std::min(rows.end, sealedRows());
+    const detail::TimeIndexBlock* blocks = this->blocks();
+    while (row < sealed) {
+        const detail::TimeIndexBlock& block = blocks[row / kBlockRows];
+        size_t end = std::min(sealed, (row / kBlockRows + 1) * kBlockRows);
+        for (; row < end; ++row) {
+            (out++)->nanos = blockValue(block, row % kBlockRows);
+        }
+    }
+    for (; row < rows.end; ++row) {
+        (out++)->nanos = tail_[row - sealedRows()];
+    }
+}
+
+DATETIME_INLINE size_t TimeIndex::lowerBound(PackedDateTime t) const {
+    int64_t key = t.nanos;
+    // 顶层索引：第一个最大值不早于 key 的组，所有块都早于 key 时只需查找未满的块 
+    size_t group = lowerBoundTime(groups(), groupCount(), key);
+    if (group == groupCount()) {
+        return sealedRows() + lowerBoundTime(tail_.data(), tail_.size(), key);
+    }
+
+    // 组内第一个最大值不早于 key 的块，前一块的最大值早于 key 
+    const detail::TimeIndexBlock* blocks = this->blocks();
+    size_t first = group * kBlocksPerGroup;
+    size_t last = std::min(first + kBlocksPerGroup, blockCount());
+    while (first < last) {
+        size_t middle = first + (last - first) / 2;
+        if (blocks[middle].max < key) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+    const detail::TimeIndexBlock& block = blocks[first];
+    if (key <= block.min) {
+        return first * kBlockRows;
+    }
+    return first * kBlockRows + blockLowerBound(block, key);
+}
+
+DATETIME_INLINE RowRange TimeIndex::range(PackedDateTime from, PackedDateTime to) const {
+    RowRange rows;
+    rows.begin = lowerBound(from);
+    rows.end = to <= from ? rows.begin : lowerBound(to);
+    return rows;
+}
+
+DATETIME_INLINE RowRange TimeIndex::range(const DateTime& from, const DateTime& to) const {
+    return range(PackedDateTime::fromDateTime(from), PackedDateTime::fromDateTime(to));
+}
+
+DATETIME_INLINE void TimeIndex::save(const std::string& path) const {
+    // 先写入同目录的临时文件再改名替换，不会原地截断仍被映射的旧文件 
+    std::vector<char> image(sizeof(detail::TimeIndexImageHeader));
+    auto append = [&image](const void* bytes, size_t length) -> uint64_t {
+        size_t offset = image.size();
+        if (length != 0) {
+            image.insert(image.end(), static_cast<const char*>(bytes), static_cast<const char*>(bytes) + length);
+        }
+        image.resize((image.size() + 7) & ~static_cast<size_t>(7));
+        return offset;
+    };
+
+    detail::TimeIndexImageHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, timeindex::kImageMagic, sizeof(header.magic));
+    header.byteOrder = timeindex::kImageByteOrder;
+    header.blockRows = static_cast<uint32_t>(kBlockRows);
+    header.blockCount = blockCount();
+    header.wordCount = mapping_ ? mapping_->wordCount : words_.size();
+    header.tailCount = tail_.size();
+    header.blocksOffset = append(blocks(), blockCount() * sizeof(detail::TimeIndexBlock));
+    header.wordsOffset = append(words(), header.wordCount * sizeof(uint64_t));
+    header.groupsOffset = append(groups(), groupCount() * sizeof(int64_t));
+    header.tailOffset = append(tail_.data(), tail_.size() * sizeof(int64_t));
+    header.totalSize = image.size();
+    std::memcpy(image.data(), &header, sizeof(header));
+
+    if (!detail::writeFileReplacing(path, image.data(), image.size())) {
+        DATETIME_THROW("Cannot write time index: " + path);
+    }
+}
+
+DATETIME_INLINE TimeIndex TimeIndex::openMapped(const std::string& path) {
+    std::shared_ptr<Mapping> mapping = std::make_shared<Mapping>();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        DATETIME_THROW("Cannot open time index: " + path);
+    }
+    LARGE_INTEGER fileSize;
+    HANDLE section = nullptr;
+    if (GetFileSizeEx(file, &fileSize) &&
+        fileSize.QuadPart >= static_cast<LONGLONG>(sizeof(detail::TimeIndexImageHeader))) {
+        section = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    CloseHandle(file);
+    if (section == nullptr) {
+        DATETIME_THROW("Cannot map time index: " + path);
+    }
+    const void* address = MapViewOfFile(section, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(section);
+    if (address == nullptr) {
+        DATETIME_THROW("Cannot map time index: " + path);
+    }
+    mapping->base = static_cast<const char*>(address);
+    mapping->size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        DATETIME_THROW("Cannot open time index: " + path);
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(detail::TimeIndexImageHeader))) {
+        ::close(fd);
+        DATETIME_THROW("Invalid time index: " + path);
+    }
+    void* address = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        DATETIME_THROW("Cannot map time index: " + path);
+    }
+    mapping->base = static_cast<const char*>(address);
+    mapping->size = static_cast<size_t>(status.st_size);
+#endif
+
+    const detail::TimeIndexImageHeader& header = *reinterpret_cast<const detail::TimeIndexImageHeader*>(mapping->base);
+    size_t size = mapping->size;
+    if (std::memcmp(header.magic, timeindex::kImageMagic, sizeof(header.magic)) != 0 ||
+        header.byteOrder != timeindex::kImageByteOrder || header.blockRows != kBlockRows ||
+        header.totalSize != size || header.tailCount >= kBlockRows ||
+        (header.blocksOffset | header.wordsOffset | header.groupsOffset | header.tailOffset) % 8 != 0 ||
+        !timeindex::fitsInImage(header.blocksOffset, header.blockCount, sizeof(detail::TimeIndexBlock), size) ||
+        !timeindex::fitsInImage(header.wordsOffset, header.wordCount, sizeof(uint64_t), size) ||
+        !timeindex::fitsInImage(header.groupsOffset, timeindex::groupCountFor(static_cast<size_t>(header.blockCount)),
+                                sizeof(int64_t), size) ||
+        !timeindex::fitsInImage(header.tailOffset, header.tailCount, sizeof(int64_t), size)) {
+        DATETIME_THROW("Invalid time index: " + path);
+    }
+    mapping->blocks = reinterpret_cast<const detail::TimeIndexBlock*>(mapping->base + header.blocksOffset);
+    mapping->blockCount = static_cast<size_t>(header.blockCount);
+    mapping->words = reinterpret_cast<const uint64_t*>(mapping->base + header.wordsOffset);
+    mapping->wordCount = static_cast<size_t>(header.wordCount);
+    mapping->groups = reinterpret_cast<const int64_t*>(mapping->base + header.groupsOffset);
+
+    // 逐块检查位宽、打包数据的范围与块的顺序，顶层索引须与各组最后一块的最大值一致： 
+    // 查找依赖这些不变量来保证不越过块目录，损坏的打包数据只会得到错误的结果，不会越界读取 
+    for (size_t i = 0; i < mapping->blockCount; ++i) {
+        const detail::TimeIndexBlock& block = mapping->blocks[i];
+        if (block.bits > 64 || block.min > block.max || (i != 0 && mapping->blocks[i - 1].max > block.min) ||
+            (block.bits != 0 && (block.scale == 0 || block.wordOffset > header.wordCount ||
+                                 timeindex::blockWords(block.bits) > header.wordCount - block.wordOffset))) {
+            DATETIME_THROW("Invalid time index: " + path);
+        }
+        if ((i + 1 == mapping->blockCount || (i + 1) % kBlocksPerGroup == 0) &&
+            mapping->groups[i / kBlocksPerGroup] != block.max) {
+            DATETIME_THROW("Invalid time index: " + path);
+        }
+    }
+
+    // 未满的块不足一块，复制到内存；同样须为非降序且不早于最后一块 
+    const int64_t* tail = reinterpret_cast<const int64_t*>(mapping->base + header.tailOffset);
+    for (size_t i = 0; i < header.tailCount; ++i) {
+        int64_t previous = i != 0 ? tail[i - 1]
+                                  : mapping->blockCount != 0 ? mapping->blocks[mapping->blockCount - 1].max : tail[0];
+        if (tail[i] < previous) {
+            DATETIME_THROW("Invalid time index: " + path);
+        }
+    }
+    TimeIndex index;
+    index.tail_.assign(tail, tail + header.tailCount);
+    index.mapping_ = mapping;
+    return index;
+}
+
+} // namespace datetime
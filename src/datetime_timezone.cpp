@@ -0,0 +1,954 @@
+#include "datetime_timezone.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace datetime {
+
+namespace detail {
+
+// POSIX TZ 规则中的切换日期：Jn（1-365，不计 2 月 29 日）、n（0-365）或 Mm.w.d 
+struct ZoneRuleDate {
+    char kind;       // 'J'、'N' 或 'M'
+    int month;
+    int week;        // 1-5，5 表示当月最后一个
+    int day;         // Jn/n 的序号，或 Mm.w.d 中的星期（0=Sunday）
+    int32_t time;    // 当地时间午夜后的秒数，可为负或超过 24 小时
+};
+
+struct PosixZoneRule {
+    int32_t standardOffset;  // 东正西负，与 TZif 一致
+    int32_t daylightOffset;
+    unsigned short standardAbbreviation;
+    unsigned short daylightAbbreviation;
+    bool hasDst;
+    ZoneRuleDate start;
+    ZoneRuleDate end;
+};
+
+// 时区镜像布局（本机字节序，偏移均相对文件开头并按 8 字节对齐）： 
+// ZoneImageHeader | ZoneImageEntry[zoneCount]（按名称排序） | 各时区的转换时刻、转换类型与本地时间类型 | 全部名称 
+// 名称集中放在末尾，二分查找只会触及目录和名称所在的少数几页 
+struct ZoneImageHeader {
+    char magic[8];             // "DTZDB1\0\0"
+    uint32_t byteOrder;        // 写入 0x01020304，用来拒绝其他字节序生成的镜像
+    uint32_t zoneCount;
+    uint64_t directoryOffset;
+    uint64_t totalSize;
+};
+
+struct ZoneImageType {
+    int32_t utcOffset;
+    int32_t isDst;
+    char abbreviation[8];      // 以 '\0' 结尾；驻留表的缩写最多 7 个字符
+};
+
+struct ZoneImageRuleDate {
+    int32_t kind;
+    int32_t month;
+    int32_t week;
+    int32_t day;
+    int32_t time;
+};
+
+struct ZoneImageRule {
+    int32_t standardOffset;
+    int32_t daylightOffset;
+    char standardAbbreviation[8];
+    char daylightAbbreviation[8];
+    int32_t hasDst;
+    ZoneImageRuleDate start;
+    ZoneImageRuleDate end;
+    int32_t reserved;
+};
+
+struct ZoneImageEntry {
+    uint64_t nameOffset;
+    uint64_t transitionsOffset;      // int64_t[transitionCount]
+    uint64_t transitionTypesOffset;  // uint8_t[transitionCount]
+    uint64_t typesOffset;            // ZoneImageType[typeCount]
+    uint32_t nameLength;
+    uint32_t transitionCount;
+    uint32_t typeCount;
+    uint32_t hasRule;
+    ZoneImageRule rule;
+};
+
+static_assert(sizeof(ZoneImageHeader) == 32, "ZoneImageHeader layout");
+static_assert(sizeof(ZoneImageType) == 16, "ZoneImageType layout");
+static_assert(sizeof(ZoneImageRule) == 72, "ZoneImageRule layout");
+static_assert(sizeof(ZoneImageEntry) == 120 && sizeof(ZoneImageEntry) % 8 == 0, "ZoneImageEntry layout");
+
+} // namespace detail
+
+namespace {
+// 仅头文件模式下与 datetime.cpp 位于同一翻译单元，辅助函数放在独立的命名空间中避免重名 
+namespace zone {
+
+class Reader {
+public:
+    Reader(const char* data, size_t length) : p_(data), end_(data + length) {}
+
+    bool skip(size_t count) {
+        if (static_cast<size_t>(end_ - p_) < count) {
+            return false;
+        }
+        p_ += count;
+        return true;
+    }
+
+    bool readBig32(int32_t& value) {
+        if (end_ - p_ < 4) {
+            return false;
+        }
+        const unsigned char* u = reinterpret_cast<const unsigned char*>(p_);
+        value = static_cast<int32_t>((static_cast<uint32_t>(u[0]) << 24) | (static_cast<uint32_t>(u[1]) << 16) |
+                                     (static_cast<uint32_t>(u[2]) << 8) | static_cast<uint32_t>(u[3]));
+        p_ += 4;
+        return true;
+    }
+
+    bool readBig64(int64_t& value) {
+        int32_t high = 0;
+        int32_t low = 0;
+        if (!readBig32(high) || !readBig32(low)) {
+            return false;
+        }
+        value = static_cast<int64_t>((static_cast<uint64_t>(static_cast<uint32_t>(high)) << 32) |
+                                     static_cast<uint32_t>(low));
+        return true;
+    }
+
+    bool readByte(unsigned char& value) {
+        if (p_ == end_) {
+            return false;
+        }
+        value = static_cast<unsigned char>(*p_++);
+        return true;
+    }
+
+    const char* position() const { return p_; }
+    const char* end() const { return end_; }
+
+private:
+    const char* p_;
+    const char* end_;
+};
+
+struct Header {
+    char version;
+    int32_t isutcnt;
+    int32_t isstdcnt;
+    int32_t leapcnt;
+    int32_t timecnt;
+    int32_t typecnt;
+    int32_t charcnt;
+};
+
+bool readHeader(Reader& reader, Header& header) {
+    const char* p = reader.position();
+    if (!reader.skip(20) || std::memcmp(p, "TZif", 4) != 0) {
+        return false;
+    }
+    header.version = p[4];
+    return reader.readBig32(header.isutcnt) && reader.readBig32(header.isstdcnt) &&
+           reader.readBig32(header.leapcnt) && reader.readBig32(header.timecnt) &&
+           reader.readBig32(header.typecnt) && reader.readBig32(header.charcnt) &&
+           header.isutcnt >= 0 && header.isstdcnt >= 0 && header.leapcnt >= 0 && header.timecnt >= 0 &&
+           header.typecnt > 0 && header.typecnt <= 256 && header.charcnt >= 0;
+}
+
+size_t bodySize(const Header& header, size_t timeSize) {
+    return static_cast<size_t>(header.timecnt) * (timeSize + 1) + static_cast<size_t>(header.typecnt) * 6 +
+           static_cast<size_t>(header.charcnt) + static_cast<size_t>(header.leapcnt) * (timeSize + 4) +
+           static_cast<size_t>(header.isstdcnt) + static_cast<size_t>(header.isutcnt);
+}
+
+bool isAlpha(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+bool isDigit(char c) {
+    return static_cast<unsigned>(c - '0') <= 9;
+}
+
+bool parseInt(const char*& p, const char* end, int maxValue, int& value) {
+    if (p == end || !isDigit(*p)) {
+        return false;
+    }
+    value = 0;
+    while (p != end && isDigit(*p)) {
+        value = value * 10 + (*p++ - '0');
+        if (value > maxValue) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 缩写：字母序列，或 <...> 中的字母、数字与正负号 
+bool parseAbbreviation(const char*& p, const char* end, const char*& name, size_t& length) {
+    if (p != end && *p == '<') {
+        name = ++p;
+        while (p != end && *p != '>') {
+            ++p;
+        }
+        if (p == end) {
+            return false;
+        }
+        length = static_cast<size_t>(p - name);
+        ++p;
+    } else {
+        name = p;
+        while (p != end && isAlpha(*p)) {
+            ++p;
+        }
+        length = static_cast<size_t>(p - name);
+    }
+    return length >= 3;
+}
+
+// [+-]hh[:mm[:ss]]，hh 不超过 maxHours 
+bool parseClock(const char*& p, const char* end, int maxHours, int32_t& seconds) {
+    int sign = 1;
+    if (p != end && (*p == '+' || *p == '-')) {
+        sign = *p++ == '-' ? -1 : 1;
+    }
+    int hours = 0;
+    int minutes = 0;
+    int secs = 0;
+    if (!parseInt(p, end, maxHours, hours)) {
+        return false;
+    }
+    if (p != end && *p == ':') {
+        ++p;
+        if (!parseInt(p, end, 59, minutes)) {
+            return false;
+        }
+        if (p != end && *p == ':') {
+            ++p;
+            if (!parseInt(p, end, 59, secs)) {
+                return false;
+            }
+        }
+    }
+    seconds = sign * (hours * 3600 + minutes * 60 + secs);
+    return true;
+}
+
+bool parseRuleDate(const char*& p, const char* end, detail::ZoneRuleDate& date) {
+    date.time = 2 * 3600;
+    date.month = 0;
+    date.week = 0;
+    if (p != end && *p == 'J') {
+        ++p;
+        date.kind = 'J';
+        if (!parseInt(p, end, 365, date.day) || date.day < 1) {
+            return false;
+        }
+    } else if (p != end && *p == 'M') {
+        ++p;
+        date.kind = 'M';
+        if (!parseInt(p, end, 12, date.month) || date.month < 1 || p == end || *p++ != '.' ||
+            !parseInt(p, end, 5, date.week) || date.week < 1 || p == end || *p++ != '.' ||
+            !parseInt(p, end, 6, date.day)) {
+            return false;
+        }
+    } else {
+        date.kind = 'N';
+        if (!parseInt(p, end, 365, date.day)) {
+            return false;
+        }
+    }
+    if (p != end && *p == '/') {
+        ++p;
+        return parseClock(p, end, 167, date.time);
+    }
+    return true;
+}
+
+// 解析 TZif 尾部的 POSIX TZ 串，如 "EST5EDT,M3.2.0,M11.1.0" 或 "<+0530>-5:30" 
+bool parsePosixRule(const char* p, const char* end, detail::PosixZoneRule& rule) {
+    const char* name = nullptr;
+    size_t length = 0;
+    int32_t offset = 0;
+    if (!parseAbbreviation(p, end, name, length) || !parseClock(p, end, 24, offset)) {
+        return false;
+    }
+    // POSIX 的偏移西正东负，与 TZif 相反 
+    rule.standardOffset = -offset;
+    rule.standardAbbreviation = detail::internZoneAbbreviation(name, length);
+    rule.hasDst = false;
+    if (p == end) {
+        return true;
+    }
+
+    if (!parseAbbreviation(p, end, name, length)) {
+        return false;
+    }
+    rule.hasDst = true;
+    rule.daylightAbbreviation = detail::internZoneAbbreviation(name, length);
+    rule.daylightOffset = rule.standardOffset + 3600;
+    if (p != end && *p != ',') {
+        if (!parseClock(p, end, 24, offset)) {
+            return false;
+        }
+        rule.daylightOffset = -offset;
+    }
+
+    if (p == end) {
+        // 没有切换规则时沿用 POSIX 的默认值（美国规则） 
+        rule.start = detail::ZoneRuleDate{ 'M', 3, 2, 0, 2 * 3600 };
+        rule.end = detail::ZoneRuleDate{ 'M', 11, 1, 0, 2 * 3600 };
+        return true;
+    }
+    if (*p++ != ',' || !parseRuleDate(p, end, rule.start) || p == end || *p++ != ',' ||
+        !parseRuleDate(p, end, rule.end)) {
+        return false;
+    }
+    return p == end;
+}
+
+// year 年切换发生的当地时间（Unix 纪元起的秒数，按切换前的偏移计） 
+long long ruleTransition(const detail::ZoneRuleDate& date, int year) {
+    long long days = 0;
+    if (date.kind == 'J') {
+        days = civil::daysFromCivil(year, 1, 1) + date.day - 1 + (civil::isLeapYear(year) && date.day >= 60 ? 1 : 0);
+    } else if (date.kind == 'N') {
+        days = civil::daysFromCivil(year, 1, 1) + date.day;
+    } else {
+        long long first = civil::daysFromCivil(year, date.month, 1);
+        int weekday = civil::weekdayFromDays(first);
+        days = first + (date.day - weekday + 7) % 7 + (date.week - 1) * 7;
+        if (days - first >= civil::daysInMonth(year, date.month)) {
+            days -= 7;
+        }
+    }
+    return days * 86400 + date.time;
+}
+
+const char kZoneImageMagic[8] = { 'D', 'T', 'Z', 'D', 'B', '1', '\0', '\0' };
+const uint32_t kZoneImageByteOrder = 0x01020304u;
+
+// [offset, offset + count * elementSize) 是否落在镜像内，避免乘法溢出 
+inline bool fitsInImage(uint64_t offset, uint64_t count, size_t elementSize, size_t imageSize) {
+    return offset <= imageSize && count <= (imageSize - offset) / elementSize;
+}
+
+inline void copyAbbreviation(char (&out)[8], unsigned short id) {
+    const char* abbreviation = detail::zoneAbbreviation(id);
+    std::memset(out, 0, sizeof(out));
+    if (abbreviation != nullptr) {
+        std::strncpy(out, abbreviation, sizeof(out) - 1);
+    }
+}
+
+inline unsigned short internAbbreviation(const char (&abbreviation)[8]) {
+    size_t length = static_cast<size_t>(std::find(abbreviation, abbreviation + sizeof(abbreviation), '\0') - abbreviation);
+    return detail::internZoneAbbreviation(abbreviation, length);
+}
+
+inline detail::ZoneImageRuleDate toImageRuleDate(const detail::ZoneRuleDate& date) {
+    detail::ZoneImageRuleDate out = { date.kind, date.month, date.week, date.day, date.time };
+    return out;
+}
+
+inline detail::ZoneRuleDate fromImageRuleDate(const detail::ZoneImageRuleDate& date) {
+    detail::ZoneRuleDate out = { static_cast<char>(date.kind), date.month, date.week, date.day, date.time };
+    return out;
+}
+
+} // namespace zone
+} // namespace
+
+struct TimeZone::Data {
+    std::string name;
+    // 转换表视图：指向下面的 storage，或映射的时区镜像（此时 mapping 保证其生命周期） 
+    const int64_t* transitions = nullptr;
+    const unsigned char* transitionTypes = nullptr;
+    size_t transitionCount = 0;
+    std::vector<LocalType> types;
+    bool hasRule = false;
+    detail::PosixZoneRule rule;
+
+    std::vector<int64_t> transitionStorage;
+    std::vector<unsigned char> transitionTypeStorage;
+    std::shared_ptr<const void> mapping;
+};
+
+// 逐日偏移表：第 i 项对应 UTC 的第 firstDay + i 天 
+struct TimeZone::OffsetCache {
+    struct Day {
+        uint32_t split;        // 当天从该秒起使用 after；当天没有转换时为 86400，kFallback 表示回退 
+        unsigned char before;  // types 中的下标 
+        unsigned char after;
+    };
+
+    static const uint32_t kFallback = 0xFFFFFFFFu;
+
+    int64_t firstDay;
+    std::vector<Day> days;
+    std::vector<LocalType> types;
+};
+
+DATETIME_INLINE TimeZone::TimeZone() : TimeZone(utc()) {}
+
+DATETIME_INLINE TimeZone::TimeZone(std::shared_ptr<const Data> data) : data_(std::move(data)) {}
+
+DATETIME_INLINE TimeZone TimeZone::utc() {
+    static const std::shared_ptr<const Data> data = []() {
+        std::shared_ptr<Data> utcData = std::make_shared<Data>();
+        utcData->name = "UTC";
+        return std::shared_ptr<const Data>(utcData);
+    }();
+    return TimeZone(data);
+}
+
+DATETIME_INLINE TimeZone TimeZone::load(const std::string& name) {
+    const char* directory = std::getenv("TZDIR");
+    return load(name, directory != nullptr && *directory != '\0' ? directory : "/usr/share/zoneinfo");
+}
+
+DATETIME_INLINE TimeZone TimeZone::load(const std::string& name, const std::string& directory) {
+    if (name.empty() || name[0] == '/' || name.find("..") != std::string::npos) {
+        DATETIME_THROW("Invalid time zone name: " + name);
+    }
+    std::ifstream file(directory + "/" + name, std::ios::binary);
+    if (!file) {
+        DATETIME_THROW("Unknown time zone: " + name);
+    }
+    std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return fromTzif(name, bytes.data(), bytes.size());
+}
+
+DATETIME_INLINE TimeZone TimeZone::fromTzif(const std::string& name, const char* data, size_t length) {
+    zone::Reader reader(data, length);
+    zone::Header header;
+    if (!zone::readHeader(reader, header)) {
+        DATETIME_THROW("Invalid TZif data: " + name);
+    }
+
+    // v2 及以上跳过 32 位数据块，使用其后的 64 位数据块与 POSIX 尾部 
+    size_t timeSize = 4;
+    if (header.version != '\0') {
+        if (!reader.skip(zone::bodySize(header, 4)) || !zone::readHeader(reader, header)) {
+            DATETIME_THROW("Invalid TZif data: " + name);
+        }
+        timeSize = 8;
+    }
+    if (static_cast<size_t>(reader.end() - reader.position()) < zone::bodySize(header, timeSize)) {
+        DATETIME_THROW("Invalid TZif data: " + name);
+    }
+
+    std::shared_ptr<Data> zoneData = std::make_shared<Data>();
+    zoneData->name = name;
+    zoneData->transitionStorage.resize(static_cast<size_t>(header.timecnt));
+    zoneData->transitionTypeStorage.resize(static_cast<size_t>(header.timecnt));
+    for (int64_t& transition : zoneData->transitionStorage) {
+        int32_t value32 = 0;
+        if (timeSize == 8) {
+            reader.readBig64(transition);
+        } else {
+            reader.readBig32(value32);
+            transition = value32;
+        }
+    }
+    for (unsigned char& type : zoneData->transitionTypeStorage) {
+        reader.readByte(type);
+        if (type >= header.typecnt) {
+            DATETIME_THROW("Invalid TZif data: " + name);
+        }
+    }
+
+    struct RawType {
+        int32_t utcOffset;
+        unsigned char isDst;
+        unsigned char abbreviationIndex;
+    };
+    std::vector<RawType> rawTypes(static_cast<size_t>(header.typecnt));
+    for (RawType& type : rawTypes) {
+        reader.readBig32(type.utcOffset);
+        reader.readByte(type.isDst);
+        reader.readByte(type.abbreviationIndex);
+    }
+    const char* abbreviations = reader.position();
+    reader.skip(static_cast<size_t>(header.charcnt));
+    for (const RawType& raw : rawTypes) {
+        if (raw.abbreviationIndex >= header.charcnt) {
+            DATETIME_THROW("Invalid TZif data: " + name);
+        }
+        const char* abbreviation = abbreviations + raw.abbreviationIndex;
+        size_t abbreviationLength = static_cast<size_t>(
+            std::find(abbreviation, abbreviations + header.charcnt, '\0') - abbreviation);
+        LocalType type;
+        type.utcOffset = raw.utcOffset;
+        type.abbreviation = detail::internZoneAbbreviation(abbreviation, abbreviationLength);
+        type.isDst = raw.isDst != 0;
+        zoneData->types.push_back(type);
+    }
+    reader.skip(static_cast<size_t>(header.leapcnt) * (timeSize + 4) + static_cast<size_t>(header.isstdcnt) +
+                static_cast<size_t>(header.isutcnt));
+
+    zoneData->transitions = zoneData->transitionStorage.data();
+    zoneData->transitionTypes = zoneData->transitionTypeStorage.data();
+    zoneData->transitionCount = zoneData->transitionStorage.size();
+
+    // 尾部："\n<POSIX TZ>\n"，用于最后一个转换之后的时刻；为空或无法解析时沿用最后一个类型 
+    const char* footer = reader.position();
+    if (timeSize == 8 && footer != reader.end() && *footer == '\n') {
+        const char* footerEnd = static_cast<const char*>(
+            std::memchr(footer + 1, '\n', static_cast<size_t>(reader.end() - footer - 1)));
+        if (footerEnd != nullptr && footerEnd != footer + 1) {
+            zoneData->hasRule = zone::parsePosixRule(footer + 1, footerEnd, zoneData->rule);
+        }
+    }
+
+    return TimeZone(zoneData);
+}
+
+DATETIME_INLINE const std::string& TimeZone::name() const {
+    return data_->name;
+}
+
+DATETIME_INLINE size_t TimeZone::transitionCount() const {
+    return data_->transitionCount;
+}
+
+DATETIME_INLINE TimeZone TimeZone::withOffsetCache(int64_t fromUtcSeconds, int64_t toUtcSeconds) const {
+    std::shared_ptr<OffsetCache> cache = std::make_shared<OffsetCache>();
+    cache->firstDay = civil::detail::floorDiv(fromUtcSeconds, 86400);
+    int64_t lastDay = civil::detail::floorDiv(toUtcSeconds - 1, 86400);
+
+    // 本地时间类型去重后用 8 位下标引用；超过 256 种时对应的天回退到二分查找 
+    auto typeIndex = [&cache](const LocalType& type) -> int {
+        for (size_t i = 0; i < cache->types.size(); ++i) {
+            if (cache->types[i] == type) {
+                return static_cast<int>(i);
+            }
+        }
+        if (cache->types.size() == 256) {
+            return -1;
+        }
+        cache->types.push_back(type);
+        return static_cast<int>(cache->types.size() - 1);
+    };
+
+    const int64_t* transitions = data_->transitions;
+    const int64_t* transitionsEnd = transitions + data_->transitionCount;
+    for (int64_t day = cache->firstDay; day <= lastDay; ++day) {
+        int64_t start = day * 86400;
+        LocalType first = searchLocalType(start);
+        LocalType last = searchLocalType(start + 86399);
+        OffsetCache::Day entry = { 86400, 0, 0 };
+
+        uint32_t split = 86400;
+        const int64_t* from = std::upper_bound(transitions, transitionsEnd, start);
+        if (from != transitionsEnd && from + 1 != transitionsEnd && *(from + 1) < start + 86400) {
+            // 转换表中当天有两次以上转换 
+            split = OffsetCache::kFallback;
+        } else if (first != last) {
+            // 二分找到当天第一个与 first 不同的秒；之后若还有转换则整天回退 
+            uint32_t low = 1;
+            uint32_t high = 86399;
+            while (low < high) {
+                uint32_t mid = low + (high - low) / 2;
+                if (searchLocalType(start + mid) == first) {
+                    low = mid + 1;
+                } else {
+                    high = mid;
+                }
+            }
+            split = low;
+            if (searchLocalType(start + split) != last) {
+                split = OffsetCache::kFallback;
+            }
+        }
+
+        int before = typeIndex(first);
+        int after = typeIndex(last);
+        if (before < 0 || after < 0) {
+            split = OffsetCache::kFallback;
+        } else {
+            entry.before = static_cast<unsigned char>(before);
+            entry.after = static_cast<unsigned char>(after);
+        }
+        entry.split = split;
+        cache->days.push_back(entry);
+    }
+
+    TimeZone result(data_);
+    result.cache_ = cache;
+    return result;
+}
+
+DATETIME_INLINE TimeZone TimeZone::withOffsetCache(int daysAroundNow) const {
+    int64_t now = static_cast<int64_t>(std::time(nullptr));
+    int64_t span = static_cast<int64_t>(daysAroundNow) * 86400;
+    return withOffsetCache(now - span, now + span);
+}
+
+DATETIME_INLINE bool TimeZone::hasOffsetCache() const {
+    return cache_ != nullptr;
+}
+
+// 查询路径只读共享数据；命中统计只在启用统计时按线程分别计数，不写共享的缓存行 
+#ifdef DATETIME_ENABLE_STATS
+#define DATETIME_ZONE_CACHE_STAT(hit) ::datetime::detail::countZoneCacheLookup(hit)
+#else
+#define DATETIME_ZONE_CACHE_STAT(hit) ((void)0)
+#endif
+
+DATETIME_INLINE TimeZone::LocalType TimeZone::localType(int64_t utcSeconds) const {
+    if (cache_) {
+        const OffsetCache& cache = *cache_;
+        uint64_t index = static_cast<uint64_t>(civil::detail::floorDiv(utcSeconds, 86400) - cache.firstDay);
+        if (index < cache.days.size() && cache.days[index].split != OffsetCache::kFallback) {
+            const OffsetCache::Day& day = cache.days[index];
+            DATETIME_ZONE_CACHE_STAT(true);
+            int64_t second = utcSeconds - (cache.firstDay + static_cast<int64_t>(index)) * 86400;
+            return cache.types[second < day.split ? day.before : day.after];
+        }
+        DATETIME_ZONE_CACHE_STAT(false);
+    }
+    return searchLocalType(utcSeconds);
+}
+
+DATETIME_INLINE TimeZone::LocalType TimeZone::searchLocalType(int64_t utcSeconds) const {
+    const Data& data = *data_;
+    const int64_t* transitions = data.transitions;
+    const int64_t* transitionsEnd = transitions + data.transitionCount;
+
+    if (data.hasRule && (transitions == transitionsEnd || utcSeconds >= transitionsEnd[-1])) {
+        const detail::PosixZoneRule& rule = data.rule;
+        LocalType standard = { rule.standardOffset, rule.standardAbbreviation, false };
+        if (!rule.hasDst) {
+            return standard;
+        }
+        LocalType daylight = { rule.daylightOffset, rule.daylightAbbreviation, true };
+
+        long long localDays = civil::detail::floorDiv(utcSeconds + rule.standardOffset, 86400);
+        int year = civil::civilFromDays(localDays).year;
+        long long start = zone::ruleTransition(rule.start, year) - rule.standardOffset;
+        long long end = zone::ruleTransition(rule.end, year) - rule.daylightOffset;
+        bool dst = start < end ? (utcSeconds >= start && utcSeconds < end)
+                               : !(utcSeconds >= end && utcSeconds < start);
+        return dst ? daylight : standard;
+    }
+
+    if (data.types.empty()) {
+        LocalType utcType = { 0, 0, false };
+        return utcType;
+    }
+    // RFC 8536：第一个转换之前使用类型 0 
+    const int64_t* it = std::upper_bound(transitions, transitionsEnd, utcSeconds);
+    if (it == transitions) {
+        return data.types[0];
+    }
+    return data.types[data.transitionTypes[it - transitions - 1]];
+}
+
+DATETIME_INLINE TimeZoneOffset TimeZone::lookup(int64_t utcSeconds) const {
+    LocalType type = localType(utcSeconds);
+    const char* abbreviation = type.abbreviation != 0 ? detail::zoneAbbreviation(type.abbreviation) : nullptr;
+    TimeZoneOffset offset = { type.utcOffset, type.isDst, abbreviation != nullptr ? abbreviation : "UTC" };
+    return offset;
+}
+
+DATETIME_INLINE int32_t TimeZone::utcOffset(int64_t utcSeconds) const {
+    return localType(utcSeconds).utcOffset;
+}
+
+// DateTime 的时区转换 
+DATETIME_INLINE DateTime DateTime::in(const TimeZone& tz) const {
+    long long total = std::chrono::duration_cast<std::chrono::nanoseconds>(time_point_.time_since_epoch()).count();
+    TimeZone::LocalType type = tz.localType(civil::detail::floorDiv(total, 1000000000LL));
+
+    DateTime result(time_point_);
+    result.utc_ = true;
+    result.offset_ = type.utcOffset;
+    result.zone_ = type.abbreviation;
+    // 缩写未能登记（驻留表已满或名称过长）时 zone_ 为 0，只有偏移同样为 0 时才与 UTC 无从区分 
+    result.zoned_ = type.abbreviation != 0 || type.utcOffset != 0;
+    return result;
+}
+
+// 映射的时区镜像；析构时解除映射 
+struct TimeZoneDatabase::Mapping {
+    const char* base = nullptr;
+    size_t size = 0;
+
+    Mapping() = default;
+    Mapping(const Mapping&) = delete;
+    Mapping& operator=(const Mapping&) = delete;
+
+    ~Mapping() {
+        if (base == nullptr) {
+            return;
+        }
+#ifdef _WIN32
+        UnmapViewOfFile(base);
+#else
+        munmap(const_cast<char*>(base), size);
+#endif
+    }
+
+    const detail::ZoneImageHeader& header() const {
+        return *reinterpret_cast<const detail::ZoneImageHeader*>(base);
+    }
+    const detail::ZoneImageEntry* entries() const {
+        return reinterpret_cast<const detail::ZoneImageEntry*>(base + header().directoryOffset);
+    }
+};
+
+DATETIME_INLINE TimeZoneDatabase::TimeZoneDatabase(std::shared_ptr<const Mapping> mapping)
+    : mapping_(std::move(mapping)) {}
+
+DATETIME_INLINE TimeZoneDatabase TimeZoneDatabase::openMapped(const std::string& path) {
+    std::shared_ptr<Mapping> mapping = std::make_shared<Mapping>();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        DATETIME_THROW("Cannot open time zone database: " + path);
+    }
+    LARGE_INTEGER fileSize;
+    HANDLE section = nullptr;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart >= static_cast<LONGLONG>(sizeof(detail::ZoneImageHeader))) {
+        section = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    CloseHandle(file);
+    if (section == nullptr) {
+        DATETIME_THROW("Cannot map time zone database: " + path);
+    }
+    // 视图保持对映射对象的引用，句柄可以立即关闭 
+    const void* address = MapViewOfFile(section, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(section);
+    if (address == nullptr) {
+        DATETIME_THROW("Cannot map time zone database: " + path);
+    }
+    mapping->base = static_cast<const char*>(address);
+    mapping->size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        DATETIME_THROW("Cannot open time zone database: " + path);
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(detail::ZoneImageHeader))) {
+        ::close(fd);
+        DATETIME_THROW("Invalid time zone database: " + path);
+    }
+    // MAP_SHARED 只读映射：所有进程共用页缓存中的同一份数据 
+    void* address = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        DATETIME_THROW("Cannot map time zone database: " + path);
+    }
+    mapping->base = static_cast<const char*>(address);
+    mapping->size = static_cast<size_t>(status.st_size);
+#endif
+
+    // 只校验文件头和目录范围，各时区在 load 时再检查 
+    const detail::ZoneImageHeader& header = mapping->header();
+    if (std::memcmp(header.magic, zone::kZoneImageMagic, sizeof(header.magic)) != 0 ||
+        header.byteOrder != zone::kZoneImageByteOrder || header.totalSize != mapping->size ||
+        header.directoryOffset % 8 != 0 ||
+        !zone::fitsInImage(header.directoryOffset, header.zoneCount, sizeof(detail::ZoneImageEntry), mapping->size)) {
+        DATETIME_THROW("Invalid time zone database: " + path);
+    }
+    return TimeZoneDatabase(mapping);
+}
+
+DATETIME_INLINE size_t TimeZoneDatabase::size() const {
+    return mapping_->header().zoneCount;
+}
+
+DATETIME_INLINE std::string TimeZoneDatabase::name(size_t index) const {
+    if (index >= size()) {
+        DATETIME_THROW("Time zone index out of range");
+    }
+    const detail::ZoneImageEntry& entry = mapping_->entries()[index];
+    if (!zone::fitsInImage(entry.nameOffset, entry.nameLength, 1, mapping_->size)) {
+        return std::string();
+    }
+    return std::string(mapping_->base + entry.nameOffset, entry.nameLength);
+}
+
+DATETIME_INLINE const detail::ZoneImageEntry* TimeZoneDatabase::findZone(const std::string& name) const {
+    const Mapping& mapping = *mapping_;
+    const detail::ZoneImageEntry* first = mapping.entries();
+    const detail::ZoneImageEntry* last = first + mapping.header().zoneCount;
+    // 越界的名称按空串比较，损坏的目录项只会导致找不到 
+    auto compare = [&mapping, &name](const detail::ZoneImageEntry& entry) {
+        if (!zone::fitsInImage(entry.nameOffset, entry.nameLength, 1, mapping.size)) {
+            return name.empty() ? 0 : 1;
+        }
+        return name.compare(0, name.size(), mapping.base + entry.nameOffset, entry.nameLength);
+    };
+    while (first < last) {
+        const detail::ZoneImageEntry* middle = first + (last - first) / 2;
+        int order = compare(*middle);
+        if (order == 0) {
+            return middle;
+        }
+        if (order < 0) {
+            last = middle;
+        } else {
+            first = middle + 1;
+        }
+    }
+    return nullptr;
+}
+
+DATETIME_INLINE bool TimeZoneDatabase::contains(const std::string& name) const {
+    return findZone(name) != nullptr;
+}
+
+DATETIME_INLINE TimeZone TimeZoneDatabase::load(const std::string& name) const {
+    const detail::ZoneImageEntry* entry = findZone(name);
+    if (entry == nullptr) {
+        DATETIME_THROW("Unknown time zone: " + name);
+    }
+    const char* base = mapping_->base;
+    size_t imageSize = mapping_->size;
+    if (entry->transitionsOffset % 8 != 0 || entry->typesOffset % 8 != 0 ||
+        !zone::fitsInImage(entry->transitionsOffset, entry->transitionCount, sizeof(int64_t), imageSize) ||
+        !zone::fitsInImage(entry->transitionTypesOffset, entry->transitionCount, 1, imageSize) ||
+        !zone::fitsInImage(entry->typesOffset, entry->typeCount, sizeof(detail::ZoneImageType), imageSize) ||
+        (entry->typeCount == 0 && entry->transitionCount != 0) || entry->typeCount > 256) {
+        DATETIME_THROW("Invalid time zone database entry: " + name);
+    }
+    const unsigned char* transitionTypes = reinterpret_cast<const unsigned char*>(base + entry->transitionTypesOffset);
+    if (std::find_if(transitionTypes, transitionTypes + entry->transitionCount, [entry](unsigned char type) {
+            return type >= entry->typeCount;
+        }) != transitionTypes + entry->transitionCount) {
+        DATETIME_THROW("Invalid time zone database entry: " + name);
+    }
+
+    // 转换表直接引用映射；本地时间类型很少，缩写需要登记到进程内的驻留表 
+    std::shared_ptr<TimeZone::Data> zoneData = std::make_shared<TimeZone::Data>();
+    zoneData->name = name;
+    zoneData->transitions = reinterpret_cast<const int64_t*>(base + entry->transitionsOffset);
+    zoneData->transitionTypes = transitionTypes;
+    zoneData->transitionCount = entry->transitionCount;
+    zoneData->mapping = mapping_;
+
+    const detail::ZoneImageType* types = reinterpret_cast<const detail::ZoneImageType*>(base + entry->typesOffset);
+    zoneData->types.reserve(entry->typeCount);
+    for (uint32_t i = 0; i < entry->typeCount; ++i) {
+        TimeZone::LocalType type;
+        type.utcOffset = types[i].utcOffset;
+        type.abbreviation = zone::internAbbreviation(types[i].abbreviation);
+        type.isDst = types[i].isDst != 0;
+        zoneData->types.push_back(type);
+    }
+
+    if (entry->hasRule != 0) {
+        const detail::ZoneImageRule& rule = entry->rule;
+        zoneData->hasRule = true;
+        zoneData->rule.standardOffset = rule.standardOffset;
+        zoneData->rule.daylightOffset = rule.daylightOffset;
+        zoneData->rule.standardAbbreviation = zone::internAbbreviation(rule.standardAbbreviation);
+        zoneData->rule.daylightAbbreviation = zone::internAbbreviation(rule.daylightAbbreviation);
+        zoneData->rule.hasDst = rule.hasDst != 0;
+        zoneData->rule.start = zone::fromImageRuleDate(rule.start);
+        zoneData->rule.end = zone::fromImageRuleDate(rule.end);
+    }
+    return TimeZone(zoneData);
+}
+
+DATETIME_INLINE void TimeZoneDatabase::compile(const std::string& directory, const std::vector<std::string>& names,
+                                               const std::string& path) {
+    std::vector<TimeZone> zones;
+    zones.reserve(names.size());
+    for (const std::string& name : names) {
+        zones.push_back(TimeZone::load(name, directory));
+    }
+    std::sort(zones.begin(), zones.end(), [](const TimeZone& a, const TimeZone& b) { return a.name() < b.name(); });
+    for (size_t i = 1; i < zones.size(); ++i) {
+        if (zones[i].name() == zones[i - 1].name()) {
+            DATETIME_THROW("Duplicate time zone: " + zones[i].name());
+        }
+    }
+
+    std::vector<char> image(sizeof(detail::ZoneImageHeader) + zones.size() * sizeof(detail::ZoneImageEntry));
+    auto append = [&image](const void* bytes, size_t length) -> uint64_t {
+        size_t offset = image.size();
+        image.insert(image.end(), static_cast<const char*>(bytes), static_cast<const char*>(bytes) + length);
+        image.resize((image.size() + 7) & ~static_cast<size_t>(7));
+        return offset;
+    };
+
+    std::vector<detail::ZoneImageEntry> entries(zones.size());
+    for (size_t i = 0; i < zones.size(); ++i) {
+        const TimeZone::Data& data = *zones[i].data_;
+        detail::ZoneImageEntry& entry = entries[i];
+        std::memset(&entry, 0, sizeof(entry));
+
+        entry.transitionCount = static_cast<uint32_t>(data.transitionCount);
+        entry.transitionsOffset = append(data.transitions, data.transitionCount * sizeof(int64_t));
+        entry.transitionTypesOffset = append(data.transitionTypes, data.transitionCount);
+
+        std::vector<detail::ZoneImageType> types(data.types.size());
+        for (size_t t = 0; t < types.size(); ++t) {
+            types[t].utcOffset = data.types[t].utcOffset;
+            types[t].isDst = data.types[t].isDst ? 1 : 0;
+            zone::copyAbbreviation(types[t].abbreviation, data.types[t].abbreviation);
+        }
+        entry.typeCount = static_cast<uint32_t>(types.size());
+        entry.typesOffset = append(types.data(), types.size() * sizeof(detail::ZoneImageType));
+
+        if (data.hasRule) {
+            entry.hasRule = 1;
+            entry.rule.standardOffset = data.rule.standardOffset;
+            entry.rule.daylightOffset = data.rule.daylightOffset;
+            zone::copyAbbreviation(entry.rule.standardAbbreviation, data.rule.standardAbbreviation);
+            zone::copyAbbreviation(entry.rule.daylightAbbreviation, data.rule.daylightAbbreviation);
+            entry.rule.hasDst = data.rule.hasDst ? 1 : 0;
+            entry.rule.start = zone::toImageRuleDate(data.rule.start);
+            entry.rule.end = zone::toImageRuleDate(data.rule.end);
+        }
+    }
+    for (size_t i = 0; i < zones.size(); ++i) {
+        const std::string& name = zones[i].name();
+        entries[i].nameLength = static_cast<uint32_t>(name.size());
+        entries[i].nameOffset = append(name.data(), name.size());
+    }
+
+    detail::ZoneImageHeader header;
+    std::memcpy(header.magic, zone::kZoneImageMagic, sizeof(header.magic));
+    header.byteOrder = zone::kZoneImageByteOrder;
+    header.zoneCount = static_cast<uint32_t>(zones.size());
+    header.directoryOffset = sizeof(detail::ZoneImageHeader);
+    header.totalSize = image.size();
+    std::memcpy(image.data(), &header, sizeof(header));
+    if (!entries.empty()) {
+        std::memcpy(image.data() + header.directoryOffset, entries.data(), entries.size() * sizeof(detail::ZoneImageEntry));
+    }
+
+    // 先写入同目录的临时文件再改名替换，已映射旧镜像的进程继续读取原来的文件 
+    if (!detail::writeFileReplacing(path, image.data(), image.size())) {
+        DATETIME_THROW("Cannot write time zone database: " + path);
+    }
+}
+
+} // namespace datetime
@@ -0,0 +1,480 @@
+#include "datetime_batch.h"
+#include "test_framework.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace datetime;
+
+namespace {
+
+const SimdLevel kLevels[] = { SimdLevel::Scalar, SimdLevel::Sse42, SimdLevel::Avx2 };
+const Execution kExecutions[] = { Execution::Sequential, Execution::Parallel };
+
+// 足够大以便 Parallel 真正切分成多块，且跨越纪元前后 
+std::vector<PackedDateTime> makePackedColumn(size_t n) {
+    std::vector<PackedDateTime> values(n);
+    for (size_t i = 0; i < n; ++i) {
+        long long seconds = -1000000000LL + static_cast<long long>(i) * 7919LL;
+        long long fraction = static_cast<long long>(i * 104729 % 1000000000);
+        values[i] = PackedDateTime::fromNanoseconds(seconds * 1000000000LL + fraction);
+    }
+    return values;
+}
+
+// 确定性的伪随机秒数列：正负值混合、含重复值与 kInvalidEpoch 
+std::vector<int64_t> makeShuffledEpochs(size_t n) {
+    std::vector<int64_t> epochs(n);
+    uint64_t state = 88172645463325252ULL;
+    for (size_t i = 0; i < n; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        epochs[i] = static_cast<int64_t>(state % 4000000000ULL) - 1000000000LL;
+        if (i % 97 == 0) {
+            epochs[i] = epochs[i / 2];
+        }
+        if (i % 1009 == 5) {
+            epochs[i] = kInvalidEpoch;
+        }
+    }
+    return epochs;
+}
+
+// 按固定行宽生成时间戳列 
+std::vector<char> makeColumn(const std::vector<long long>& epochs, size_t stride, char separator) {
+    std::vector<char> column(epochs.size() * stride, '#');
+    for (size_t i = 0; i < epochs.size(); ++i) {
+        DateTimeFields f = civil::fieldsFromSeconds(epochs[i]);
+        char row[32];
+        std::snprintf(row, sizeof(row), "%04d-%02d-%02d%c%02d:%02d:%02d",
+                      f.year, f.month, f.day, separator, f.hour, f.minute, f.second);
+        std::memcpy(&column[i * stride], row, 19);
+    }
+    return column;
+}
+
+} // namespace
+
+int main() {
+    TestRunner runner;
+
+    std::cout << "Running DateTime Batch Tests\n";
+    std::cout << "============================\n\n";
+    std::cout << "SIMD level: " << simdLevelName(simdLevel()) << "\n\n";
+
+    runner.run_test("parseColumn matches civil engine on every kernel", []() {
+        std::vector<long long> epochs;
+        for (long long t = -2208988800LL; t < 4102444800LL; t += 86400LL * 17 + 3923) {
+            epochs.push_back(t);
+        }
+        for (size_t stride : { size_t(19), size_t(20), size_t(32) }) {
+            std::vector<char> column = makeColumn(epochs, stride, stride == 20 ? 'T' : ' ');
+            for (SimdLevel level : kLevels) {
+                std::vector<int64_t> out(epochs.size());
+                size_t parsed = parseColumn(column.data(), stride, epochs.size(), out.data(), level);
+                ASSERT_EQ(epochs.size(), parsed);
+                for (size_t i = 0; i < epochs.size(); ++i) {
+                    ASSERT_EQ(epochs[i], out[i]);
+                }
+            }
+        }
+    });
+
+    runner.run_test("parseColumn flags malformed rows on every kernel", []() {
+        const char* rows[] = {
+            "2023-05-15 14:30:45", "2023-05-15X14:30:45", "2023-05-15 14:30:4x", "2023/05/15 14:30:45",
+            "2023-13-15 14:30:45", "2023-02-29 00:00:00", "2024-02-29 23:59:59", "2023-05-15 24:00:00",
+            "2023-05-15 14:60:00", "2023-05-15 14:30:60", "2023-05-15t14:30:45", "20a3-05-15 14:30:45",
+            "2023-05-15T14:30:45"
+        };
+        const bool valid[] = { true, false, false, false, false, false, true, false, false, false, false, false, true };
+        const size_t count = sizeof(rows) / sizeof(rows[0]);
+
+        std::vector<char> column(count * 19);
+        for (size_t i = 0; i < count; ++i) {
+            std::memcpy(&column[i * 19], rows[i], 19);
+        }
+        for (SimdLevel level : kLevels) {
+            std::vector<int64_t> out(count);
+            size_t parsed = parseColumn(column.data(), 19, count, out.data(), level);
+            ASSERT_EQ(3u, parsed);
+            for (size_t i = 0; i < count; ++i) {
+                ASSERT_EQ(valid[i], out[i] != kInvalidEpoch);
+            }
+            ASSERT_EQ(1684161045LL, out[0]);
+        }
+    });
+
+    runner.run_test("parseColumn rejects short strides", []() {
+        char row[] = "2023-05-15 14:30:45";
+        int64_t out = 0;
+        ASSERT_EQ(0u, parseColumn(row, 18, 1, &out));
+        ASSERT_EQ(kInvalidEpoch, out);
+    });
+
+    runner.run_test("formatColumn matches DateTime on every kernel", []() {
+        std::vector<int64_t> epochs;
+        for (long long t = -2208988800LL; t < 4102444800LL; t += 86400LL * 23 + 5417) {
+            epochs.push_back(t);
+        }
+        const FormatSpec specs[] = { FormatSpec("%Y-%m-%d %H:%M:%S"), FormatSpec::iso8601(),
+                                     FormatSpec::rfc3339(), FormatSpec("%d/%m/%Y %H%M") };
+        for (const FormatSpec& spec : specs) {
+            const size_t stride = 28;
+            for (SimdLevel level : kLevels) {
+                std::vector<char> column(epochs.size() * stride, '#');
+                ASSERT_EQ(epochs.size(), formatColumn(epochs.data(), epochs.size(), column.data(), stride, spec, level));
+                for (size_t i = 0; i < epochs.size(); ++i) {
+                    std::string expected = DateTime(static_cast<time_t>(epochs[i])).toUtc().strftime(spec);
+                    expected.resize(stride, ' ');
+                    ASSERT_EQ(expected, std::string(&column[i * stride], stride));
+                }
+            }
+        }
+    });
+
+    runner.run_test("formatColumn blanks rows it cannot write", []() {
+        const int64_t epochs[] = { 0, kInvalidEpoch, 253402300800LL, 1684161045 };
+        for (SimdLevel level : kLevels) {
+            char column[4 * 20];
+            ASSERT_EQ(2u, formatColumn(epochs, 4, column, 20, FormatSpec::iso8601(), level));
+            ASSERT_EQ(std::string("1970-01-01T00:00:00 "), std::string(column, 20));
+            ASSERT_EQ(std::string(20, ' '), std::string(column + 20, 20));
+            ASSERT_EQ(std::string(20, ' '), std::string(column + 40, 20));
+            ASSERT_EQ(std::string("2023-05-15T14:30:45 "), std::string(column + 60, 20));
+        }
+        char narrow[18];
+        ASSERT_EQ(0u, formatColumn(epochs, 1, narrow, sizeof(narrow), FormatSpec::iso8601()));
+    });
+
+    runner.run_test("extractFields matches civil engine on every kernel", []() {
+        std::vector<int64_t> epochs;
+        for (long long t = -62167219200LL - 86400LL * 30; t < 1000000000000LL; t += 86400LL * 17 + 3571) {
+            epochs.push_back(t);
+            if (t > 253402300800LL) {
+                t += 86400LL * 9973;
+            }
+        }
+        // 向量路径的边界、闰日与无效行 
+        const int64_t edges[] = { -62162121600LL, -62162121601LL, 0, -1, 951782400LL, 951868799LL, 4107542400LL,
+                                  kInvalidEpoch, (1LL << 55) + 1, -(1LL << 55), -62162035200LL, 662613695999LL };
+        for (size_t k = 0; k < 3; ++k) {
+            epochs.insert(epochs.begin() + static_cast<long>(k * 8 + 3), edges, edges + 12);
+        }
+        epochs.push_back(1684161045);
+
+        const size_t n = epochs.size();
+        std::vector<int32_t> year(n);
+        std::vector<uint8_t> month(n), day(n), hour(n), minute(n), second(n), weekday(n);
+        std::vector<uint16_t> dayOfYear(n);
+        ColumnOut out = {};
+        out.year = year.data();
+        out.month = month.data();
+        out.day = day.data();
+        out.hour = hour.data();
+        out.minute = minute.data();
+        out.second = second.data();
+        out.weekday = weekday.data();
+        out.dayOfYear = dayOfYear.data();
+
+        for (SimdLevel level : kLevels) {
+            size_t valid = extractFields(epochs.data(), n, Field::All, out, level);
+            ASSERT_EQ(n - 6, valid);
+            for (size_t i = 0; i < n; ++i) {
+                if (epochs[i] == kInvalidEpoch || epochs[i] > (1LL << 55)) {
+                    ASSERT_EQ(0, static_cast<int>(month[i]));
+                    ASSERT_EQ(0, static_cast<int>(year[i]));
+                    continue;
+                }
+                DateTimeFields f = civil::fieldsFromSeconds(epochs[i]);
+                ASSERT_EQ(f.year, static_cast<int>(year[i]));
+                ASSERT_EQ(f.month, static_cast<int>(month[i]));
+                ASSERT_EQ(f.day, static_cast<int>(day[i]));
+                ASSERT_EQ(f.hour, static_cast<int>(hour[i]));
+                ASSERT_EQ(f.minute, static_cast<int>(minute[i]));
+                ASSERT_EQ(f.second, static_cast<int>(second[i]));
+                ASSERT_EQ(f.weekday, static_cast<int>(weekday[i]));
+                ASSERT_EQ(f.dayOfYear, static_cast<int>(dayOfYear[i]));
+            }
+        }
+    });
+
+    runner.run_test("extractFields writes only requested columns", []() {
+        const int64_t epochs[] = { 1684161045, 0, 951825600, kInvalidEpoch, -1, 1700000000, 86400, 1, 2 };
+        for (SimdLevel level : kLevels) {
+            uint8_t month[9];
+            uint8_t weekday[9];
+            std::memset(weekday, 0xAB, sizeof(weekday));
+            ColumnOut out = {};
+            out.month = month;
+            ASSERT_EQ(8u, extractFields(epochs, 9, Field::Month, out, level));
+            ASSERT_EQ(5, static_cast<int>(month[0]));
+            ASSERT_EQ(2, static_cast<int>(month[2]));
+            ASSERT_EQ(0, static_cast<int>(month[3]));
+            ASSERT_EQ(12, static_cast<int>(month[4]));
+            ASSERT_THROWS(extractFields(epochs, 9, Field::Month | Field::Weekday, out, level));
+            out.weekday = weekday;
+            extractFields(epochs, 9, Field::Weekday, out, level);
+            ASSERT_EQ(1, static_cast<int>(weekday[0]));
+            ASSERT_EQ(4, static_cast<int>(weekday[1]));
+        }
+        ASSERT_TRUE(hasField(Field::Date, Field::Day));
+        ASSERT_FALSE(hasField(Field::Time, Field::Day));
+    });
+
+    runner.run_test("addSeconds and addDuration match scalar arithmetic", []() {
+        for (Execution execution : kExecutions) {
+            std::vector<int64_t> epochs = { 0, -1, kInvalidEpoch, 1684161045, -2208988800LL };
+            addSeconds(epochs.data(), epochs.size(), -86400 * 3, execution);
+            ASSERT_EQ(-259200LL, static_cast<long long>(epochs[0]));
+            ASSERT_EQ(-259201LL, static_cast<long long>(epochs[1]));
+            ASSERT_TRUE(epochs[2] == kInvalidEpoch);
+            ASSERT_EQ(1683901845LL, static_cast<long long>(epochs[3]));
+
+            std::vector<PackedDateTime> values = makePackedColumn(300000);
+            std::vector<PackedDateTime> original = values;
+            addDuration(values.data(), values.size(), std::chrono::milliseconds(-1500), execution);
+            for (size_t i = 0; i < values.size(); ++i) {
+                DateTime expected = original[i].toDateTime() - PreciseTimeDelta(std::chrono::milliseconds(1500));
+                ASSERT_TRUE(values[i] == PackedDateTime::fromDateTime(expected));
+            }
+        }
+    });
+
+    runner.run_test("difference matches DateTime subtraction", []() {
+        for (Execution execution : kExecutions) {
+            std::vector<PackedDateTime> a = makePackedColumn(200000);
+            std::vector<PackedDateTime> b(a.rbegin(), a.rend());
+            std::vector<int64_t> out(a.size());
+            difference(a.data(), b.data(), a.size(), out.data(), execution);
+            for (size_t i = 0; i < a.size(); ++i) {
+                PreciseTimeDelta expected =
+                    difference<std::chrono::nanoseconds>(a[i].toDateTime(), b[i].toDateTime());
+                ASSERT_EQ(static_cast<long long>(expected.count()), static_cast<long long>(out[i]));
+            }
+
+            const int64_t left[] = { 100, kInvalidEpoch, -5, 7 };
+            const int64_t right[] = { 40, 0, 5, kInvalidEpoch };
+            int64_t seconds[4];
+            difference(left, right, 4, seconds, execution);
+            ASSERT_EQ(60LL, static_cast<long long>(seconds[0]));
+            ASSERT_TRUE(seconds[1] == kInvalidEpoch);
+            ASSERT_EQ(-10LL, static_cast<long long>(seconds[2]));
+            ASSERT_TRUE(seconds[3] == kInvalidEpoch);
+        }
+    });
+
+    runner.run_test("truncateTo floors towards the past", []() {
+        const TimeUnit units[] = { TimeUnit::Nanosecond, TimeUnit::Microsecond, TimeUnit::Millisecond,
+                                   TimeUnit::Second, TimeUnit::Minute, TimeUnit::Hour, TimeUnit::Day };
+        const long long unitNanos[] = { 1LL, 1000LL, 1000000LL, 1000000000LL, 60000000000LL, 3600000000000LL,
+                                        86400000000000LL };
+        for (Execution execution : kExecutions) {
+            for (size_t u = 0; u < 7; ++u) {
+                std::vector<PackedDateTime> values = makePackedColumn(150000);
+                std::vector<PackedDateTime> original = values;
+                truncateTo(values.data(), values.size(), units[u], execution);
+                for (size_t i = 0; i < values.size(); ++i) {
+                    long long v = values[i].nanos;
+                    ASSERT_TRUE(v <= original[i].nanos && original[i].nanos - v < unitNanos[u]);
+                    ASSERT_EQ(0LL, ((v % unitNanos[u]) + unitNanos[u]) % unitNanos[u]);
+                }
+            }
+        }
+
+        int64_t epochs[] = { -1, 0, 86399, kInvalidEpoch, 1684161045 };
+        truncateTo(epochs, 5, TimeUnit::Day);
+        ASSERT_EQ(-86400LL, static_cast<long long>(epochs[0]));
+        ASSERT_EQ(0LL, static_cast<long long>(epochs[1]));
+        ASSERT_EQ(0LL, static_cast<long long>(epochs[2]));
+        ASSERT_TRUE(epochs[3] == kInvalidEpoch);
+        ASSERT_EQ(1684108800LL, static_cast<long long>(epochs[4]));
+        truncateTo(epochs, 5, TimeUnit::Millisecond);
+        ASSERT_EQ(1684108800LL, static_cast<long long>(epochs[4]));
+    });
+
+    runner.run_test("addMonths and addYears match DateTime arithmetic", []() {
+        const MonthOverflow policies[] = { MonthOverflow::RollOver, MonthOverflow::Clamp };
+        std::vector<int64_t> original;
+        for (long long t = -86400LL * 900; t < 2000000000LL; t += 86400LL * 3 + 7919) {
+            original.push_back(t);
+        }
+        original.push_back(kInvalidEpoch);
+        for (Execution execution : kExecutions) {
+            for (MonthOverflow policy : policies) {
+                for (int months : { 1, -1, 13, -30 }) {
+                    std::vector<int64_t> epochs = original;
+                    std::vector<PackedDateTime> packed;
+                    for (size_t i = 0; i + 1 < original.size(); ++i) {
+                        packed.push_back(PackedDateTime::fromSeconds(original[i]));
+                    }
+                    size_t overflowed = addMonths(epochs.data(), epochs.size(), months, policy, execution);
+                    ASSERT_EQ(overflowed, addMonths(packed.data(), packed.size(), months, policy, execution));
+                    ASSERT_TRUE(epochs.back() == kInvalidEpoch);
+                    size_t expectedOverflows = 0;
+                    for (size_t i = 0; i + 1 < original.size(); ++i) {
+                        DateTime dt = DateTime::fromTimestamp(static_cast<time_t>(original[i])).toUtc();
+                        long long expected = dt.addMonths(months, policy).timestamp();
+                        ASSERT_EQ(expected, static_cast<long long>(epochs[i]));
+                        ASSERT_EQ(expected, static_cast<long long>(packed[i].seconds()));
+                        expectedOverflows += dt.day() > dt.addMonths(months, MonthOverflow::Clamp).day() ? 1 : 0;
+                    }
+                    ASSERT_EQ(expectedOverflows, overflowed);
+                }
+            }
+        }
+
+        int64_t leapDays[] = { 1709208000LL, 1704067200LL, kInvalidEpoch };  // 2024-02-29 12:00, 2024-01-01
+        ASSERT_THROWS(addYears(leapDays, 3, 1, MonthOverflow::Throw));
+        ASSERT_EQ(1709208000LL, static_cast<long long>(leapDays[0]));
+        ASSERT_EQ(0u, addYears(leapDays, 3, 4, MonthOverflow::Throw));
+        ASSERT_EQ(1835438400LL, static_cast<long long>(leapDays[0]));
+        ASSERT_EQ(1u, addYears(leapDays, 3, 1, MonthOverflow::Clamp));
+        ASSERT_EQ(1866974400LL, static_cast<long long>(leapDays[0]));
+
+        int64_t huge[] = { (1LL << 56) };
+        addMonths(huge, 1, 1);
+        ASSERT_TRUE(huge[0] == kInvalidEpoch);
+    });
+
+    runner.run_test("ceilTo and roundTo match DateTime rounding", []() {
+        const TimeUnit units[] = { TimeUnit::Second, TimeUnit::Minute, TimeUnit::Hour, TimeUnit::Day,
+                                   TimeUnit::Week, TimeUnit::Month, TimeUnit::Quarter, TimeUnit::Year };
+        for (Execution execution : kExecutions) {
+            for (TimeUnit unit : units) {
+                std::vector<int64_t> floors;
+                for (long long t = -86400LL * 800; t < 2000000000LL; t += 86400LL * 13 + 7919) {
+                    floors.push_back(t);
+                }
+                floors.push_back(kInvalidEpoch);
+                std::vector<int64_t> ceils = floors;
+                std::vector<int64_t> nearest = floors;
+                truncateTo(floors.data(), floors.size(), unit, execution);
+                ceilTo(ceils.data(), ceils.size(), unit, execution);
+                roundTo(nearest.data(), nearest.size(), unit, execution);
+                ASSERT_TRUE(floors.back() == kInvalidEpoch);
+                ASSERT_TRUE(ceils.back() == kInvalidEpoch);
+                ASSERT_TRUE(nearest.back() == kInvalidEpoch);
+                size_t i = 0;
+                for (long long t = -86400LL * 800; t < 2000000000LL; t += 86400LL * 13 + 7919, ++i) {
+                    DateTime dt = DateTime::fromTimestamp(static_cast<time_t>(t)).toUtc();
+                    ASSERT_EQ(static_cast<long long>(dt.floor(unit).timestamp()), static_cast<long long>(floors[i]));
+                    ASSERT_EQ(static_cast<long long>(dt.ceil(unit).timestamp()), static_cast<long long>(ceils[i]));
+                    ASSERT_EQ(static_cast<long long>(dt.round(unit).timestamp()), static_cast<long long>(nearest[i]));
+                }
+            }
+        }
+
+        PackedDateTime values[] = { PackedDateTime::fromNanoseconds(1500000000LL), PackedDateTime::fromNanoseconds(-1500000001LL),
+                                    PackedDateTime::fromNanoseconds(2999999999LL) };
+        roundTo(values, 3, TimeUnit::Second);
+        ASSERT_EQ(2000000000LL, static_cast<long long>(values[0].nanos));
+        ASSERT_EQ(-2000000000LL, static_cast<long long>(values[1].nanos));
+        ASSERT_EQ(3000000000LL, static_cast<long long>(values[2].nanos));
+        ceilTo(values, 3, TimeUnit::Month);
+        ASSERT_EQ(86400LL * 31 * 1000000000LL, static_cast<long long>(values[0].nanos));
+        ASSERT_EQ(0LL, static_cast<long long>(values[1].nanos));
+    });
+
+    runner.run_test("sortTimes matches std::sort", []() {
+        const size_t sizes[] = { 0, 1, 2, 100, 255, 256, 5000, 300000 };
+        for (Execution execution : kExecutions) {
+            for (size_t n : sizes) {
+                std::vector<int64_t> epochs = makeShuffledEpochs(n);
+                std::vector<int64_t> expected = epochs;
+                std::sort(expected.begin(), expected.end());
+                sortTimes(epochs.data(), n, execution);
+                ASSERT_TRUE(epochs == expected);
+            }
+
+            std::vector<PackedDateTime> packed = makePackedColumn(200000);
+            std::reverse(packed.begin() + 1000, packed.end());
+            std::swap(packed[0], packed[150000]);
+            std::vector<PackedDateTime> expected = packed;
+            std::sort(expected.begin(), expected.end());
+            sortTimes(packed.data(), packed.size(), execution);
+            ASSERT_TRUE(packed == expected);
+
+            std::vector<int64_t> constant(1000, 1700000000);
+            sortTimes(constant.data(), constant.size(), execution);
+            ASSERT_TRUE(constant == std::vector<int64_t>(1000, 1700000000));
+        }
+    });
+
+    runner.run_test("sortTimes on DateTime is stable", []() {
+        std::vector<int64_t> epochs = makeShuffledEpochs(3000);
+        std::vector<DateTime> values;
+        for (size_t i = 0; i < epochs.size(); ++i) {
+            // 同一时刻的本地与 UTC 对象相等，排序后应保持原有顺序 
+            DateTime dt = DateTime::fromTimestamp(static_cast<time_t>(epochs[i] == kInvalidEpoch ? 0 : epochs[i] / 1000));
+            values.push_back(i % 2 == 0 ? dt : dt.toUtc());
+        }
+        std::vector<DateTime> expected = values;
+        std::stable_sort(expected.begin(), expected.end());
+        for (Execution execution : kExecutions) {
+            std::vector<DateTime> sorted = values;
+            sortTimes(sorted.data(), sorted.size(), execution);
+            for (size_t i = 0; i < sorted.size(); ++i) {
+                ASSERT_TRUE(sorted[i] == expected[i]);
+                ASSERT_EQ(expected[i].isUtc(), sorted[i].isUtc());
+            }
+        }
+    });
+
+    runner.run_test("lowerBoundTime and rangeQuery match std::lower_bound", []() {
+        for (size_t n : { 0, 1, 2, 3, 4, 5, 6, 7, 8, 33, 64, 1000, 4097 }) {
+            std::vector<int64_t> epochs = makeShuffledEpochs(n);
+            sortTimes(epochs.data(), n);
+            std::vector<PackedDateTime> packed;
+            std::vector<DateTime> times;
+            for (int64_t epoch : epochs) {
+                int64_t seconds = epoch == kInvalidEpoch ? -2000000000LL : epoch;
+                packed.push_back(PackedDateTime::fromSeconds(seconds));
+                times.push_back(DateTime::fromTimestamp(static_cast<time_t>(seconds)));
+            }
+            EytzingerIndex index(epochs.data(), n);
+            EytzingerIndex packedIndex(packed.data(), n);
+            ASSERT_EQ(n, index.size());
+
+            std::vector<int64_t> probes = epochs;
+            probes.push_back(kInvalidEpoch);
+            probes.push_back(std::numeric_limits<int64_t>::max());
+            for (int64_t t = -1500000000LL; t < 3500000000LL; t += 9999991LL) {
+                probes.push_back(t);
+            }
+            for (int64_t probe : probes) {
+                size_t expected = static_cast<size_t>(std::lower_bound(epochs.begin(), epochs.end(), probe) - epochs.begin());
+                ASSERT_EQ(expected, lowerBoundTime(epochs.data(), n, probe));
+                ASSERT_EQ(expected, index.lowerBound(probe));
+                if (probe == kInvalidEpoch || probe == std::numeric_limits<int64_t>::max()) {
+                    continue;
+                }
+                PackedDateTime t = PackedDateTime::fromSeconds(probe);
+                size_t packedExpected = static_cast<size_t>(std::lower_bound(packed.begin(), packed.end(), t) - packed.begin());
+                ASSERT_EQ(packedExpected, lowerBoundTime(packed.data(), n, t));
+                ASSERT_EQ(packedExpected, packedIndex.lowerBound(t));
+                ASSERT_EQ(packedExpected, lowerBoundTime(times.data(), n, DateTime::fromTimestamp(static_cast<time_t>(probe))));
+            }
+
+            RowRange range = rangeQuery(epochs.data(), n, 0, 1000000000LL);
+            for (size_t i = 0; i < n; ++i) {
+                bool inside = epochs[i] >= 0 && epochs[i] < 1000000000LL;
+                ASSERT_EQ(inside, i >= range.begin && i < range.end);
+            }
+            RowRange same = index.range(0, 1000000000LL);
+            ASSERT_EQ(range.begin, same.begin);
+            ASSERT_EQ(range.end, same.end);
+            ASSERT_TRUE(rangeQuery(epochs.data(), n, 1000000000LL, 0).empty());
+            ASSERT_TRUE(index.range(1000000000LL, 0).empty());
+            RowRange timeRange = rangeQuery(times.data(), n, DateTime::utc(1970, 1, 1), DateTime::utc(2001, 9, 9, 1, 46, 40));
+            ASSERT_EQ(range.size(), timeRange.size());
+        }
+        ASSERT_EQ(0u, EytzingerIndex().lowerBound(42));
+    });
+
+    runner.print_summary();
+    return runner.all_passed() ? 0 : 1;
+}
@@ -1,5 +1,11 @@
 #include "datetime.h"
+#include "test_framework.h"
 #include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <thread>
+#include <type_traits>
 
 
 int main() {
@@ -38,5 +44,322 @@ int main() {
     DateTime next_month = end_of_month.addMonths(1);
     std::cout << next_month.toString() << std::endl;
 
-    return 0;
+    TestRunner runner;
+    std::cout << "\n2. DateTime field decomposition:" << std::endl;
+
+    runner.run_test("fields() matches accessors", []() {
+        DateTime dt(2023, 7, 15, 10, 30, 45);
+        DateTimeFields f = dt.fields();
+        ASSERT_EQ(2023, f.year);
+        ASSERT_EQ(7, f.month);
+        ASSERT_EQ(15, f.day);
+        ASSERT_EQ(10, f.hour);
+        ASSERT_EQ(30, f.minute);
+        ASSERT_EQ(45, f.second);
+        ASSERT_EQ(6, f.weekday);
+        ASSERT_EQ(196, f.dayOfYear);
+
+        ASSERT_EQ(dt.year(), f.year);
+        ASSERT_EQ(dt.weekday(), f.weekday);
+        ASSERT_EQ(dt.dayOfYear(), f.dayOfYear);
+    });
+
+    runner.run_test("fields() survives copies and arithmetic", []() {
+        DateTime dt(2020, 2, 28, 23, 59, 59);
+        DateTime copy = dt;
+        ASSERT_EQ(dt.fields().day, copy.fields().day);
+
+        DateTimeFields next = dt.addSeconds(1).fields();
+        ASSERT_EQ(2, next.month);
+        ASSERT_EQ(29, next.day);
+        ASSERT_EQ(0, next.hour);
+        ASSERT_EQ(60, next.dayOfYear);
+    });
+
+    runner.run_test("fields() floors pre-epoch sub-second instants", []() {
+        DateTime dt = DateTime::utc(1969, 12, 31, 23, 59, 59) + PreciseTimeDelta(std::chrono::milliseconds(500));
+        DateTimeFields f = dt.fields();
+        ASSERT_EQ(1969, f.year);
+        ASSERT_EQ(12, f.month);
+        ASSERT_EQ(31, f.day);
+        ASSERT_EQ(23, f.hour);
+        ASSERT_EQ(59, f.second);
+        ASSERT_EQ(1969, dt.year());
+        ASSERT_EQ(59, dt.second());
+        ASSERT_EQ(std::string("1969-12-31 23:59:59"), dt.toString());
+
+        // 本地时间模式同样向下取整到前一秒 
+        DateTime local = DateTime::utc(1969, 12, 31, 23, 59, 59).toLocal() + PreciseTimeDelta(std::chrono::milliseconds(500));
+        ASSERT_EQ(std::stoi(local.strftime("%S")), local.second());
+        ASSERT_EQ(std::stoi(local.strftime("%Y")), local.year());
+    });
+
+    std::cout << "\n3. Civil calendar engine and UTC mode:" << std::endl;
+
+    runner.run_test("civil engine is constexpr", []() {
+        static_assert(civil::daysFromCivil(1970, 1, 1) == 0, "epoch");
+        static_assert(civil::daysFromCivil(2000, 3, 1) == 11017, "2000-03-01");
+        static_assert(civil::civilFromDays(-1).year == 1969, "1969-12-31");
+        static_assert(civil::civilFromDays(-1).day == 31, "1969-12-31");
+        static_assert(civil::weekdayFromDays(0) == 4, "1970-01-01 is Thursday");
+        static_assert(civil::dayOfYear(2020, 12, 31) == 366, "leap year");
+    });
+
+    runner.run_test("civil engine round-trips and matches gmtime", []() {
+        for (long long days = -800000; days <= 800000; days += 37) {
+            civil::CivilDate date = civil::civilFromDays(days);
+            ASSERT_EQ(days, civil::daysFromCivil(date.year, date.month, date.day));
+        }
+        for (long long t = -2208988800LL; t < 4102444800LL; t += 86400 * 13 + 3607) {
+            time_t time = static_cast<time_t>(t);
+            std::tm tm{};
+            ASSERT_TRUE(gmtime_r(&time, &tm) != nullptr);
+            DateTimeFields f = civil::fieldsFromSeconds(t);
+            ASSERT_EQ(tm.tm_year + 1900, f.year);
+            ASSERT_EQ(tm.tm_mon + 1, f.month);
+            ASSERT_EQ(tm.tm_mday, f.day);
+            ASSERT_EQ(tm.tm_hour, f.hour);
+            ASSERT_EQ(tm.tm_min, f.minute);
+            ASSERT_EQ(tm.tm_sec, f.second);
+            ASSERT_EQ(tm.tm_wday, f.weekday);
+            ASSERT_EQ(tm.tm_yday + 1, f.dayOfYear);
+        }
+    });
+
+    runner.run_test("UTC mode construction and accessors", []() {
+        DateTime dt = DateTime::utc(2021, 1, 1);
+        ASSERT_TRUE(dt.isUtc());
+        ASSERT_EQ(1609459200, dt.timestamp());
+        ASSERT_EQ(2021, dt.year());
+        ASSERT_EQ(5, dt.weekday());
+        ASSERT_EQ("2021-01-01T00:00:00", dt.isoformat());
+        ASSERT_TRUE(dt == DateTime::fromTimestamp(1609459200));
+        ASSERT_FALSE(dt.toLocal().isUtc());
+        ASSERT_THROWS(DateTime::utc(2023, 2, 29));
+    });
+
+    runner.run_test("UTC mode arithmetic stays in UTC", []() {
+        DateTime dt = DateTime::utc(2024, 1, 31, 12, 0, 0);
+        DateTime rolled = dt.addMonths(1);
+        ASSERT_TRUE(rolled.isUtc());
+        ASSERT_EQ(3, rolled.month());
+        ASSERT_EQ(2, rolled.day());
+        ASSERT_EQ(2023, dt.addMonths(-12).year());
+        ASSERT_EQ(2025, dt.addYears(1).year());
+        ASSERT_TRUE(dt.addDays(1).isUtc());
+        ASSERT_TRUE((dt + TimeDelta(1)).isUtc());
+
+        DateTime replaced = dt.replace(-1, 14, -1, 25);
+        ASSERT_EQ(2025, replaced.year());
+        ASSERT_EQ(3, replaced.month());
+        ASSERT_EQ(4, replaced.day());
+        ASSERT_EQ(1, replaced.hour());
+    });
+
+    runner.run_test("addMonths overflow policies", []() {
+        DateTime endOfJanuary = DateTime::utc(2023, 1, 31, 9, 30, 0);
+        ASSERT_TRUE(endOfJanuary.addMonths(1) == DateTime::utc(2023, 3, 3, 9, 30, 0));
+        ASSERT_TRUE(endOfJanuary.addMonths(1, MonthOverflow::Clamp) == DateTime::utc(2023, 2, 28, 9, 30, 0));
+        ASSERT_TRUE(DateTime::utc(2024, 1, 31).addMonths(1, MonthOverflow::Clamp) == DateTime::utc(2024, 2, 29));
+        ASSERT_THROWS(endOfJanuary.addMonths(1, MonthOverflow::Throw));
+        ASSERT_TRUE(endOfJanuary.addMonths(2, MonthOverflow::Throw) == DateTime::utc(2023, 3, 31, 9, 30, 0));
+        ASSERT_TRUE(endOfJanuary.addMonths(-2, MonthOverflow::Clamp) == DateTime::utc(2022, 11, 30, 9, 30, 0));
+        ASSERT_TRUE(endOfJanuary.addMonths(-25) == DateTime::utc(2020, 12, 31, 9, 30, 0));
+        ASSERT_TRUE(DateTime::utc(1969, 3, 31).addMonths(-1, MonthOverflow::Clamp) == DateTime::utc(1969, 2, 28));
+
+        DateTime leapDay = DateTime::utc(2024, 2, 29, 12, 0, 0);
+        ASSERT_TRUE(leapDay.addYears(1) == DateTime::utc(2025, 3, 1, 12, 0, 0));
+        ASSERT_TRUE(leapDay.addYears(1, MonthOverflow::Clamp) == DateTime::utc(2025, 2, 28, 12, 0, 0));
+        ASSERT_TRUE(leapDay.addYears(4, MonthOverflow::Throw) == DateTime::utc(2028, 2, 29, 12, 0, 0));
+        ASSERT_THROWS(leapDay.addYears(-1, MonthOverflow::Throw));
+
+        // 亚秒部分与本地模式的时分秒保持不变 
+        DateTime precise(endOfJanuary.getTimePoint() + std::chrono::milliseconds(250));
+        ASSERT_TRUE(precise.toUtc().addMonths(1, MonthOverflow::Clamp).getTimePoint() ==
+                    DateTime::utc(2023, 2, 28, 9, 30, 0).getTimePoint() + std::chrono::milliseconds(250));
+        DateTime local(2023, 1, 31, 23, 15, 0);
+        ASSERT_TRUE(local.addMonths(1, MonthOverflow::Clamp) == DateTime(2023, 2, 28, 23, 15, 0));
+        ASSERT_TRUE(local.addMonths(6) == DateTime(2023, 7, 31, 23, 15, 0));
+        ASSERT_TRUE(local.addYears(-3, MonthOverflow::Throw) == DateTime(2020, 1, 31, 23, 15, 0));
+        ASSERT_FALSE(local.addMonths(6).isUtc());
+    });
+
+    runner.run_test("floor, ceil and round in UTC mode", []() {
+        DateTime dt = DateTime::utc(2023, 5, 17, 14, 37, 45);
+        ASSERT_TRUE(dt.floor(TimeUnit::Hour) == DateTime::utc(2023, 5, 17, 14, 0, 0));
+        ASSERT_TRUE(dt.ceil(TimeUnit::Hour) == DateTime::utc(2023, 5, 17, 15, 0, 0));
+        ASSERT_TRUE(dt.round(TimeUnit::Minute) == DateTime::utc(2023, 5, 17, 14, 38, 0));
+        ASSERT_TRUE(dt.round(TimeUnit::Day) == DateTime::utc(2023, 5, 18));
+        ASSERT_TRUE(dt.floor(TimeUnit::Hour).isUtc());
+
+        // 2023-05-17 为星期三，周从星期一开始 
+        ASSERT_TRUE(dt.floor(TimeUnit::Week) == DateTime::utc(2023, 5, 15));
+        ASSERT_TRUE(dt.ceil(TimeUnit::Week) == DateTime::utc(2023, 5, 22));
+        ASSERT_TRUE(dt.floor(TimeUnit::Month) == DateTime::utc(2023, 5, 1));
+        ASSERT_TRUE(dt.round(TimeUnit::Month) == DateTime::utc(2023, 6, 1));
+        ASSERT_TRUE(dt.floor(TimeUnit::Quarter) == DateTime::utc(2023, 4, 1));
+        ASSERT_TRUE(dt.ceil(TimeUnit::Quarter) == DateTime::utc(2023, 7, 1));
+        ASSERT_TRUE(dt.round(TimeUnit::Year) == DateTime::utc(2023, 1, 1));
+        ASSERT_TRUE(DateTime::utc(2023, 12, 1).ceil(TimeUnit::Year) == DateTime::utc(2024, 1, 1));
+        ASSERT_TRUE(DateTime::utc(1969, 12, 31, 23, 59, 59).floor(TimeUnit::Day) == DateTime::utc(1969, 12, 31));
+        ASSERT_TRUE(DateTime::utc(1970, 1, 1).floor(TimeUnit::Week) == DateTime::utc(1969, 12, 29));
+
+        // 已在边界上时 ceil 不变；正中间时 round 取较晚者 
+        ASSERT_TRUE(DateTime::utc(2023, 5, 1).ceil(TimeUnit::Month) == DateTime::utc(2023, 5, 1));
+        ASSERT_TRUE(DateTime::utc(2023, 5, 17, 12, 0, 0).round(TimeUnit::Day) == DateTime::utc(2023, 5, 18));
+        DateTime precise(DateTime::utc(2023, 5, 17).getTimePoint() + std::chrono::microseconds(1500));
+        ASSERT_TRUE(precise.toUtc().round(TimeUnit::Millisecond).getTimePoint() ==
+                    DateTime::utc(2023, 5, 17).getTimePoint() + std::chrono::milliseconds(2));
+        ASSERT_TRUE(precise.toUtc().floor(TimeUnit::Second) == DateTime::utc(2023, 5, 17));
+    });
+
+    runner.run_test("floor, ceil and round in local mode", []() {
+        DateTime dt(2023, 11, 15, 14, 37, 45);
+        ASSERT_FALSE(dt.floor(TimeUnit::Day).isUtc());
+        ASSERT_TRUE(dt.floor(TimeUnit::Day) == DateTime(2023, 11, 15));
+        ASSERT_TRUE(dt.ceil(TimeUnit::Day) == DateTime(2023, 11, 16));
+        ASSERT_TRUE(dt.floor(TimeUnit::Month) == DateTime(2023, 11, 1));
+        ASSERT_TRUE(dt.ceil(TimeUnit::Quarter) == DateTime(2024, 1, 1));
+        ASSERT_TRUE(dt.floor(TimeUnit::Week) == DateTime(2023, 11, 13));
+        ASSERT_EQ(14, dt.floor(TimeUnit::Hour).hour());
+        ASSERT_EQ(0, dt.floor(TimeUnit::Hour).minute());
+        ASSERT_EQ(38, dt.round(TimeUnit::Minute).minute());
+    });
+
+    runner.run_test("fromStringUtc", []() {
+        DateTime dt = DateTime::fromStringUtc("2000-02-29 23:59:59");
+        ASSERT_TRUE(dt.isUtc());
+        ASSERT_EQ(951868799, dt.timestamp());
+        ASSERT_THROWS(DateTime::fromStringUtc("2001-02-29 00:00:00"));
+    });
+
+    runner.run_test("sub-second differences", []() {
+        DateTime start = DateTime::utc(2023, 5, 15, 9, 30, 45);
+        DateTime end(start.getTimePoint() + std::chrono::nanoseconds(1500000250));
+
+        PreciseTimeDelta precise = difference<std::chrono::nanoseconds>(end, start);
+        ASSERT_EQ(1500000250LL, precise.count());
+        ASSERT_EQ(1LL, precise.totalSeconds());
+        ASSERT_EQ(500000250LL, precise.nanoseconds());
+        ASSERT_EQ("00:00:01.500000250", precise.toString());
+        ASSERT_EQ(1500LL, difference<std::chrono::milliseconds>(end, start).count());
+        ASSERT_EQ(-1500LL, difference<std::chrono::milliseconds>(start, end).count());
+        ASSERT_EQ(1LL, (end - start).totalSeconds());
+
+        ASSERT_EQ(end.nanoseconds(), start.nanoseconds() + 1500000250LL);
+        ASSERT_EQ(end.microseconds(), start.microseconds() + 1500000LL);
+        ASSERT_TRUE(start + precise == end);
+        ASSERT_TRUE(end - precise == start);
+        ASSERT_TRUE((start + precise).isUtc());
+    });
+
+    runner.run_test("BasicTimeDelta precision conversions", []() {
+        PreciseTimeDelta fromSeconds = TimeDelta(1, 2, 3, 4);
+        ASSERT_EQ(93784000000000LL, fromSeconds.count());
+        ASSERT_EQ("1 day, 02:03:04", fromSeconds.toString());
+
+        BasicTimeDelta<std::chrono::milliseconds> ms(std::chrono::milliseconds(2250));
+        ASSERT_EQ("00:00:02.250", ms.toString());
+        ASSERT_EQ("00:00:02.250", formatDuration(ms));
+        ASSERT_TRUE(ms * 2 == BasicTimeDelta<std::chrono::milliseconds>(std::chrono::milliseconds(4500)));
+        ASSERT_TRUE(PreciseTimeDelta(ms) + TimeDelta(0, 0, 0, 1) > PreciseTimeDelta(ms));
+        static_assert(!std::is_convertible<PreciseTimeDelta, TimeDelta>::value, "lossy conversion must be explicit");
+        static_assert(sizeof(TimeDelta) == sizeof(std::chrono::seconds), "no overhead");
+    });
+
+    runner.run_test("PackedDateTime round-trips and sorts", []() {
+        DateTime dt(DateTime::utc(1969, 12, 31, 23, 59, 59).getTimePoint() + std::chrono::nanoseconds(123456789));
+        PackedDateTime packed = PackedDateTime::fromDateTime(dt);
+        ASSERT_EQ(-876543211LL, static_cast<long long>(packed.nanos));
+        ASSERT_EQ(-1LL, static_cast<long long>(packed.seconds()));
+        ASSERT_TRUE(packed.toDateTime() == dt);
+        ASSERT_EQ(dt.nanoseconds(), static_cast<long long>(packed.toDateTime().nanoseconds()));
+
+        PackedDateTime values[] = { PackedDateTime::fromSeconds(5), packed, PackedDateTime::fromSeconds(-3),
+                                    PackedDateTime::fromNanoseconds(0) };
+        PackedDateTime copy[4];
+        std::memcpy(copy, values, sizeof(values));
+        std::sort(copy, copy + 4);
+        for (int i = 0; i < 3; ++i) {
+            ASSERT_TRUE(copy[i] < copy[i + 1]);
+            ASSERT_TRUE(copy[i].sortKey() < copy[i + 1].sortKey());
+        }
+        static_assert(PackedDateTime::fromSeconds(-1).seconds() == -1, "constexpr");
+    });
+
+    runner.run_test("CoarseClock stays within its resolution", []() {
+        using std::chrono::milliseconds;
+        static_assert(std::is_same<CoarseClock::time_point, std::chrono::system_clock::time_point>::value,
+                      "CoarseClock shares system_clock time points");
+
+        auto expectClose = [](milliseconds slack) {
+            auto before = std::chrono::system_clock::now();
+            DateTime coarse = DateTime::nowCoarse();
+            auto after = std::chrono::system_clock::now();
+            ASSERT_TRUE(coarse.getTimePoint() >= before - CoarseClock::resolution() - slack);
+            ASSERT_TRUE(coarse.getTimePoint() <= after + slack);
+        };
+        ASSERT_FALSE(CoarseClock::tickerRunning());
+        expectClose(milliseconds(5));
+
+        CoarseClock::startTicker(milliseconds(2));
+        ASSERT_TRUE(CoarseClock::tickerRunning());
+        ASSERT_TRUE(CoarseClock::resolution() == milliseconds(2));
+        // 刷新线程可能被调度延迟，留出较大余量 
+        expectClose(milliseconds(200));
+        CoarseClock::time_point first = CoarseClock::now();
+        std::this_thread::sleep_for(milliseconds(20));
+        ASSERT_TRUE(CoarseClock::now() > first);
+
+        CoarseClock::startTicker(milliseconds(1));
+        ASSERT_TRUE(CoarseClock::resolution() == milliseconds(1));
+        CoarseClock::stopTicker();
+        ASSERT_FALSE(CoarseClock::tickerRunning());
+        CoarseClock::stopTicker();
+        ASSERT_THROWS(CoarseClock::startTicker(milliseconds(0)));
+        expectClose(milliseconds(5));
+
+        // 进程退出时仍在运行的刷新线程由静态对象负责停止 
+        CoarseClock::startTicker();
+    });
+
+    runner.run_test("stats snapshot aggregates threads", []() {
+        resetStats();
+        DateTime out = DateTime::fromTimestamp(0);
+        std::thread worker([&out]() {
+            DateTime::tryParseUtc("2023-05-15 09:30:45", out);
+            DateTime::tryParseUtc("2023-02-30 09:30:45", out);
+            out.toString();
+        });
+        worker.join();
+        DateTime local(2023, 5, 15, 9, 30, 45);
+        DateTime::fromTimestamp(1684143045).hour();
+
+        Stats s = stats();
+        if (!statsEnabled()) {
+            ASSERT_EQ(0u, s.parseCalls + s.formatCalls + s.mktimeCalls + s.localtimeCalls);
+            ASSERT_EQ(0u, s.parseCycles.count());
+            return;
+        }
+        // 工作线程已退出，它的计数应并入快照 
+        ASSERT_EQ(2u, s.parseCalls);
+        ASSERT_EQ(1u, s.parseFailures);
+        ASSERT_EQ(1u, s.formatCalls);
+        ASSERT_TRUE(s.mktimeCalls >= 1);
+        ASSERT_TRUE(s.localtimeCalls >= 1);
+#ifdef DATETIME_STATS_CYCLES
+        ASSERT_EQ(2u, s.parseCycles.count());
+        ASSERT_EQ(1u, s.formatCycles.count());
+        ASSERT_TRUE(s.parseCycles.total > 0);
+        ASSERT_TRUE(s.parseCycles.percentile(1.0) >= s.parseCycles.percentile(0.5));
+#endif
+
+        resetStats();
+        ASSERT_EQ(0u, stats().parseCalls);
+        parseIso8601Utc("2023-05-15T09:30:45Z", out);
+        ASSERT_EQ(1u, stats().parseCalls);
+    });
+
+    runner.print_summary();
+    return runner.all_passed() ? 0 : 1;
 }
\ No newline at end of file
@@ -1,6 +1,215 @@
 //
 // Created by CY815 on 2025/8/1.
 //
+#include "datetime.h"
+#include "test_framework.h"
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace datetime;
+
+namespace {
+
+std::string libcStrftime(const DateTime& dt, const char* format) {
+    time_t time = dt.timestamp();
+    std::tm tm{};
+    localtime_r(&time, &tm);
+    char buffer[256]{};
+    size_t length = std::strftime(buffer, sizeof(buffer), format, &tm);
+    return { buffer, length };
+}
+
+} // namespace
+
 int main() {
-    return 0;
-}
\ No newline at end of file
+    TestRunner runner;
+
+    std::cout << "Running DateTime Formatting Tests\n";
+    std::cout << "=================================\n\n";
+
+    runner.run_test("formatTo matches std::strftime", []() {
+        const char* formats[] = {
+            "%Y-%m-%d %H:%M:%S", "%F %T", "%d/%m/%y %R", "%j %u %w %C", "[%e] %I%%",
+            "%A, %B %d, %Y", "%a %b %p %Z", "%Ey %OH", "tab%tnewline%n", "plain text", ""
+        };
+        for (long long t = 0; t < 2000000000LL; t += 86400LL * 97 + 3671) {
+            DateTime dt(static_cast<time_t>(t));
+            for (const char* format : formats) {
+                char buffer[128];
+                size_t length = dt.formatTo(buffer, sizeof(buffer), format);
+                ASSERT_EQ(libcStrftime(dt, format), std::string(buffer, length));
+                ASSERT_EQ(length, std::strlen(buffer));
+            }
+        }
+    });
+
+    runner.run_test("formatTo reports insufficient capacity", []() {
+        DateTime dt(2023, 5, 15, 9, 30, 45);
+        char buffer[20];
+        ASSERT_EQ(19u, dt.formatTo(buffer, sizeof(buffer)));
+        ASSERT_EQ(std::string("2023-05-15 09:30:45"), buffer);
+        ASSERT_EQ(0u, dt.formatTo(buffer, 19));
+        ASSERT_EQ(0u, dt.formatTo(buffer, 0));
+    });
+
+    runner.run_test("formatTo output iterator", []() {
+        DateTime dt(2023, 5, 15, 9, 30, 45);
+        std::string out = "ts=";
+        dt.formatTo(std::back_inserter(out), "%Y%m%dT%H%M%S");
+        ASSERT_EQ("ts=20230515T093045", out);
+
+        char raw[16];
+        char* end = dt.formatTo(raw, "%H:%M");
+        ASSERT_EQ(std::string("09:30"), std::string(raw, end));
+    });
+
+    runner.run_test("isoformat fast path", []() {
+        ASSERT_EQ("1970-01-01T00:00:00", DateTime::utc(1970, 1, 1).isoformat());
+        ASSERT_EQ("1899-12-31T23:59:59", DateTime::utc(1899, 12, 31, 23, 59, 59).isoformat());
+        ASSERT_EQ("2024-02-29T12:00:00", DateTime(2024, 2, 29, 12, 0, 0).isoformat());
+    });
+
+    runner.run_test("FormatSpec layouts are recognised", []() {
+        ASSERT_TRUE(FormatSpec("%Y-%m-%d %H:%M:%S").layout() == FormatSpec::DateTimeLayout);
+        ASSERT_TRUE(FormatSpec("%F %T").layout() == FormatSpec::DateTimeLayout);
+        ASSERT_TRUE(FormatSpec::iso8601().layout() == FormatSpec::Iso8601);
+        ASSERT_TRUE(FormatSpec("%FT%T%:z").layout() == FormatSpec::Rfc3339);
+        ASSERT_TRUE(FormatSpec("%Y/%m/%d").layout() == FormatSpec::Generic);
+        ASSERT_TRUE(FormatSpec("%d %b %Y").compiled());
+        ASSERT_FALSE(FormatSpec("%d %b %Y").parsable());
+    });
+
+    runner.run_test("FormatSpec formatting matches pattern formatting", []() {
+        const char* formats[] = {
+            "%Y-%m-%d %H:%M:%S", "%Y-%m-%dT%H:%M:%S", "%FT%T%:z", "%d/%m/%Y %z", "%A %j.%f"
+        };
+        for (long long t = -86400LL * 365; t < 2000000000LL; t += 86400LL * 131 + 977) {
+            DateTime dt(static_cast<time_t>(t));
+            DateTime utc = dt.toUtc();
+            for (const char* format : formats) {
+                FormatSpec spec(format);
+                ASSERT_EQ(dt.strftime(format), dt.strftime(spec));
+                ASSERT_EQ(utc.strftime(format), utc.strftime(spec));
+            }
+        }
+    });
+
+    runner.run_test("FormatSpec extensions", []() {
+        DateTime dt = DateTime::utc(2023, 5, 15, 9, 30, 45);
+        DateTime precise(dt.getTimePoint() + std::chrono::microseconds(123456));
+        ASSERT_EQ("2023-05-15T09:30:45+00:00", dt.strftime(FormatSpec::rfc3339()));
+        ASSERT_EQ("09:30:45.123456", precise.toUtc().strftime(FormatSpec("%T.%f")));
+
+        const FormatSpec& compact = DATETIME_FORMAT("%Y%m%d%H%M%S");
+        ASSERT_EQ("20230515093045", dt.strftime(compact));
+        static_assert(FormatSpec::isParsable("%Y-%m-%dT%H:%M:%S.%f%:z"), "parsable");
+        static_assert(!FormatSpec::isParsable("%d %b %Y"), "month names need get_time");
+    });
+
+    runner.run_test("FormatSpec long patterns fall back", []() {
+        std::string pattern;
+        for (int i = 0; i < 20; ++i) {
+            pattern += "%Y-%m-%d|";
+        }
+        FormatSpec spec(pattern);
+        ASSERT_FALSE(spec.compiled());
+        DateTime dt(2023, 5, 15);
+        ASSERT_EQ(dt.strftime(pattern), dt.strftime(spec));
+    });
+
+    runner.run_test("CachedNowFormatter matches strftime", []() {
+        const char* patterns[] = {
+            "%Y-%m-%d %H:%M:%S", "%FT%T.%f%:z", "[%T.%f] %f %%f %Z", "%B %e %Y %T.%f", "%f",
+            "%F %T.%f|%F %T.%f|%F %T.%f|%F %T.%f", "%f%f%f%f%f"
+        };
+        for (const char* pattern : patterns) {
+            for (bool utc : { false, true }) {
+                CachedNowFormatter formatter(pattern, utc);
+                ASSERT_EQ(pattern, formatter.pattern());
+                for (long long t = -86400LL * 400; t < 2000000000LL; t += 86400LL * 191 + 7919) {
+                    // 同一秒内多次使用，验证只改写微秒数字 
+                    for (int micros : { 0, 123456, 999999, 5 }) {
+                        DateTime dt(std::chrono::system_clock::from_time_t(static_cast<time_t>(t)) +
+                                    std::chrono::microseconds(micros));
+                        std::string expected = (utc ? dt.toUtc() : dt).strftime(pattern);
+                        char buffer[256];
+                        size_t length = formatter.formatTo(buffer, sizeof(buffer), dt.getTimePoint());
+                        ASSERT_EQ(expected, std::string(buffer, length));
+                        ASSERT_EQ(length, std::strlen(buffer));
+                    }
+                }
+            }
+        }
+    });
+
+    runner.run_test("CachedNowFormatter capacity and now", []() {
+        CachedNowFormatter formatter("%Y-%m-%d %H:%M:%S.%f");
+        std::chrono::system_clock::time_point tp = DateTime(2023, 5, 15, 9, 30, 45).getTimePoint();
+        char buffer[27];
+        ASSERT_EQ(26u, formatter.formatTo(buffer, sizeof(buffer), tp));
+        ASSERT_EQ(std::string("2023-05-15 09:30:45.000000"), buffer);
+        ASSERT_EQ(0u, formatter.formatTo(buffer, 26, tp));
+        ASSERT_EQ(0u, formatter.formatTo(buffer, 0, tp));
+
+        std::string text = formatter.format();
+        ASSERT_EQ(26u, text.size());
+        DateTime parsed = DateTime::fromString(text, "%Y-%m-%d %H:%M:%S.%f");
+        ASSERT_TRUE(std::abs(parsed.timestamp() - DateTime::now().timestamp()) <= 1);
+        ASSERT_EQ(19u, CachedNowFormatter().format().size());
+    });
+
+    runner.run_test("CachedNowFormatter counts one format call per use", []() {
+        const char* patterns[] = { "%Y-%m-%d %H:%M:%S.%f", "%T.%f|%T.%f|%T.%f", "%f%f%f%f%f" };
+        for (const char* pattern : patterns) {
+            CachedNowFormatter formatter(pattern);
+            std::chrono::system_clock::time_point tp = DateTime(2023, 5, 15, 9, 30, 45).getTimePoint();
+            char buffer[64];
+            // 依次为刷新、命中、换秒后再次刷新；%f 超过 kMaxFractions 个时不缓存 
+            for (int i = 0; i < 3; ++i) {
+                resetStats();
+                formatter.formatTo(buffer, sizeof(buffer), tp + std::chrono::seconds(i / 2));
+                ASSERT_EQ(statsEnabled() ? 1u : 0u, stats().formatCalls);
+            }
+        }
+    });
+
+    runner.run_test("CachedNowFormatter shared across threads", []() {
+        CachedNowFormatter formatter("%FT%T.%f%:z", true);
+        const int kThreads = 4;
+        std::vector<std::string> failures(kThreads);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < kThreads; ++t) {
+            workers.emplace_back([&formatter, &failures, t]() {
+                // 线程间交错使用相邻的几秒，反复触发槽位的重写 
+                for (int i = 0; i < 20000; ++i) {
+                    long long second = 1700000000LL + (i + t) % 3;
+                    int micros = (i * 7919 + t) % 1000000;
+                    std::chrono::system_clock::time_point tp =
+                        std::chrono::system_clock::from_time_t(static_cast<time_t>(second)) +
+                        std::chrono::microseconds(micros);
+                    char buffer[64];
+                    std::string actual(buffer, formatter.formatTo(buffer, sizeof(buffer), tp));
+                    std::string expected = DateTime(tp).toUtc().strftime("%FT%T.%f%:z");
+                    if (actual != expected) {
+                        failures[t] = actual + " != " + expected;
+                        return;
+                    }
+                }
+            });
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        for (const std::string& failure : failures) {
+            ASSERT_EQ("", failure);
+        }
+    });
+
+    runner.print_summary();
+    return runner.all_passed() ? 0 : 1;
+}
@@ -0,0 +1,73 @@
+#ifndef DATETIME_TEST_FRAMEWORK_H
+#define DATETIME_TEST_FRAMEWORK_H
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <functional>
+#include <string>
+
+// 简单的测试框架
+class TestRunner {
+private:
+    int tests_run = 0;
+    int tests_passed = 0;
+    
+public:
+    void run_test(const std::string& name, std::function<void()> test) {
+        tests_run++;
+        try {
+            test();
+            tests_passed++;
+            std::cout << "[PASS] " << name << std::endl;
+        } catch (const std::exception& e) {
+            std::cout << "[FAIL] " << name << " - " << e.what() << std::endl;
+        } catch (...) {
+            std::cout << "[FAIL] " << name << " - Unknown exception" << std::endl;
+        }
+    }
+    
+    void print_summary() {
+        std::cout << "\n=== Test Summary ===" << std::endl;
+        std::cout << "Tests run: " << tests_run << std::endl;
+        std::cout << "Tests passed: " << tests_passed << std::endl;
+        std::cout << "Tests failed: " << (tests_run - tests_passed) << std::endl;
+        std::cout << "Success rate: " << (tests_passed * 100.0 / tests_run) << "%" << std::endl;
+    }
+    
+    bool all_passed() const {
+        return tests_run == tests_passed;
+    }
+};
+
+#define ASSERT_EQ(expected, actual) \
+    if ((expected) != (actual)) { \
+        std::ostringstream oss; \
+        oss << "Expected " << (expected) << " but got " << (actual); \
+        throw std::runtime_error(oss.str()); \
+    }
+
+#define ASSERT_TRUE(condition) \
+    if (!(condition)) { \
+        throw std::runtime_error("Condition was false"); \
+    }
+
+#define ASSERT_FALSE(condition) \
+    if (condition) { \
+        throw std::runtime_error("Condition was true"); \
+    }
+
+#define ASSERT_THROWS(expression) \
+    { \
+        bool threw = false; \
+        try { \
+            expression; \
+        } catch (...) { \
+            threw = true; \
+        } \
+        if (!threw) { \
+            throw std::runtime_error("Expected exception was not thrown"); \
+        } \
+    }
+
+#endif // DATETIME_TEST_FRAMEWORK_H
@@ -0,0 +1,268 @@
+#include "datetime_index.h"
+#include "test_framework.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using namespace datetime;
+
+namespace {
+
+// 非降序的事件时刻：秒级与纳秒级的片段交替，夹杂重复值、整块相同的值、大跨度跳变与纪元之前的时刻 
+std::vector<PackedDateTime> makeEvents(size_t n) {
+    std::vector<PackedDateTime> events;
+    events.reserve(n);
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    int64_t t = -86400LL * 1000000000LL;
+    for (size_t i = 0; i < n; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        size_t segment = (i / 5000) % 4;
+        if (segment == 0) {
+            t += static_cast<int64_t>(state % 4) * 1000000000LL;
+        } else if (segment == 1) {
+            t += static_cast<int64_t>(state % 1000003);
+        } else if (segment == 2 && i % 5000 < 4500) {
+            t += 0;
+        } else {
+            t += static_cast<int64_t>(state % 1000) * 86400LL * 1000000000LL / 1000;
+        }
+        events.push_back(PackedDateTime::fromNanoseconds(t));
+    }
+    return events;
+}
+
+size_t expectedLowerBound(const std::vector<PackedDateTime>& events, int64_t t) {
+    return static_cast<size_t>(std::lower_bound(events.begin(), events.end(), PackedDateTime::fromNanoseconds(t)) -
+                               events.begin());
+}
+
+// 用 std::lower_bound 核对 lowerBound、range、at 与 read 
+void checkIndex(const TimeIndex& index, const std::vector<PackedDateTime>& events) {
+    ASSERT_EQ(events.size(), index.size());
+    ASSERT_EQ(events.size() / TimeIndex::kBlockRows, index.blockCount());
+    for (size_t row = 0; row < events.size(); row += 1 + row % 97) {
+        ASSERT_EQ(events[row].nanos, index.at(row).nanos);
+    }
+    std::vector<PackedDateTime> decoded(events.size());
+    index.read(RowRange{ 0, events.size() }, decoded.data());
+    ASSERT_TRUE(decoded == events);
+
+    std::vector<int64_t> probes;
+    probes.push_back(std::numeric_limits<int64_t>::min());
+    probes.push_back(std::numeric_limits<int64_t>::max());
+    for (size_t row = 0; row < events.size(); row += 1 + row % 61) {
+        int64_t t = events[row].nanos;
+        probes.push_back(t);
+        if (t != std::numeric_limits<int64_t>::min()) {
+            probes.push_back(t - 1);
+        }
+        if (t != std::numeric_limits<int64_t>::max()) {
+            probes.push_back(t + 1);
+        }
+    }
+    for (int64_t probe : probes) {
+        ASSERT_EQ(expectedLowerBound(events, probe), index.lowerBound(PackedDateTime::fromNanoseconds(probe)));
+    }
+    for (size_t i = 1; i < probes.size(); ++i) {
+        PackedDateTime from = PackedDateTime::fromNanoseconds(std::min(probes[i - 1], probes[i]));
+        PackedDateTime to = PackedDateTime::fromNanoseconds(std::max(probes[i - 1], probes[i]));
+        RowRange rows = index.range(from, to);
+        ASSERT_EQ(expectedLowerBound(events, from.nanos), rows.begin);
+        ASSERT_EQ(expectedLowerBound(events, to.nanos), rows.end);
+    }
+}
+
+std::string tempPath() {
+    return "/tmp/datetime_index_" + std::to_string(static_cast<long>(getpid())) + ".bin";
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// 镜像文件头中第 index 个 8 字节字段（blocksOffset 为 5，groupsOffset 为 7） 
+uint64_t headerField(const std::string& image, size_t index) {
+    uint64_t value;
+    std::memcpy(&value, image.data() + index * 8, sizeof(value));
+    return value;
+}
+
+void patchInt64(std::string& image, uint64_t offset, int64_t value) {
+    std::memcpy(&image[static_cast<size_t>(offset)], &value, sizeof(value));
+}
+
+} // namespace
+
+int main() {
+    TestRunner runner;
+
+    std::cout << "Running DateTime TimeIndex Tests\n";
+    std::cout << "================================\n\n";
+
+    runner.run_test("empty index", []() {
+        TimeIndex index;
+        ASSERT_TRUE(index.empty());
+        ASSERT_EQ(0u, index.lowerBound(PackedDateTime::fromSeconds(0)));
+        ASSERT_TRUE(index.range(PackedDateTime::fromSeconds(0), PackedDateTime::fromSeconds(10)).empty());
+        ASSERT_THROWS(index.at(0));
+    });
+
+    runner.run_test("lookups match std::lower_bound", []() {
+        std::vector<PackedDateTime> events = makeEvents(TimeIndex::kBlockRows * 70 + 123);
+        TimeIndex index;
+        index.append(events.data(), events.size());
+        checkIndex(index, events);
+
+        // 逐行追加与批量追加得到相同的索引 
+        TimeIndex single;
+        for (size_t i = 0; i < TimeIndex::kBlockRows * 2 + 5; ++i) {
+            single.append(events[i]);
+        }
+        checkIndex(single, std::vector<PackedDateTime>(events.begin(), events.begin() + TimeIndex::kBlockRows * 2 + 5));
+    });
+
+    runner.run_test("blocks spanning the full 64-bit range", []() {
+        std::vector<PackedDateTime> events(TimeIndex::kBlockRows * 2, PackedDateTime::fromNanoseconds(0));
+        events.front().nanos = std::numeric_limits<int64_t>::min();
+        events[TimeIndex::kBlockRows - 1].nanos = std::numeric_limits<int64_t>::max();
+        std::fill(events.begin() + TimeIndex::kBlockRows, events.end(), events[TimeIndex::kBlockRows - 1]);
+        TimeIndex index;
+        index.append(events.data(), events.size());
+        checkIndex(index, events);
+    });
+
+    runner.run_test("second-resolution events compress", []() {
+        TimeIndex index;
+        DateTime start = DateTime::utc(2024, 1, 1);
+        for (int i = 0; i < 100000; ++i) {
+            index.append(start + TimeDelta(0, 0, 0, i * 7 + i % 5));
+        }
+        ASSERT_TRUE(index.memoryBytes() * 3 < index.size() * sizeof(int64_t));
+
+        RowRange day = index.range(DateTime::utc(2024, 1, 2), DateTime::utc(2024, 1, 3));
+        ASSERT_FALSE(day.empty());
+        ASSERT_TRUE(index.at(day.begin).toDateTime() >= DateTime::utc(2024, 1, 2));
+        ASSERT_TRUE(index.at(day.begin - 1).toDateTime() < DateTime::utc(2024, 1, 2));
+        ASSERT_TRUE(index.at(day.end - 1).toDateTime() < DateTime::utc(2024, 1, 3));
+        ASSERT_TRUE(index.at(day.end).toDateTime() >= DateTime::utc(2024, 1, 3));
+        ASSERT_TRUE(index.range(DateTime::utc(2024, 1, 3), DateTime::utc(2024, 1, 2)).empty());
+    });
+
+    runner.run_test("out-of-order appends are rejected", []() {
+        TimeIndex index;
+        index.append(PackedDateTime::fromSeconds(100));
+        index.append(PackedDateTime::fromSeconds(100));
+        ASSERT_THROWS(index.append(PackedDateTime::fromSeconds(99)));
+
+        PackedDateTime batch[] = { PackedDateTime::fromSeconds(101), PackedDateTime::fromSeconds(103),
+                                   PackedDateTime::fromSeconds(102) };
+        ASSERT_THROWS(index.append(batch, 3));
+        ASSERT_EQ(2u, index.size());
+        index.append(batch, 2);
+        ASSERT_EQ(4u, index.size());
+        ASSERT_THROWS(index.at(4));
+        PackedDateTime out[2];
+        ASSERT_THROWS(index.read(RowRange{ 3, 5 }, out));
+    });
+
+    runner.run_test("save and openMapped round trip", []() {
+        std::vector<PackedDateTime> events = makeEvents(TimeIndex::kBlockRows * 130 + 77);
+        size_t half = TimeIndex::kBlockRows * 65 + 11;
+        TimeIndex index;
+        index.append(events.data(), half);
+        std::string path = tempPath();
+        index.save(path);
+
+        {
+            TimeIndex mapped = TimeIndex::openMapped(path);
+            ASSERT_TRUE(mapped.mapped());
+            ASSERT_EQ(index.memoryBytes(), mapped.memoryBytes());
+            checkIndex(mapped, std::vector<PackedDateTime>(events.begin(), events.begin() + half));
+
+            // 追加前先复制到内存，副本仍然读取映射 
+            TimeIndex copy = mapped;
+            ASSERT_THROWS(mapped.append(PackedDateTime::fromNanoseconds(events.front().nanos - 1)));
+            ASSERT_TRUE(mapped.mapped());
+            mapped.append(events.data() + half, events.size() - half);
+            ASSERT_FALSE(mapped.mapped());
+            ASSERT_TRUE(copy.mapped());
+            checkIndex(mapped, events);
+            checkIndex(copy, std::vector<PackedDateTime>(events.begin(), events.begin() + half));
+
+            // 保存到仍被映射的路径：新镜像改名替换，已有的映射继续读取原来的文件 
+            copy.save(path);
+            checkIndex(TimeIndex::openMapped(path), std::vector<PackedDateTime>(events.begin(), events.begin() + half));
+            mapped.save(path);
+            checkIndex(copy, std::vector<PackedDateTime>(events.begin(), events.begin() + half));
+            checkIndex(TimeIndex::openMapped(path), events);
+        }
+        checkIndex(TimeIndex::openMapped(path), events);
+
+        TimeIndex empty;
+        empty.save(path);
+        ASSERT_TRUE(TimeIndex::openMapped(path).empty());
+
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << "definitely not a time index image, just some text"
+                                                                    << std::string(64, '.');
+        ASSERT_THROWS(TimeIndex::openMapped(path));
+        std::remove(path.c_str());
+        ASSERT_THROWS(TimeIndex::openMapped(path));
+        ASSERT_THROWS(index.save("/nonexistent-directory/index.bin"));
+    });
+
+    runner.run_test("truncated images are rejected", []() {
+        std::vector<PackedDateTime> events = makeEvents(TimeIndex::kBlockRows * 3);
+        TimeIndex index;
+        index.append(events.data(), events.size());
+        std::string path = tempPath();
+        index.save(path);
+
+        std::string image = readFile(path);
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << image.substr(0, image.size() - 8);
+        ASSERT_THROWS(TimeIndex::openMapped(path));
+        std::remove(path.c_str());
+    });
+
+    runner.run_test("corrupted block directories are rejected", []() {
+        std::vector<PackedDateTime> events = makeEvents(TimeIndex::kBlockRows * 70 + 5);
+        TimeIndex index;
+        index.append(events.data(), events.size());
+        std::string path = tempPath();
+        index.save(path);
+        std::string image = readFile(path);
+        uint64_t blocks = headerField(image, 5);
+        uint64_t groups = headerField(image, 7);
+
+        // 顶层索引早于组内最后一块时，查找会越过块目录的末尾 
+        std::string bad = image;
+        patchInt64(bad, groups + 8, events.front().nanos);
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << bad;
+        ASSERT_THROWS(TimeIndex::openMapped(path));
+
+        // 块的最小值晚于最大值，或早于前一块的最大值 
+        bad = image;
+        patchInt64(bad, blocks + 3 * sizeof(detail::TimeIndexBlock), std::numeric_limits<int64_t>::max());
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << bad;
+        ASSERT_THROWS(TimeIndex::openMapped(path));
+        bad = image;
+        patchInt64(bad, blocks + 3 * sizeof(detail::TimeIndexBlock), events.front().nanos);
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << bad;
+        ASSERT_THROWS(TimeIndex::openMapped(path));
+
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << image;
+        checkIndex(TimeIndex::openMapped(path), events);
+        std::remove(path.c_str());
+    });
+
+    runner.print_summary();
+    return runner.all_passed() ? 0 : 1;
+}
@@ -0,0 +1,62 @@
+// 以 -fno-exceptions 编译整个库（仅头文件模式），只使用不抛异常的接口 
+// TestRunner 依赖异常，这里用简单的计数代替 
+#include "datetime.h"
+#include "datetime_batch.h"
+#include "datetime_timezone.h"
+#include <cstdio>
+#include <string>
+
+#ifndef DATETIME_NO_EXCEPTIONS
+#error "test_no_exceptions must be compiled with -fno-exceptions"
+#endif
+
+using namespace datetime;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what, int line) {
+    if (!condition) {
+        std::printf("[FAIL] line %d: %s\n", line, what);
+        ++failures;
+    }
+}
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+} // namespace
+
+int main() {
+    std::printf("Running DateTime No-Exception Tests\n");
+    std::printf("===================================\n\n");
+
+    DateTime out = DateTime::fromTimestamp(42);
+    CHECK(DateTime::tryMakeUtc(2023, 5, 15, 14, 30, 45, out) == Status::Ok);
+    CHECK(out == DateTime::fromTimestamp(1684161045));
+    CHECK(DateTime::tryMake(2024, 2, 29, out) == Status::Ok);
+    CHECK(out.day() == 29);
+
+    DateTime sentinel = out;
+    CHECK(DateTime::tryMake(2023, 2, 29, out) == Status::InvalidDay);
+    CHECK(DateTime::tryMakeUtc(2023, 13, 1, out) == Status::InvalidMonth);
+    CHECK(DateTime::tryParse("2023-05-15 25:00:00", out) == Status::InvalidHour);
+    CHECK(DateTime::tryParse("not a date", out) == Status::ParseError);
+    CHECK(DateTime::tryParseUtc("15 Mey 2023", "%d %b %Y", out) == Status::ParseError);
+    CHECK(out == sentinel);
+
+    CHECK(DateTime::tryParseUtc("2023-05-15T14:30:45Z", FormatSpec::rfc3339(), out) == Status::Ok);
+    CHECK(out.isUtc() && out.timestamp() == 1684161045);
+    CHECK(std::string(statusMessage(Status::OutOfRange)).size() > 0);
+
+    // 库的其他部分同样以 -fno-exceptions 编译 
+    int64_t epochs[] = { 1684161045, kInvalidEpoch };
+    CHECK(addMonths(epochs, 2, 1, MonthOverflow::Clamp) == 0);
+    CHECK(epochs[0] == 1686839445);
+    CHECK(TimeZone::utc().utcOffset(0) == 0);
+    CHECK(DateTime::utc(2023, 5, 15).strftime("%F") == "2023-05-15");
+
+    std::printf("%s (%d failures)\n", failures == 0 ? "[PASS] no-exception build" : "[FAIL] no-exception build",
+                failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -1,6 +1,160 @@
 //
 // Created by CY815 on 2025/8/1.
 //
+#include "datetime.h"
+#include "test_framework.h"
+#include <string>
+
+using namespace datetime;
+
 int main() {
-    return 0;
-}
\ No newline at end of file
+    TestRunner runner;
+
+    std::cout << "Running DateTime Parsing Tests\n";
+    std::cout << "==============================\n\n";
+
+    runner.run_test("FormatSpec parsing of default layout", []() {
+        DateTime dt = DateTime::fromString("2023-05-15 14:30:45", FormatSpec("%Y-%m-%d %H:%M:%S"));
+        ASSERT_TRUE(dt == DateTime(2023, 5, 15, 14, 30, 45));
+        ASSERT_TRUE(DateTime::fromString("2023-5-7 4:03:09") == DateTime(2023, 5, 7, 4, 3, 9));
+        ASSERT_TRUE(DateTime::fromString("2000-02-29 00:00:00") == DateTime(2000, 2, 29));
+    });
+
+    runner.run_test("FormatSpec parsing of generic layouts", []() {
+        DateTime dt = DateTime::fromStringUtc("15/05/23  14h30", "%d/%m/%y %Hh%M");
+        ASSERT_EQ(2023, dt.year());
+        ASSERT_EQ(14, dt.hour());
+        ASSERT_EQ(30, dt.minute());
+        ASSERT_EQ(1969, DateTime::fromStringUtc("01/01/69", "%d/%m/%y").year());
+        ASSERT_EQ("100%", DateTime::fromStringUtc("2023-01-01 100%", "%F 100%%").strftime("100%%"));
+    });
+
+    runner.run_test("RFC 3339 offsets and fractions", []() {
+        const FormatSpec& rfc = FormatSpec::rfc3339();
+        DateTime base = DateTime::utc(2023, 5, 15, 12, 0, 0);
+        ASSERT_TRUE(DateTime::fromString("2023-05-15T12:00:00Z", rfc) == base);
+        ASSERT_TRUE(DateTime::fromString("2023-05-15T20:00:00+08:00", rfc) == base);
+        ASSERT_TRUE(DateTime::fromString("2023-05-15T06:30:00-05:30", rfc) == base);
+
+        DateTime precise = DateTime::fromStringUtc("2023-05-15T12:00:00.25Z", rfc);
+        ASSERT_EQ(base.milliseconds() + 250, precise.milliseconds());
+        ASSERT_THROWS(DateTime::fromString("2023-05-15T12:00:00", rfc));
+        ASSERT_THROWS(DateTime::fromString("2023-05-15T12:00:00+25:00", rfc));
+    });
+
+    runner.run_test("Unsupported conversions fall back to get_time", []() {
+        DateTime dt = DateTime::fromStringUtc("15 May 2023", "%d %b %Y");
+        ASSERT_EQ(2023, dt.year());
+        ASSERT_EQ(5, dt.month());
+        ASSERT_EQ(15, dt.day());
+    });
+
+    runner.run_test("Invalid input is rejected", []() {
+        ASSERT_THROWS(DateTime::fromString("2023-13-01 00:00:00"));
+        ASSERT_THROWS(DateTime::fromString("2023-02-29 00:00:00"));
+        ASSERT_THROWS(DateTime::fromString("2023-01-01 24:00:00"));
+        ASSERT_THROWS(DateTime::fromString("2023-01-01"));
+        ASSERT_THROWS(DateTime::fromString("12:30", "%H:%M"));
+        ASSERT_THROWS(DateTime::fromString("x2023-01-01 00:00:00"));
+    });
+
+    runner.run_test("parseIso8601 accepts ISO 8601 / RFC 3339 forms", []() {
+        DateTime base = DateTime::utc(2023, 5, 15, 12, 0, 0);
+        DateTime out;
+        ASSERT_TRUE(parseIso8601("2023-05-15T12:00:00Z", out));
+        ASSERT_TRUE(out == base);
+        ASSERT_FALSE(out.isUtc());
+        ASSERT_TRUE(parseIso8601Utc("2023-05-15T12:00:00Z", out));
+        ASSERT_TRUE(out == base && out.isUtc());
+        ASSERT_TRUE(parseIso8601("2023-05-15t17:30:00+05:30", out) && out == base);
+        ASSERT_TRUE(parseIso8601("2023-05-15 04:00-0800", out) && out == base);
+        ASSERT_TRUE(parseIso8601("2023-05-15T09:00:00-03", out) && out == base);
+        ASSERT_TRUE(parseIso8601Utc("2023-05-15T12:00", out) && out == base);
+        ASSERT_TRUE(parseIso8601Utc("2023-05-15", out) && out == DateTime::utc(2023, 5, 15));
+        ASSERT_TRUE(parseIso8601("2023-05-15 12:00:00", out) && out == DateTime(2023, 5, 15, 12, 0, 0));
+    });
+
+    runner.run_test("parseIso8601 fractional seconds", []() {
+        DateTime out;
+        ASSERT_TRUE(parseIso8601Utc("1970-01-01T00:00:01.5Z", out));
+        ASSERT_EQ(1500, out.milliseconds());
+        ASSERT_TRUE(parseIso8601Utc("1970-01-01T00:00:00,123456789123", out));
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(out.getTimePoint().time_since_epoch());
+        ASSERT_TRUE(ns.count() >= 123456000 && ns.count() <= 123456789);
+    });
+
+    runner.run_test("parseIso8601 rejects malformed input without throwing", []() {
+        const char* bad[] = {
+            "", "2023", "2023-5-15", "2023-05-15T", "2023-05-15T12", "2023-05-15T12:00:",
+            "2023-05-15T12:00:00.", "2023-05-15T12:00:00+", "2023-05-15T12:00:00+5",
+            "2023-05-15T12:00:00Z ", "2023-02-29", "2023-13-01", "2023-01-01T24:00",
+            "2023-01-01T12:60", "2023-01-01T12:00:60", "2023-01-01T12:00+24:00",
+            "9999-01-01T00:00:00Z", "2023/01/01"
+        };
+        DateTime sentinel = DateTime::fromTimestamp(42);
+        for (const char* text : bad) {
+            DateTime out = sentinel;
+            if (parseIso8601Utc(text, out)) {
+                throw std::runtime_error(std::string("accepted: ") + text);
+            }
+            ASSERT_TRUE(out == sentinel);
+        }
+        DateTime out;
+        ASSERT_FALSE(parseIso8601(nullptr, 0, out));
+        ASSERT_TRUE(parseIso8601Utc("2023-01-01 trailing", 10, out));
+    });
+
+    runner.run_test("tryParse reports status without throwing", []() {
+        DateTime out;
+        ASSERT_TRUE(DateTime::tryParse("2023-05-15 14:30:45", out) == Status::Ok);
+        ASSERT_TRUE(out == DateTime(2023, 5, 15, 14, 30, 45));
+        ASSERT_TRUE(DateTime::tryParseUtc("15/05/23 14h30", "%d/%m/%y %Hh%M", out) == Status::Ok);
+        ASSERT_TRUE(out.isUtc() && out == DateTime::utc(2023, 5, 15, 14, 30, 0));
+        ASSERT_TRUE(DateTime::tryParse("2023-05-15T20:00:00+08:00", FormatSpec::rfc3339(), out) == Status::Ok);
+        ASSERT_TRUE(out == DateTime::utc(2023, 5, 15, 12, 0, 0));
+        ASSERT_TRUE(DateTime::tryParseUtc("15 May 2023", "%d %b %Y", out) == Status::Ok);
+        ASSERT_EQ(15, out.day());
+
+        struct Case {
+            const char* text;
+            Status status;
+        };
+        const Case cases[] = {
+            { "2023-13-01 00:00:00", Status::InvalidMonth }, { "2023-02-29 00:00:00", Status::InvalidDay },
+            { "2023-01-01 24:00:00", Status::InvalidHour }, { "2023-01-01 00:60:00", Status::InvalidMinute },
+            { "2023-01-01 00:00:60", Status::InvalidSecond }, { "2023-01-01", Status::ParseError },
+            { "x2023-01-01 00:00:00", Status::ParseError }, { "9999-01-01 00:00:00", Status::OutOfRange }
+        };
+        DateTime sentinel = DateTime::fromTimestamp(42);
+        for (const Case& c : cases) {
+            DateTime result = sentinel;
+            ASSERT_TRUE(DateTime::tryParseUtc(c.text, result) == c.status);
+            ASSERT_TRUE(result == sentinel);
+            ASSERT_THROWS(DateTime::fromStringUtc(c.text));
+        }
+        ASSERT_TRUE(DateTime::tryParse("May 2023", "%d %b %Y", out) == Status::ParseError);
+        ASSERT_EQ(std::string("Invalid day for the given month"), statusMessage(Status::InvalidDay));
+    });
+
+    runner.run_test("tryMake validates fields like the constructors", []() {
+        DateTime out = DateTime::fromTimestamp(42);
+        ASSERT_TRUE(DateTime::tryMake(2023, 5, 15, 14, 30, 45, out) == Status::Ok);
+        ASSERT_TRUE(out == DateTime(2023, 5, 15, 14, 30, 45));
+        ASSERT_FALSE(out.isUtc());
+        ASSERT_TRUE(DateTime::tryMakeUtc(2024, 2, 29, out) == Status::Ok);
+        ASSERT_TRUE(out.isUtc() && out == DateTime::utc(2024, 2, 29));
+
+        DateTime sentinel = out;
+        ASSERT_TRUE(DateTime::tryMake(2023, 0, 1, out) == Status::InvalidMonth);
+        ASSERT_TRUE(DateTime::tryMake(2023, 4, 31, out) == Status::InvalidDay);
+        ASSERT_TRUE(DateTime::tryMakeUtc(2023, 1, 1, -1, 0, 0, out) == Status::InvalidHour);
+        ASSERT_TRUE(DateTime::tryMakeUtc(2023, 1, 1, 0, 60, 0, out) == Status::InvalidMinute);
+        ASSERT_TRUE(DateTime::tryMakeUtc(2023, 1, 1, 0, 0, 60, out) == Status::InvalidSecond);
+        ASSERT_TRUE(DateTime::tryMakeUtc(100000, 1, 1, out) == Status::OutOfRange);
+        ASSERT_TRUE(out == sentinel);
+        ASSERT_THROWS(DateTime::utc(100000, 1, 1));
+    });
+
+    runner.print_summary();
+    return runner.all_passed() ? 0 : 1;
+}
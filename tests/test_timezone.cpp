@@ -0,0 +1,293 @@
+#include "datetime_timezone.h"
+#include "test_framework.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using namespace datetime;
+
+namespace {
+
+const char* kZones[] = {
+    "America/New_York", "Europe/London", "Asia/Kolkata", "Australia/Sydney",
+    "America/Sao_Paulo", "Pacific/Chatham", "Africa/Casablanca", "America/Nuuk"
+};
+
+bool zoneAvailable(const char* name) {
+    std::ifstream file(std::string("/usr/share/zoneinfo/") + name);
+    return file.good();
+}
+
+// 用 libc 作为参照：切换进程 TZ 后调用 localtime_r（测试是单线程的） 
+void setProcessZone(const std::string& tz) {
+    setenv("TZ", tz.c_str(), 1);
+    tzset();
+}
+
+void expectMatchesLibc(const TimeZone& zone, long long from, long long to, long long step) {
+    for (long long t = from; t < to; t += step) {
+        time_t time = static_cast<time_t>(t);
+        std::tm tm{};
+        localtime_r(&time, &tm);
+        TimeZoneOffset offset = zone.lookup(t);
+        ASSERT_EQ(static_cast<long>(tm.tm_gmtoff), static_cast<long>(offset.utcOffset));
+        ASSERT_EQ(tm.tm_isdst > 0, offset.isDst);
+        ASSERT_EQ(std::string(tm.tm_zone), std::string(offset.abbreviation));
+    }
+}
+
+void putBig32(std::string& out, int32_t value) {
+    uint32_t u = static_cast<uint32_t>(value);
+    out += static_cast<char>(u >> 24);
+    out += static_cast<char>(u >> 16);
+    out += static_cast<char>(u >> 8);
+    out += static_cast<char>(u);
+}
+
+// 构造只有一个本地时间类型、没有转换、只靠 POSIX 尾部规则的 v2 TZif 数据 
+std::string makeFooterOnlyTzif(const std::string& footer) {
+    std::string header = std::string("TZif2") + std::string(15, '\0');
+    std::string v1 = header;
+    for (int32_t count : { 0, 0, 0, 0, 1, 4 }) {
+        putBig32(v1, count);
+    }
+    std::string body;
+    putBig32(body, 0);
+    body += '\0';
+    body += '\0';
+    body += std::string("UTC") + '\0';
+    std::string data = v1 + body + v1 + body;
+    return data + "\n" + footer + "\n";
+}
+
+} // namespace
+
+int main() {
+    TestRunner runner;
+
+    std::cout << "Running DateTime TimeZone Tests\n";
+    std::cout << "===============================\n\n";
+
+    runner.run_test("UTC zone", []() {
+        TimeZone utc;
+        ASSERT_EQ("UTC", utc.name());
+        ASSERT_EQ(0, utc.utcOffset(1684161045));
+        ASSERT_EQ(std::string("UTC"), std::string(utc.lookup(0).abbreviation));
+
+        DateTime dt = DateTime::utc(2023, 5, 15, 14, 30, 45);
+        ASSERT_TRUE(dt.in(TimeZone::utc()).isUtc());
+        ASSERT_EQ("2023-05-15 14:30:45 +0000 UTC", dt.toString("%Y-%m-%d %H:%M:%S %z %Z", utc));
+    });
+
+    runner.run_test("TZif transitions match libc", []() {
+        for (const char* name : kZones) {
+            if (!zoneAvailable(name)) {
+                std::cout << "  (skipping " << name << ": not installed)\n";
+                continue;
+            }
+            TimeZone zone = TimeZone::load(name);
+            ASSERT_EQ(name, zone.name());
+            setProcessZone(name);
+            // 1901-2037 覆盖转换表，之后依赖 POSIX 尾部规则 
+            expectMatchesLibc(zone, -2145916800LL, 4102444800LL, 86400LL * 3 + 3607);
+        }
+        unsetenv("TZ");
+        tzset();
+    });
+
+    runner.run_test("POSIX footer rules match libc", []() {
+        const char* rules[] = {
+            "EST5EDT,M3.2.0,M11.1.0", "<+0530>-5:30", "AEST-10AEDT,M10.1.0,M4.1.0/3",
+            "IST-2IDT,M3.4.4/26,M10.5.0", "<-02>2<-01>,M3.5.0/-1,M10.5.0/0", "CET-1CEST,M3.5.0,M10.5.0/3",
+            "XST3XDT,J60/1,300"
+        };
+        for (const char* rule : rules) {
+            std::string data = makeFooterOnlyTzif(rule);
+            TimeZone zone = TimeZone::fromTzif(rule, data.data(), data.size());
+            ASSERT_EQ(0u, zone.transitionCount());
+            setProcessZone(rule);
+            expectMatchesLibc(zone, 946684800LL, 1893456000LL, 3600LL * 7 + 61);
+        }
+        unsetenv("TZ");
+        tzset();
+    });
+
+    runner.run_test("DateTime::in and toString with zone", []() {
+        std::string data = makeFooterOnlyTzif("EST5EDT,M3.2.0,M11.1.0");
+        TimeZone newYork = TimeZone::fromTzif("America/New_York", data.data(), data.size());
+
+        DateTime summer = DateTime::utc(2023, 7, 4, 16, 0, 0);
+        DateTime local = summer.in(newYork);
+        ASSERT_FALSE(local.isUtc());
+        ASSERT_TRUE(local == summer);
+        ASSERT_EQ(12, local.hour());
+        ASSERT_EQ("2023-07-04T12:00:00-04:00 EDT", local.toString("%Y-%m-%dT%H:%M:%S%:z %Z"));
+        ASSERT_EQ("2023-01-04 11:00:00 EST", DateTime::utc(2023, 1, 4, 16, 0, 0).toString("%F %T %Z", newYork));
+
+        // 之后的运算保持固定偏移 
+        ASSERT_EQ("2023-07-05T12:00:00-04:00", local.addDays(1).strftime("%FT%T%:z"));
+        ASSERT_EQ("2024-02-29 12:00:00", local.replace(2024, 2, 29).toString());
+        ASSERT_TRUE(local.replace(2024, 2, 29) == DateTime::utc(2024, 2, 29, 16, 0, 0));
+        ASSERT_TRUE(local.toUtc().isUtc());
+    });
+
+    runner.run_test("floor and ceil follow the zone's wall clock", []() {
+        std::string data = makeFooterOnlyTzif("<+0530>-5:30");
+        TimeZone kolkata = TimeZone::fromTzif("Asia/Kolkata", data.data(), data.size());
+
+        // 2023-05-17 20:00 UTC 为当地 2023-05-18 01:30 
+        DateTime local = DateTime::utc(2023, 5, 17, 20, 0, 0).in(kolkata);
+        ASSERT_TRUE(local.floor(TimeUnit::Day) == DateTime::utc(2023, 5, 17, 18, 30, 0));
+        ASSERT_EQ("2023-05-18 00:00:00", local.floor(TimeUnit::Day).toString());
+        ASSERT_EQ("2023-06-01 00:00:00", local.ceil(TimeUnit::Month).toString());
+        ASSERT_EQ("2023-05-18 02:00:00", local.round(TimeUnit::Hour).toString());
+        ASSERT_EQ("2023-05-15 00:00:00", local.floor(TimeUnit::Week).toString());
+        ASSERT_FALSE(local.floor(TimeUnit::Day).isUtc());
+    });
+
+    runner.run_test("offset cache matches transition search", []() {
+        const long long from = 1577836800LL;  // 2020-01-01
+        const long long to = 1735689600LL;    // 2025-01-01
+        for (const char* name : kZones) {
+            if (!zoneAvailable(name)) {
+                continue;
+            }
+            TimeZone zone = TimeZone::load(name);
+            TimeZone cached = zone.withOffsetCache(from, to);
+            resetStats();
+            ASSERT_FALSE(zone.hasOffsetCache());
+            ASSERT_TRUE(cached.hasOffsetCache());
+            for (long long t = from - 86400LL * 30; t < to + 86400LL * 30; t += 3571) {
+                TimeZoneOffset expected = zone.lookup(t);
+                TimeZoneOffset actual = cached.lookup(t);
+                ASSERT_EQ(expected.utcOffset, actual.utcOffset);
+                ASSERT_EQ(expected.isDst, actual.isDst);
+                ASSERT_EQ(std::string(expected.abbreviation), std::string(actual.abbreviation));
+            }
+            if (statsEnabled()) {
+                ASSERT_TRUE(stats().zoneCacheHits > 0);
+                ASSERT_TRUE(stats().zoneCacheMisses > 0);
+            }
+        }
+    });
+
+    runner.run_test("offset cache drives DateTime formatting", []() {
+        std::string data = makeFooterOnlyTzif("CET-1CEST,M3.5.0,M10.5.0/3");
+        TimeZone berlin = TimeZone::fromTzif("Europe/Berlin", data.data(), data.size()).withOffsetCache();
+
+        DateTime now = DateTime::utcNow();
+        resetStats();
+        std::string text = now.toString("%F %T %Z", berlin);
+        ASSERT_TRUE(text.size() > 20);
+        ASSERT_TRUE(berlin.hasOffsetCache());
+
+        // 副本共享同一张表；没有表的时区不计入命中统计 
+        TimeZone copy = berlin;
+        ASSERT_TRUE(copy.hasOffsetCache());
+        now.addDays(-10000).in(copy);
+        now.in(TimeZone::utc());
+        Stats s = stats();
+        ASSERT_EQ(statsEnabled() ? 1u : 0u, static_cast<unsigned>(s.zoneCacheHits));
+        ASSERT_EQ(statsEnabled() ? 1u : 0u, static_cast<unsigned>(s.zoneCacheMisses));
+
+        // 转换当天：02:00 UTC 前后（2023-10-29 01:00 UTC 切回 CET） 
+        ASSERT_EQ("2023-10-29 02:59:59 CEST", DateTime::utc(2023, 10, 29, 0, 59, 59).toString("%F %T %Z", berlin));
+        ASSERT_EQ("2023-10-29 02:00:00 CET", DateTime::utc(2023, 10, 29, 1, 0, 0).toString("%F %T %Z", berlin));
+    });
+
+    runner.run_test("mapped zone database matches TZif files", []() {
+        std::vector<std::string> names;
+        for (const char* name : kZones) {
+            if (zoneAvailable(name)) {
+                names.push_back(name);
+            }
+        }
+        names.push_back("UTC");
+        std::string path = "/tmp/datetime_zonedb_" + std::to_string(static_cast<long>(getpid())) + ".bin";
+        TimeZoneDatabase::compile("/usr/share/zoneinfo", names, path);
+
+        {
+            TimeZoneDatabase database = TimeZoneDatabase::openMapped(path);
+            ASSERT_EQ(names.size(), database.size());
+            for (size_t i = 1; i < database.size(); ++i) {
+                ASSERT_TRUE(database.name(i - 1) < database.name(i));
+            }
+            ASSERT_FALSE(database.contains("Mars/Olympus_Mons"));
+            ASSERT_THROWS(database.load("Mars/Olympus_Mons"));
+
+            for (const std::string& name : names) {
+                ASSERT_TRUE(database.contains(name));
+                TimeZone expected = TimeZone::load(name);
+                TimeZone mapped = database.load(name);
+                ASSERT_EQ(name, mapped.name());
+                ASSERT_EQ(expected.transitionCount(), mapped.transitionCount());
+                for (long long t = -2145916800LL; t < 4102444800LL; t += 86400LL * 5 + 3607) {
+                    TimeZoneOffset a = expected.lookup(t);
+                    TimeZoneOffset b = mapped.lookup(t);
+                    ASSERT_EQ(a.utcOffset, b.utcOffset);
+                    ASSERT_EQ(a.isDst, b.isDst);
+                    ASSERT_EQ(std::string(a.abbreviation), std::string(b.abbreviation));
+                }
+            }
+
+            // 数据库对象释放后，已取出的时区仍持有映射 
+            TimeZone kept = database.load(names[0]);
+            database = TimeZoneDatabase::openMapped(path);
+            ASSERT_EQ(TimeZone::load(names[0]).utcOffset(1700000000), kept.withOffsetCache().utcOffset(1700000000));
+
+            // 重新编译仍被映射的路径：新镜像改名替换，已有的映射继续读取原来的文件 
+            TimeZoneDatabase::compile("/usr/share/zoneinfo", std::vector<std::string>(1, "UTC"), path);
+            ASSERT_EQ(TimeZone::load(names[0]).utcOffset(1700000000), kept.utcOffset(1700000000));
+            ASSERT_EQ(names.size(), database.size());
+            ASSERT_EQ(names[0], database.load(names[0]).name());
+            TimeZoneDatabase recompiled = TimeZoneDatabase::openMapped(path);
+            ASSERT_EQ(1u, recompiled.size());
+            ASSERT_TRUE(recompiled.contains("UTC"));
+        }
+        ASSERT_THROWS(TimeZoneDatabase::compile("/usr/share/zoneinfo", names, "/nonexistent-directory/zones.bin"));
+
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << "definitely not a zone image, just text";
+        ASSERT_THROWS(TimeZoneDatabase::openMapped(path));
+        std::remove(path.c_str());
+        ASSERT_THROWS(TimeZoneDatabase::openMapped(path));
+    });
+
+    runner.run_test("invalid zones are rejected", []() {
+        ASSERT_THROWS(TimeZone::load("No/Such_Zone"));
+        ASSERT_THROWS(TimeZone::load("../etc/passwd"));
+        const char garbage[] = "not a tzif file at all, definitely not";
+        ASSERT_THROWS(TimeZone::fromTzif("garbage", garbage, sizeof(garbage)));
+        std::string truncated = makeFooterOnlyTzif("UTC0").substr(0, 50);
+        ASSERT_THROWS(TimeZone::fromTzif("truncated", truncated.data(), truncated.size()));
+    });
+
+    // 填满驻留表后本进程无法再登记新缩写，放在最后 
+    runner.run_test("zoned values stay zoned when the abbreviation pool is full", []() {
+        for (unsigned i = 0;; ++i) {
+            char name[8];
+            std::snprintf(name, sizeof(name), "Q%05u", i);
+            if (detail::internZoneAbbreviation(name, std::strlen(name)) == 0) {
+                break;
+            }
+        }
+        std::string data = makeFooterOnlyTzif("<XQZ>-3");
+        TimeZone zone = TimeZone::fromTzif("Test/Full_Pool", data.data(), data.size());
+
+        DateTime local = DateTime::utc(2023, 7, 4, 16, 0, 0).in(zone);
+        ASSERT_FALSE(local.isUtc());
+        ASSERT_EQ(19, local.hour());
+        ASSERT_EQ("2023-07-04T19:00:00+03:00 ", local.toString("%Y-%m-%dT%H:%M:%S%:z %Z"));
+        ASSERT_EQ("+0300 ", local.strftime("%z %Z"));
+        ASSERT_FALSE(local.addDays(1).isUtc());
+        ASSERT_TRUE(local.toUtc().isUtc());
+        ASSERT_EQ("UTC", local.toUtc().toString("%Z"));
+    });
+
+    runner.print_summary();
+    return runner.all_passed() ? 0 : 1;
+}
@@ -0,0 +1,86 @@
+//
+// 把 zoneinfo 目录编译成 TimeZoneDatabase::openMapped 使用的单个镜像文件 
+//
+// 用法：datetime_zonedb <output> [zoneinfo-dir] [zone...] 
+// 未指定时区时收录目录下的全部 TZif 文件（跳过 posix/ 与 right/ 这两个重复的子树） 
+//
+#include "datetime_timezone.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+using namespace datetime;
+
+namespace {
+
+bool isTzifFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[4] = {};
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, "TZif", sizeof(magic)) == 0;
+}
+
+void collectZones(const std::string& root, const std::string& relative, std::vector<std::string>& names) {
+    std::string directory = relative.empty() ? root : root + "/" + relative;
+    DIR* handle = opendir(directory.c_str());
+    if (handle == nullptr) {
+        return;
+    }
+    while (dirent* item = readdir(handle)) {
+        std::string entry = item->d_name;
+        if (entry.empty() || entry[0] == '.') {
+            continue;
+        }
+        std::string name = relative.empty() ? entry : relative + "/" + entry;
+        if (name == "posix" || name == "right") {
+            continue;
+        }
+        struct stat status;
+        if (stat((root + "/" + name).c_str(), &status) != 0) {
+            continue;
+        }
+        if (S_ISDIR(status.st_mode)) {
+            collectZones(root, name, names);
+        } else if (S_ISREG(status.st_mode) && isTzifFile(root + "/" + name)) {
+            names.push_back(name);
+        }
+    }
+    closedir(handle);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <output> [zoneinfo-dir] [zone...]\n";
+        return 2;
+    }
+    std::string output = argv[1];
+    std::string directory = "/usr/share/zoneinfo";
+    if (argc >= 3) {
+        directory = argv[2];
+    } else if (const char* tzdir = std::getenv("TZDIR")) {
+        directory = tzdir;
+    }
+
+    std::vector<std::string> names(argv + std::min(argc, 3), argv + argc);
+    if (names.empty()) {
+        collectZones(directory, "", names);
+    }
+
+    try {
+        TimeZoneDatabase::compile(directory, names, output);
+        TimeZoneDatabase database = TimeZoneDatabase::openMapped(output);
+        std::cout << "Wrote " << database.size() << " zones to " << output << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << argv[0] << ": " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}